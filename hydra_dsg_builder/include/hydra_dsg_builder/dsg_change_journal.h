@@ -0,0 +1,159 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra_utils/dsg_types.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+namespace hydra {
+namespace incremental {
+
+/**
+ * @brief Graph changes that a consumer has not applied yet
+ *
+ * Nodes and edges only show up in one of the added/removed sets: whatever happened
+ * last wins. If full_sync is set, the consumer has to merge the whole graph instead.
+ */
+struct DsgChanges {
+  using EdgeSet = std::set<std::pair<NodeId, NodeId>>;
+
+  bool full_sync = false;
+  //! static and dynamic nodes that were added or had their attributes changed
+  std::unordered_set<NodeId> nodes;
+  std::unordered_set<NodeId> removed_nodes;
+  EdgeSet edges;
+  EdgeSet removed_edges;
+
+  inline bool empty() const {
+    return !full_sync && nodes.empty() && removed_nodes.empty() && edges.empty() &&
+           removed_edges.empty();
+  }
+
+  inline size_t size() const {
+    return nodes.size() + removed_nodes.size() + edges.size() + removed_edges.size();
+  }
+};
+
+/**
+ * @brief Record of frontend graph changes, kept separately for every consumer
+ *
+ * The frontend records the graph changes at the end of every critical section. New
+ * and removed nodes and edges are read (and cleared) from the graph's own change
+ * tracking. Nodes whose attributes changed are passed in explicitly. Consumers pop
+ * everything that changed since their last sync, so merging costs time proportional
+ * to the change volume instead of the graph size. Consumers start with a full sync.
+ */
+class DsgChangeJournal {
+ public:
+  using ConsumerId = size_t;
+
+  DsgChangeJournal() = default;
+
+  //! register a new consumer (the first changes it pops request a full sync)
+  ConsumerId addConsumer();
+
+  //! record nodes whose attributes changed
+  template <typename Container>
+  void recordUpdatedNodes(const Container& nodes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& pending : pending_) {
+      for (const auto& node : nodes) {
+        addNode(pending, node);
+      }
+    }
+  }
+
+  //! record (and clear) the new and removed nodes and edges tracked by the graph
+  void recordGraphChanges(DynamicSceneGraph& graph);
+
+  //! get everything that changed since the consumer last popped changes
+  DsgChanges popChanges(ConsumerId consumer);
+
+  //! number of changes waiting for the slowest consumer
+  size_t maxPending() const;
+
+ private:
+  static void addNode(DsgChanges& changes, NodeId node);
+
+  mutable std::mutex mutex_;
+  std::vector<DsgChanges> pending_;
+};
+
+/**
+ * @brief Options mirroring DynamicSceneGraph::mergeGraph
+ */
+struct DsgMergeOptions {
+  //! nodes that the target merged away (and the node they were merged into)
+  const std::map<NodeId, NodeId>* previous_merges = nullptr;
+  bool allow_invalid_mesh = false;
+  bool clear_mesh_edges = true;
+  //! whether or not to update the attributes of existing nodes per layer
+  const std::map<LayerId, bool>* update_map = nullptr;
+  bool update_dynamic_attributes = true;
+};
+
+/**
+ * @brief Apply journaled changes from a source graph to a target graph
+ *
+ * Matches DynamicSceneGraph::mergeGraph for the nodes and edges in the change set,
+ * except that removed nodes and edges are also removed from the target.
+ *
+ * @param source Graph that the changes were recorded on
+ * @param changes Changes to apply (must not request a full sync)
+ * @param target Graph to update
+ * @param options Merge behavior
+ */
+void mergeChanges(const DynamicSceneGraph& source,
+                  const DsgChanges& changes,
+                  DynamicSceneGraph& target,
+                  const DsgMergeOptions& options = {});
+
+/**
+ * @brief Apply journaled changes to a copy of a single layer of the source graph
+ *
+ * @param source Graph that the changes were recorded on
+ * @param changes Changes to apply (must not request a full sync)
+ * @param target Layer to update (only nodes and edges of the same layer are applied)
+ */
+void mergeChanges(const DynamicSceneGraph& source,
+                  const DsgChanges& changes,
+                  IsolatedSceneGraphLayer& target);
+
+}  // namespace incremental
+}  // namespace hydra
@@ -106,8 +106,8 @@ struct LayerRegistrationProblem {
   NodeSet src_nodes;
   NodeSet dest_nodes;
   SceneGraphLayer* dest_layer = nullptr;
-  std::mutex* src_mutex = nullptr;
-  std::mutex* dest_mutex = nullptr;
+  std::shared_mutex* src_mutex = nullptr;
+  std::shared_mutex* dest_mutex = nullptr;
   size_t min_correspondences;
   size_t min_inliers;
 };
@@ -129,12 +129,15 @@ LayerRegistrationSolution registerDsgLayer(
   std::vector<std::pair<NodeId, NodeId>> correspondences;
   correspondences.reserve(problem.src_nodes.size() * problem.dest_nodes.size());
 
+  // source and destination may share a mutex, and re-locking it from the same thread
+  // is undefined
+  const bool lock_dest = problem.dest_mutex && problem.dest_mutex != problem.src_mutex;
   if (problem.src_mutex) {
-    problem.src_mutex->lock();
+    problem.src_mutex->lock_shared();
   }
 
-  if (problem.dest_mutex) {
-    problem.dest_mutex->lock();
+  if (lock_dest) {
+    problem.dest_mutex->lock_shared();
   }
 
   const SceneGraphLayer& dest = problem.dest_layer ? *problem.dest_layer : src;
@@ -164,11 +167,11 @@ LayerRegistrationSolution registerDsgLayer(
   }
 
   if (problem.src_mutex) {
-    problem.src_mutex->unlock();
+    problem.src_mutex->unlock_shared();
   }
 
-  if (problem.dest_mutex) {
-    problem.dest_mutex->unlock();
+  if (lock_dest) {
+    problem.dest_mutex->unlock_shared();
   }
 
   Eigen::Matrix<double, 3, Eigen::Dynamic> src_points(3, correspondences.size());
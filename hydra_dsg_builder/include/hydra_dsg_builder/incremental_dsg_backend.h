@@ -173,6 +173,7 @@ class DsgBackend : public kimera_pgmo::KimeraPgmoInterface {
 
   SharedDsgInfo::Ptr shared_dsg_;
   SharedDsgInfo::Ptr private_dsg_;
+  DsgChangeJournal::ConsumerId journal_consumer_;
   IsolatedSceneGraphLayer shared_places_copy_;
   std::map<NodeId, NodeId> merged_nodes_;
   std::map<NodeId, std::set<NodeId>> merged_nodes_parents_;
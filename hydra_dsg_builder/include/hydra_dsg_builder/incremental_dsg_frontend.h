@@ -49,20 +49,30 @@
 #include <pose_graph_tools/PoseGraph.h>
 #include <spark_dsg/scene_graph_logger.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
 namespace hydra {
 namespace incremental {
 
 using PlacesLayerMsg = hydra_msgs::ActiveLayer;
-using topology::NearestNodeFinder;
+using topology::IncrementalNodeFinder;
 
 struct PlacesQueueState {
   bool empty = true;
   uint64_t timestamp_ns = 0;
 };
 
+struct MeshQueueEntry {
+  hydra_msgs::ActiveMesh::ConstPtr msg;
+  //! when the message was received (used for the end-to-end update latency)
+  std::chrono::steady_clock::time_point arrival;
+};
+
 class DsgFrontend {
  public:
   DsgFrontend(const ros::NodeHandle& nh, const SharedDsgInfo::Ptr& dsg);
@@ -103,12 +113,22 @@ class DsgFrontend {
 
   PlacesQueueState getPlacesQueueState();
 
+  bool hasQueuedMesh();
+
+  //! wake up the mesh and places threads so they can re-check their inputs
+  void notifyStateChange();
+
+  //! block until the predicate holds, returning false if the frontend is stopping
+  bool waitForState(const std::function<bool()>& ready);
+
   void processLatestPlacesMsg(const PlacesLayerMsg::ConstPtr& msg);
 
   void addPlaceObjectEdges(NodeIdSet* extra_objects_to_check = nullptr);
 
   void updatePlaceMeshMapping();
 
+  void recordUpdateLatency(const MeshQueueEntry& entry) const;
+
   void addAgentPlaceEdges();
 
   std::optional<Eigen::Vector3d> getLatestPose();
@@ -117,6 +137,10 @@ class DsgFrontend {
   ros::NodeHandle nh_;
   std::atomic<bool> should_shutdown_{false};
 
+  //! guards waiting on state_cv_ (the queues and timestamps are guarded separately)
+  std::mutex state_mutex_;
+  std::condition_variable state_cv_;
+
   DsgFrontendConfig config_;
 
   SharedDsgInfo::Ptr dsg_;
@@ -125,7 +149,7 @@ class DsgFrontend {
 
   std::mutex mesh_frontend_mutex_;
   std::atomic<uint64_t> last_mesh_timestamp_;
-  std::queue<hydra_msgs::ActiveMesh::ConstPtr> mesh_queue_;
+  std::queue<MeshQueueEntry> mesh_queue_;
 
   std::mutex places_queue_mutex_;
   std::atomic<uint64_t> last_places_timestamp_;
@@ -138,7 +162,11 @@ class DsgFrontend {
   std::unique_ptr<tf2_ros::TransformListener> tf_listener_;
 
   ros::Subscriber active_places_sub_;
-  std::unique_ptr<NearestNodeFinder> places_nn_finder_;
+  ros::Publisher places_resync_pub_;
+  bool have_places_sequence_ = false;
+  uint64_t last_places_sequence_ = 0;
+  NodeIdSet active_places_;
+  std::unique_ptr<IncrementalNodeFinder> places_nn_finder_;
   std::unique_ptr<std::thread> places_thread_;
   NodeIdSet unlabeled_place_nodes_;
   NodeIdSet previous_active_places_;
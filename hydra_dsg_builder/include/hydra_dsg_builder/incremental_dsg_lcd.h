@@ -44,9 +44,11 @@
 
 #include <pose_graph_tools/BowQuery.h>
 
+#include <list>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 namespace hydra {
 namespace incremental {
@@ -76,6 +78,7 @@ class DsgLcd {
 
   DsgLcdModuleConfig config_;
   SharedDsgInfo::Ptr dsg_;
+  DsgChangeJournal::ConsumerId journal_consumer_;
 
   std::priority_queue<NodeId, std::vector<NodeId>, std::greater<NodeId>> lcd_queue_;
   std::unique_ptr<std::thread> lcd_thread_;
@@ -87,9 +90,26 @@ class DsgLcd {
   char robot_prefix_;
 
   ros::Subscriber bow_sub_;
+  std::mutex bow_mutex_;
   std::list<pose_graph_tools::BowQuery::ConstPtr> bow_messages_;
   std::list<NodeId> potential_lcd_root_nodes_;
 };
 
+/**
+ * @brief Assign BoW vectors to the agent nodes they belong to
+ *
+ * The caller has to hold the DSG lock. Assigned messages are removed from the list
+ * and the agent nodes that received a vector are journaled as updated.
+ *
+ * @param dsg DSG containing the agent nodes
+ * @param robot_prefix Prefix of the agent layer
+ * @param messages BoW vectors to assign
+ * @returns Agent nodes that received a vector
+ */
+std::vector<NodeId> assignBowVectors(
+    SharedDsgInfo& dsg,
+    char robot_prefix,
+    std::list<pose_graph_tools::BowQuery::ConstPtr>& messages);
+
 }  // namespace incremental
 }  // namespace hydra
@@ -35,6 +35,7 @@
 #pragma once
 #include "hydra_dsg_builder/incremental_types.h"
 
+#include <hydra_topology/thread_pool.h>
 #include <hydra_utils/semantic_ros_publishers.h>
 #include <kimera_semantics/semantic_integrator_base.h>
 #include <pcl/common/centroid.h>
@@ -52,7 +53,7 @@ struct Cluster {
   using CloudT = pcl::PointCloud<PointT>;
   using CentroidT = pcl::CentroidPoint<pcl::PointXYZ>;
   CentroidT centroid;
-  CloudT::Ptr cloud;
+  //! indices of the cluster vertices in the full mesh
   pcl::PointIndices indices;
 };
 
@@ -61,7 +62,6 @@ class MeshSegmenter {
   using LabelIndices = std::map<uint8_t, std::vector<size_t>>;
   using MeshVertexCloud = Cluster::CloudT;
   using ObjectCloudPublishers = SemanticRosPublishers<uint8_t, MeshVertexCloud>;
-  using KdTreeT = pcl::search::KdTree<Cluster::PointT>;
   using Clusters = std::vector<Cluster>;
   using LabelClusters = std::map<uint8_t, Clusters>;
 
@@ -79,15 +79,27 @@ class MeshSegmenter {
 
   void pruneObjectsToCheckForPlaces(const DynamicSceneGraph& graph);
 
+  //! objects whose attributes or mesh edges changed during the last updateGraph
+  inline const std::unordered_set<NodeId>& getUpdatedObjects() const {
+    return updated_objects_;
+  }
+
   void updateGraph(DynamicSceneGraph& graph,
                    const LabelClusters& clusters,
                    uint64_t timestamp);
 
  private:
+  struct ObjectVertexIndex;
+
   LabelClusters findNewObjectClusters(const std::vector<size_t>& active_indices) const;
 
-  Clusters findClusters(const MeshVertexCloud::Ptr& cloud,
-                        const std::vector<size_t>& indices) const;
+  Clusters findClusters(const ObjectVertexIndex& index,
+                        uint8_t label,
+                        std::vector<uint8_t>& processed) const;
+
+  Clusters findVoxelHashClusters(const ObjectVertexIndex& index, uint8_t label) const;
+
+  BoundingBox getBoundingBox(const Cluster& cluster) const;
 
   void archiveOldObjects(const DynamicSceneGraph& graph, uint64_t latest_timestamp);
 
@@ -118,9 +130,11 @@ class MeshSegmenter {
   double cluster_tolerance_;  // maxium radius
   size_t min_cluster_size_;
   size_t max_cluster_size_;
+  bool use_voxel_clustering_;
   std::map<uint8_t, std::set<NodeId>> active_objects_;
   std::map<NodeId, uint64_t> active_object_timestamps_;
   std::unordered_set<NodeId> objects_to_check_for_places_;
+  std::unordered_set<NodeId> updated_objects_;
 
   std::set<uint8_t> object_labels_;
   bool enable_active_mesh_pub_;
@@ -128,6 +142,8 @@ class MeshSegmenter {
 
   BoundingBox::Type bounding_box_type_;
 
+  std::unique_ptr<topology::ThreadPool> thread_pool_;
+
   ros::Publisher active_mesh_vertex_pub_;
   std::unique_ptr<ObjectCloudPublishers> segmented_mesh_vertices_pub_;
 
@@ -33,14 +33,20 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include "hydra_dsg_builder/dsg_change_journal.h"
+
 #include <gtsam/geometry/Pose3.h>
 #include <hydra_utils/dsg_types.h>
+#include <hydra_utils/timing_utilities.h>
 #include <kimera_pgmo/utils/CommonStructs.h>
 
 #include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <string>
 
 namespace hydra {
 
@@ -65,7 +71,7 @@ struct SharedDsgInfo {
   using Ptr = std::shared_ptr<SharedDsgInfo>;
 
   SharedDsgInfo(const std::map<LayerId, char>& layer_id_map, LayerId mesh_layer_id)
-      : updated(false) {
+      : updated(false), latest_places_time_ns(0) {
     DynamicSceneGraph::LayerIds layer_ids;
     for (const auto& id_key_pair : layer_id_map) {
       CHECK(id_key_pair.first != mesh_layer_id)
@@ -79,19 +85,77 @@ struct SharedDsgInfo {
     latest_places.reset(new NodeIdSet);
   }
 
-  std::mutex mutex;
+  //! guards the graph and the bookkeeping below. Read-only consumers (merging into
+  //! another graph, logging, saving) share it; anything that mutates the graph or the
+  //! bookkeeping takes it exclusively. Prefer lockGraph / lockGraphShared so that
+  //! contention shows up in the timing output
+  std::shared_mutex mutex;
   std::atomic<bool> updated;
   uint64_t last_update_time;
   DynamicSceneGraph::Ptr graph;
   std::shared_ptr<NodeIdSet> latest_places;
+  //! timestamp of the places message that produced latest_places
+  uint64_t latest_places_time_ns;
 
   std::map<NodeId, size_t> agent_key_map;
+  //! guards archived_places, which the LCD drains while only sharing the graph mutex
+  std::mutex archived_places_mutex;
   NodeIdSet archived_places;
+  //! changes to the graph since each consumer last merged it
+  DsgChangeJournal changes;
 
   std::mutex lcd_mutex;
   std::queue<lcd::DsgRegistrationSolution> loop_closures;
 };
 
+namespace detail {
+
+// locks are taken far too often to keep every wait, so only the statistics are kept
+inline void recordLockWait(const std::string& site,
+                           const std::chrono::steady_clock::time_point& start) {
+  const auto now = std::chrono::steady_clock::now();
+  timing::ElapsedTimeRecorder::instance().recordSummary(site + "_lock_wait",
+                                                        now - start);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Take exclusive ownership of a DSG
+ *
+ * Statistics of the time spent waiting for the lock are recorded as
+ * "<site>_lock_wait"
+ *
+ * @param dsg DSG to lock
+ * @param site Name of the call site (e.g., "frontend/update_places")
+ * @returns Lock that owns the DSG mutex
+ */
+inline std::unique_lock<std::shared_mutex> lockGraph(SharedDsgInfo& dsg,
+                                                     const std::string& site) {
+  const auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::shared_mutex> lock(dsg.mutex);
+  detail::recordLockWait(site, start);
+  return lock;
+}
+
+/**
+ * @brief Take shared (read-only) ownership of a DSG
+ *
+ * Statistics of the time spent waiting for the lock are recorded as
+ * "<site>_lock_wait"
+ *
+ * @param dsg DSG to lock
+ * @param site Name of the call site (e.g., "backend/merge_frontend")
+ * @returns Lock that shares the DSG mutex
+ */
+inline std::shared_lock<std::shared_mutex> lockGraphShared(SharedDsgInfo& dsg,
+                                                           const std::string& site) {
+  const auto start = std::chrono::steady_clock::now();
+  std::shared_lock<std::shared_mutex> lock(dsg.mutex);
+  detail::recordLockWait(site, start);
+  return lock;
+}
+
 struct DsgBackendStatus {
   size_t total_loop_closures_;
   size_t new_loop_closures_;
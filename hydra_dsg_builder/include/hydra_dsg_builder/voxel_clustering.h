@@ -0,0 +1,68 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Dense>
+
+#include <vector>
+
+namespace hydra {
+namespace incremental {
+
+using VoxelClusters = std::vector<std::vector<size_t>>;
+
+/**
+ * @brief Euclidean clustering through a spatial hash and union-find
+ *
+ * Points are hashed into cubic cells whose diagonal is the tolerance, so all points of
+ * a cell belong to the same cluster. Cells are then joined with a union-find whenever
+ * a neighboring cell (up to two cells away) holds a point within the tolerance. Cell
+ * pairs that already share a component are skipped without any distance checks, which
+ * is the common case for dense mesh vertices. The result matches
+ * pcl::EuclideanClusterExtraction without building a kd-tree or running a radius
+ * search per point.
+ *
+ * @param points Points to cluster
+ * @param tolerance Maximum distance between neighboring points of a cluster
+ * @param min_size Minimum number of points in a cluster
+ * @param max_size Maximum number of points in a cluster
+ * @returns Indices of the points of each cluster (largest clusters first)
+ */
+VoxelClusters findVoxelClusters(const std::vector<Eigen::Vector3f>& points,
+                                double tolerance,
+                                size_t min_size,
+                                size_t max_size);
+
+}  // namespace incremental
+}  // namespace hydra
@@ -0,0 +1,200 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_dsg_builder/voxel_clustering.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/segmentation/extract_clusters.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+
+DEFINE_double(cluster_tolerance, 0.25, "maximum distance between cluster neighbors");
+DEFINE_int32(min_cluster_size, 25, "minimum number of vertices per cluster");
+DEFINE_int32(max_cluster_size, 100000, "maximum number of vertices per cluster");
+DEFINE_int32(num_trials, 5, "number of times to cluster every cloud");
+
+using hydra::incremental::findVoxelClusters;
+using hydra::incremental::VoxelClusters;
+using PointT = pcl::PointXYZRGBA;
+using CloudT = pcl::PointCloud<PointT>;
+using Partition = std::set<std::set<size_t>>;
+using Clock = std::chrono::steady_clock;
+
+struct BenchmarkResult {
+  double pcl_ms = 0.0;
+  double voxel_ms = 0.0;
+  size_t num_clusters = 0;
+  bool matches = true;
+};
+
+// vertices are colored by semantic label, so colors stand in for labels
+std::map<uint32_t, std::vector<size_t>> getColorIndices(const CloudT& cloud) {
+  std::map<uint32_t, std::vector<size_t>> color_indices;
+  for (size_t i = 0; i < cloud.size(); ++i) {
+    const auto& p = cloud[i];
+    color_indices[(p.r << 16) | (p.g << 8) | p.b].push_back(i);
+  }
+  return color_indices;
+}
+
+Partition clusterWithPcl(const CloudT::Ptr& cloud, const std::vector<size_t>& indices) {
+  pcl::IndicesPtr cloud_indices(new std::vector<int>(indices.begin(), indices.end()));
+  pcl::search::KdTree<PointT>::Ptr tree(new pcl::search::KdTree<PointT>());
+  tree->setInputCloud(cloud, cloud_indices);
+
+  pcl::EuclideanClusterExtraction<PointT> estimator;
+  estimator.setClusterTolerance(FLAGS_cluster_tolerance);
+  estimator.setMinClusterSize(FLAGS_min_cluster_size);
+  estimator.setMaxClusterSize(FLAGS_max_cluster_size);
+  estimator.setSearchMethod(tree);
+  estimator.setInputCloud(cloud);
+  estimator.setIndices(cloud_indices);
+
+  std::vector<pcl::PointIndices> clusters;
+  estimator.extract(clusters);
+
+  Partition partition;
+  for (const auto& cluster : clusters) {
+    partition.emplace(cluster.indices.begin(), cluster.indices.end());
+  }
+  return partition;
+}
+
+Partition clusterWithVoxels(const CloudT& cloud, const std::vector<size_t>& indices) {
+  std::vector<Eigen::Vector3f> points;
+  points.reserve(indices.size());
+  for (const auto idx : indices) {
+    points.push_back(cloud[idx].getVector3fMap());
+  }
+
+  const VoxelClusters clusters = findVoxelClusters(
+      points, FLAGS_cluster_tolerance, FLAGS_min_cluster_size, FLAGS_max_cluster_size);
+
+  Partition partition;
+  for (const auto& cluster : clusters) {
+    std::set<size_t> mesh_cluster;
+    for (const auto idx : cluster) {
+      mesh_cluster.insert(indices[idx]);
+    }
+    partition.insert(mesh_cluster);
+  }
+  return partition;
+}
+
+template <typename Func>
+double timeMs(const Func& func) {
+  const auto start = Clock::now();
+  func();
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+BenchmarkResult benchmarkCloud(const CloudT::Ptr& cloud) {
+  BenchmarkResult result;
+  for (const auto& color_indices : getColorIndices(*cloud)) {
+    const auto& indices = color_indices.second;
+    if (indices.size() < static_cast<size_t>(FLAGS_min_cluster_size)) {
+      continue;
+    }
+
+    Partition pcl_clusters;
+    Partition voxel_clusters;
+    for (int trial = 0; trial < FLAGS_num_trials; ++trial) {
+      result.pcl_ms += timeMs([&]() { pcl_clusters = clusterWithPcl(cloud, indices); });
+      result.voxel_ms +=
+          timeMs([&]() { voxel_clusters = clusterWithVoxels(*cloud, indices); });
+    }
+
+    result.num_clusters += pcl_clusters.size();
+    result.matches &= pcl_clusters == voxel_clusters;
+  }
+
+  result.pcl_ms /= FLAGS_num_trials;
+  result.voxel_ms /= FLAGS_num_trials;
+  return result;
+}
+
+int main(int argc, char* argv[]) {
+  FLAGS_logtostderr = 1;
+  FLAGS_colorlogtostderr = 1;
+
+  gflags::SetUsageMessage(
+      "compare pcl and voxel-hash clustering on recorded active mesh vertices\n"
+      "usage: clustering_benchmark [flags] CLOUD.pcd [CLOUD.pcd ...]\n"
+      "(record clouds with enable_active_mesh_pub set and: rosrun pcl_ros "
+      "pointcloud_to_pcd input:=<namespace>/active_mesh_vertices)");
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  if (argc < 2) {
+    std::cerr << gflags::ProgramUsage() << std::endl;
+    return 1;
+  }
+
+  BenchmarkResult total;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "cloud,num_points,num_clusters,pcl_ms,voxel_ms,speedup,matches"
+            << std::endl;
+  for (int i = 1; i < argc; ++i) {
+    CloudT::Ptr cloud(new CloudT());
+    if (pcl::io::loadPCDFile(argv[i], *cloud) != 0) {
+      LOG(ERROR) << "Failed to load " << argv[i];
+      continue;
+    }
+
+    const auto result = benchmarkCloud(cloud);
+    std::cout << argv[i] << "," << cloud->size() << "," << result.num_clusters << ","
+              << result.pcl_ms << "," << result.voxel_ms << ","
+              << result.pcl_ms / std::max(result.voxel_ms, 1.0e-9) << ","
+              << (result.matches ? "yes" : "no") << std::endl;
+
+    total.pcl_ms += result.pcl_ms;
+    total.voxel_ms += result.voxel_ms;
+    total.num_clusters += result.num_clusters;
+    total.matches &= result.matches;
+  }
+
+  std::cout << "total,," << total.num_clusters << "," << total.pcl_ms << ","
+            << total.voxel_ms << "," << total.pcl_ms / std::max(total.voxel_ms, 1.0e-9)
+            << "," << (total.matches ? "yes" : "no") << std::endl;
+  return total.matches ? 0 : 2;
+}
@@ -0,0 +1,349 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_dsg_builder/dsg_change_journal.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace hydra {
+namespace incremental {
+
+using EdgeSet = DsgChanges::EdgeSet;
+using NodeMergeMap = std::map<NodeId, NodeId>;
+
+namespace {
+
+inline std::pair<NodeId, NodeId> makeEdgeKey(NodeId source, NodeId target) {
+  return source < target ? std::make_pair(source, target)
+                         : std::make_pair(target, source);
+}
+
+inline bool isMerged(const NodeMergeMap* merges, NodeId node) {
+  return merges && merges->count(node);
+}
+
+inline NodeId resolve(const NodeMergeMap* merges, NodeId node) {
+  if (!merges) {
+    return node;
+  }
+
+  auto iter = merges->find(node);
+  return iter == merges->end() ? node : iter->second;
+}
+
+template <typename Attrs>
+bool assignAs(const NodeAttributes& source, NodeAttributes& target) {
+  const auto source_attrs = dynamic_cast<const Attrs*>(&source);
+  auto target_attrs = dynamic_cast<Attrs*>(&target);
+  if (!source_attrs || !target_attrs) {
+    return false;
+  }
+
+  *target_attrs = *source_attrs;
+  return true;
+}
+
+// attributes are updated in place (instead of being replaced by a clone) so that the
+// target keeps any node-level state (edges, parents, mesh edges) untouched
+bool assignAttributes(const NodeAttributes& source, NodeAttributes& target) {
+  // most derived types first
+  return assignAs<AgentNodeAttributes>(source, target) ||
+         assignAs<PlaceNodeAttributes>(source, target) ||
+         assignAs<ObjectNodeAttributes>(source, target) ||
+         assignAs<RoomNodeAttributes>(source, target) ||
+         assignAs<SemanticNodeAttributes>(source, target) ||
+         assignAs<NodeAttributes>(source, target);
+}
+
+inline bool shouldUpdate(const DsgMergeOptions& options, LayerId layer) {
+  if (!options.update_map) {
+    return true;
+  }
+
+  auto iter = options.update_map->find(layer);
+  return iter == options.update_map->end() ? true : iter->second;
+}
+
+void copyMeshEdges(const DynamicSceneGraph& source,
+                   NodeId node,
+                   DynamicSceneGraph& target,
+                   const DsgMergeOptions& options) {
+  if (options.clear_mesh_edges) {
+    for (const auto& idx : target.getMeshConnectionIndices(node)) {
+      target.removeMeshEdge(node, idx);
+    }
+  }
+
+  for (const auto& idx : source.getMeshConnectionIndices(node)) {
+    target.insertMeshEdge(node, idx, options.allow_invalid_mesh);
+  }
+}
+
+void addDynamicNodes(const DynamicSceneGraph& source,
+                     std::vector<NodeId>& nodes,
+                     DynamicSceneGraph& target) {
+  // dynamic nodes are indexed sequentially per prefix and have to be added in order
+  std::sort(nodes.begin(), nodes.end());
+  for (const auto& node_id : nodes) {
+    const DynamicSceneGraphNode& node = source.getDynamicNode(node_id).value();
+    const NodeSymbol symbol(node_id);
+    const size_t num_present = target.hasLayer(node.layer, symbol.category())
+                                   ? target.getLayer(node.layer, symbol.category())
+                                         .numNodes()
+                                   : 0;
+    if (num_present != symbol.categoryId()) {
+      LOG(WARNING) << "[DSG Journal] Cannot add " << symbol.getLabel()
+                   << ": target has " << num_present << " nodes with the same prefix";
+      continue;
+    }
+
+    target.emplaceNode(node.layer,
+                       symbol.category(),
+                       node.timestamp,
+                       node.attributes().clone());
+  }
+}
+
+}  // namespace
+
+DsgChangeJournal::ConsumerId DsgChangeJournal::addConsumer() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_.emplace_back();
+  pending_.back().full_sync = true;
+  return pending_.size() - 1;
+}
+
+void DsgChangeJournal::addNode(DsgChanges& changes, NodeId node) {
+  changes.removed_nodes.erase(node);
+  changes.nodes.insert(node);
+}
+
+void DsgChangeJournal::recordGraphChanges(DynamicSceneGraph& graph) {
+  // always clear the graph's tracking so that it doesn't grow without consumers
+  const auto new_nodes = graph.getNewNodes(true);
+  const auto removed_nodes = graph.getRemovedNodes(true);
+  const auto new_edges = graph.getNewEdges(true);
+  const auto removed_edges = graph.getRemovedEdges(true);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& pending : pending_) {
+    // removals first: a node or edge can be removed and re-added in one update
+    for (const auto& node : removed_nodes) {
+      pending.nodes.erase(node);
+      pending.removed_nodes.insert(node);
+    }
+
+    for (const auto& node : new_nodes) {
+      if (graph.hasNode(node)) {
+        addNode(pending, node);
+      }
+    }
+
+    for (const auto& edge : removed_edges) {
+      const auto key = makeEdgeKey(edge.k1, edge.k2);
+      pending.edges.erase(key);
+      pending.removed_edges.insert(key);
+    }
+
+    for (const auto& edge : new_edges) {
+      if (!graph.hasEdge(edge.k1, edge.k2)) {
+        continue;
+      }
+
+      const auto key = makeEdgeKey(edge.k1, edge.k2);
+      pending.removed_edges.erase(key);
+      pending.edges.insert(key);
+    }
+  }
+}
+
+DsgChanges DsgChangeJournal::popChanges(ConsumerId consumer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CHECK_LT(consumer, pending_.size()) << "Unknown journal consumer";
+  DsgChanges changes;
+  std::swap(changes, pending_[consumer]);
+  return changes;
+}
+
+size_t DsgChangeJournal::maxPending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t max_pending = 0;
+  for (const auto& pending : pending_) {
+    max_pending = std::max(max_pending, pending.size());
+  }
+  return max_pending;
+}
+
+void mergeChanges(const DynamicSceneGraph& source,
+                  const DsgChanges& changes,
+                  DynamicSceneGraph& target,
+                  const DsgMergeOptions& options) {
+  CHECK(!changes.full_sync) << "Full sync requested: use mergeGraph instead";
+  const auto merges = options.previous_merges;
+
+  for (const auto& edge : changes.removed_edges) {
+    const NodeId edge_source = resolve(merges, edge.first);
+    const NodeId edge_target = resolve(merges, edge.second);
+    if (target.hasEdge(edge_source, edge_target)) {
+      target.removeEdge(edge_source, edge_target);
+    }
+  }
+
+  for (const auto& node : changes.removed_nodes) {
+    // merged nodes are already gone from the target
+    if (!isMerged(merges, node) && target.hasNode(node)) {
+      target.removeNode(node);
+    }
+  }
+
+  std::vector<NodeId> new_dynamic_nodes;
+  for (const auto& node_id : changes.nodes) {
+    if (isMerged(merges, node_id)) {
+      continue;
+    }
+
+    if (source.isDynamic(node_id)) {
+      auto node_opt = source.getDynamicNode(node_id);
+      if (!node_opt) {
+        continue;  // removed after being recorded
+      }
+
+      if (!target.hasNode(node_id)) {
+        new_dynamic_nodes.push_back(node_id);
+        continue;
+      }
+
+      if (options.update_dynamic_attributes) {
+        const DynamicSceneGraphNode& node = *node_opt;
+        assignAttributes(
+            node.attributes(),
+            target.getDynamicNode(node_id)->get().attributes());
+      }
+      continue;
+    }
+
+    auto node_opt = source.getNode(node_id);
+    if (!node_opt) {
+      continue;  // removed after being recorded
+    }
+
+    const SceneGraphNode& node = *node_opt;
+    if (!target.hasNode(node_id)) {
+      target.emplaceNode(node.layer, node_id, node.attributes().clone());
+    } else if (shouldUpdate(options, node.layer)) {
+      assignAttributes(node.attributes(),
+                       target.getNode(node_id)->get().attributes());
+    }
+
+    copyMeshEdges(source, node_id, target, options);
+  }
+
+  addDynamicNodes(source, new_dynamic_nodes, target);
+
+  for (const auto& edge : changes.edges) {
+    auto edge_opt = source.getEdge(edge.first, edge.second);
+    if (!edge_opt) {
+      continue;  // removed after being recorded
+    }
+
+    const NodeId edge_source = resolve(merges, edge.first);
+    const NodeId edge_target = resolve(merges, edge.second);
+    if (edge_source == edge_target || !target.hasNode(edge_source) ||
+        !target.hasNode(edge_target) || target.hasEdge(edge_source, edge_target)) {
+      continue;
+    }
+
+    target.insertEdge(edge_source, edge_target, edge_opt->get().info->clone());
+  }
+}
+
+void mergeChanges(const DynamicSceneGraph& source,
+                  const DsgChanges& changes,
+                  IsolatedSceneGraphLayer& target) {
+  CHECK(!changes.full_sync) << "Full sync requested: use mergeLayer instead";
+
+  for (const auto& edge : changes.removed_edges) {
+    if (target.hasEdge(edge.first, edge.second)) {
+      target.removeEdge(edge.first, edge.second);
+    }
+  }
+
+  for (const auto& node_id : changes.removed_nodes) {
+    if (target.hasNode(node_id)) {
+      target.removeNode(node_id);
+    }
+  }
+
+  for (const auto& node_id : changes.nodes) {
+    if (source.isDynamic(node_id)) {
+      continue;
+    }
+
+    auto node_opt = source.getNode(node_id);
+    if (!node_opt) {
+      continue;  // removed after being recorded
+    }
+
+    const SceneGraphNode& node = *node_opt;
+    if (node.layer != target.id) {
+      continue;
+    }
+
+    if (!target.hasNode(node_id)) {
+      target.emplaceNode(node_id, node.attributes().clone());
+    } else {
+      assignAttributes(node.attributes(),
+                       target.getNode(node_id)->get().attributes());
+    }
+  }
+
+  for (const auto& edge : changes.edges) {
+    if (!target.hasNode(edge.first) || !target.hasNode(edge.second) ||
+        target.hasEdge(edge.first, edge.second)) {
+      continue;
+    }
+
+    auto edge_opt = source.getEdge(edge.first, edge.second);
+    if (!edge_opt) {
+      continue;  // removed after being recorded
+    }
+
+    target.insertEdge(edge.first, edge.second, edge_opt->get().info->clone());
+  }
+}
+
+}  // namespace incremental
+}  // namespace hydra
@@ -72,6 +72,7 @@ DsgBackend::DsgBackend(const ros::NodeHandle nh,
       nh_(nh),
       shared_dsg_(dsg),
       private_dsg_(backend_dsg),
+      journal_consumer_(dsg->changes.addConsumer()),
       shared_places_copy_(DsgLayers::PLACES),
       robot_id_(0) {
   config_ = load_config<DsgBackendConfig>(nh_);
@@ -144,32 +145,55 @@ void DsgBackend::start() {
 }
 
 bool DsgBackend::updatePrivateDsg() {
-  std::unique_lock<std::mutex> graph_lock(private_dsg_->mutex);
+  auto graph_lock = lockGraph(*private_dsg_, "backend/update_private_dsg");
   bool have_frontend_updates = shared_dsg_->updated;
   if (have_frontend_updates) {
     {  // start joint critical section
-      std::unique_lock<std::mutex> shared_graph_lock(shared_dsg_->mutex);
-      private_dsg_->graph->mergeGraph(*shared_dsg_->graph,
-                                      merged_nodes_,
-                                      false,
-                                      true,
-                                      &config_.merge_update_map,
-                                      config_.merge_update_dynamic);
-      *private_dsg_->latest_places = *shared_dsg_->latest_places;
-
-      if (shared_dsg_->graph->hasLayer(DsgLayers::PLACES)) {
-        // TODO(nathan) simplify
-        auto& places = shared_dsg_->graph->getLayer(DsgLayers::PLACES);
-        shared_places_copy_.mergeLayer(places, {});
-        std::vector<NodeId> removed_place_nodes;
-        places.getRemovedNodes(removed_place_nodes);
-        for (const auto& place_id : removed_place_nodes) {
-          shared_places_copy_.removeNode(place_id);
+      // only reads from the frontend graph, so the lcd thread can merge concurrently
+      auto shared_graph_lock = lockGraphShared(*shared_dsg_, "backend/merge_frontend");
+      const auto changes = shared_dsg_->changes.popChanges(journal_consumer_);
+      if (changes.full_sync) {
+        private_dsg_->graph->mergeGraph(*shared_dsg_->graph,
+                                        merged_nodes_,
+                                        false,
+                                        true,
+                                        &config_.merge_update_map,
+                                        config_.merge_update_dynamic);
+        if (shared_dsg_->graph->hasLayer(DsgLayers::PLACES)) {
+          shared_places_copy_.mergeLayer(
+              shared_dsg_->graph->getLayer(DsgLayers::PLACES), {});
         }
+      } else {
+        DsgMergeOptions options;
+        options.previous_merges = &merged_nodes_;
+        options.update_map = &config_.merge_update_map;
+        options.update_dynamic_attributes = config_.merge_update_dynamic;
+        mergeChanges(*shared_dsg_->graph, changes, *private_dsg_->graph, options);
+        mergeChanges(*shared_dsg_->graph, changes, shared_places_copy_);
       }
+      VLOG(3) << "[DSG Backend] merged " << changes.size() << " frontend changes"
+              << (changes.full_sync ? " (full sync)" : "");
+
+      *private_dsg_->latest_places = *shared_dsg_->latest_places;
+      private_dsg_->latest_places_time_ns = shared_dsg_->latest_places_time_ns;
       shared_dsg_->updated = false;
     }  // end joint critical section
 
+    // the frontend only journals places that changed, so unchanged active places
+    // are marked here instead of being copied from the frontend graph
+    for (const auto& node_id : *private_dsg_->latest_places) {
+      if (!private_dsg_->graph->hasNode(node_id)) {
+        continue;
+      }
+
+      auto& attrs = private_dsg_->graph->getNode(node_id)
+                        .value()
+                        .get()
+                        .attributes<PlaceNodeAttributes>();
+      attrs.is_active = true;
+      attrs.last_update_time_ns = private_dsg_->latest_places_time_ns;
+    }
+
     if (config_.should_log) {
       backend_graph_logger_.logGraph(private_dsg_->graph);
     }
@@ -355,7 +379,7 @@ bool DsgBackend::saveMeshCallback(std_srvs::Empty::Request&,
                                   std_srvs::Empty::Response&) {
   pcl::PolygonMesh opt_mesh;
   {
-    std::unique_lock<std::mutex> graph_lock(private_dsg_->mutex);
+    auto graph_lock = lockGraphShared(*private_dsg_, "backend/save_mesh");
     opt_mesh = private_dsg_->graph->getMesh();
   }
   // Save mesh
@@ -518,7 +542,7 @@ void DsgBackend::updateDsgMesh(bool force_mesh_update) {
                                                  interp_horizon_);
   {
     // start private dsg critical section
-    std::unique_lock<std::mutex> graph_lock(private_dsg_->mutex);
+    auto graph_lock = lockGraph(*private_dsg_, "backend/set_mesh");
     private_dsg_->graph->setMeshDirectly(opt_mesh);
   }
 
@@ -583,7 +607,7 @@ void DsgBackend::callUpdateFunctions(const gtsam::Values& places_values,
                                      const gtsam::Values& pgmo_values) {
   ScopedTimer spin_timer("backend/update_layers", last_timestamp_);
   {  // start private dsg critical section
-    std::unique_lock<std::mutex> graph_lock(private_dsg_->mutex);
+    auto graph_lock = lockGraph(*private_dsg_, "backend/update_layers");
     for (const auto& update_func : dsg_update_funcs_) {
       auto merged_nodes = update_func(*private_dsg_->graph,
                                       places_values,
@@ -649,7 +673,7 @@ void DsgBackend::updateRoomsNodes() {
 
 void DsgBackend::updateBuildingNode() {
   const NodeSymbol node_id('B', 0);
-  std::unique_lock<std::mutex> lock(private_dsg_->mutex);
+  auto lock = lockGraph(*private_dsg_, "backend/update_building");
   const auto& rooms = private_dsg_->graph->getLayer(DsgLayers::ROOMS);
 
   if (!rooms.numNodes()) {
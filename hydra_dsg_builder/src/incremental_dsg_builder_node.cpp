@@ -36,9 +36,14 @@
 #include "hydra_dsg_builder/incremental_dsg_frontend.h"
 #include "hydra_dsg_builder/incremental_dsg_lcd.h"
 
+#include <hydra_topology/topology_server.h>
 #include <hydra_utils/timing_utilities.h>
+#include <kimera_semantics_ros/semantic_tsdf_server.h>
+#include <ros/callback_queue.h>
+#include <ros/spinner.h>
 #include <ros/topic_manager.h>
 #include <std_srvs/Empty.h>
+#include <voxblox_ros/tsdf_server.h>
 
 using hydra::DsgLayers;
 using hydra::LayerId;
@@ -115,6 +120,49 @@ void spinUntilExitRequested() {
   ROS_WARN("Exiting!");
 }
 
+// runs the topology server in this process under the "topology" namespace, which lets
+// the active mesh and places reach the frontend by pointer instead of serialized
+/**
+ * @brief Topology server running in the builder's process
+ *
+ * The server gets its own callback queue and spinner thread: otherwise TSDF
+ * integration and GVD updates queue up behind frontend callbacks that hold the DSG
+ * lock. The queue is still served by a single thread, so the server's callbacks stay
+ * serialized like they are in the standalone node.
+ */
+class InProcessTopologyServer {
+ public:
+  explicit InProcessTopologyServer(const ros::NodeHandle& nh) {
+    using hydra::topology::TopologyServer;
+
+    ros::NodeHandle topology_nh(nh, "topology");
+    topology_nh.setCallbackQueue(&queue_);
+
+    bool use_semantic_tsdf_server = false;
+    topology_nh.getParam("use_semantic_tsdf_server", use_semantic_tsdf_server);
+    if (use_semantic_tsdf_server) {
+      using SemanticServer = TopologyServer<kimera::SemanticTsdfServer>;
+      server_ = std::make_shared<SemanticServer>(topology_nh);
+    } else {
+      server_ = std::make_shared<TopologyServer<voxblox::TsdfServer>>(topology_nh);
+    }
+
+    spinner_.reset(new ros::AsyncSpinner(1, &queue_));
+    spinner_->start();
+  }
+
+  ~InProcessTopologyServer() {
+    // no callbacks can run while the server is torn down
+    spinner_->stop();
+    server_.reset();
+  }
+
+ private:
+  ros::CallbackQueue queue_;
+  std::shared_ptr<void> server_;
+  std::unique_ptr<ros::AsyncSpinner> spinner_;
+};
+
 std::optional<uint64_t> getTimeNs(const hydra::DynamicSceneGraph& graph,
                                   gtsam::Symbol key) {
   hydra::NodeSymbol node(key.chr(), key.index());
@@ -149,6 +197,9 @@ int main(int argc, char* argv[]) {
 
   nh.getParam("disable_timer_output", ElapsedTimeRecorder::instance().disable_output);
 
+  bool run_topology = false;
+  nh.getParam("run_topology", run_topology);
+
   const LayerId mesh_layer_id = 1;
   const std::map<LayerId, char>& layer_id_map{{DsgLayers::OBJECTS, 'o'},
                                               {DsgLayers::PLACES, 'p'},
@@ -163,6 +214,12 @@ int main(int argc, char* argv[]) {
 
   std::list<hydra::incremental::LoopClosureLog> loop_closures;
   {  // scope for frontend / backend pair
+    // declared first so that it is destroyed after the frontend and backend
+    std::unique_ptr<InProcessTopologyServer> topology;
+    if (run_topology) {
+      topology.reset(new InProcessTopologyServer(nh));
+    }
+
     hydra::incremental::DsgBackend backend(nh, frontend_dsg, backend_dsg);
     hydra::incremental::DsgFrontend frontend(nh, frontend_dsg);
     std::shared_ptr<hydra::incremental::DsgLcd> lcd;
@@ -36,6 +36,7 @@
 
 #include <hydra_utils/timing_utilities.h>
 #include <kimera_pgmo/utils/CommonFunctions.h>
+#include <std_msgs/Empty.h>
 #include <tf2_eigen/tf2_eigen.h>
 
 #include <glog/logging.h>
@@ -45,6 +46,7 @@
 namespace hydra {
 namespace incremental {
 
+using hydra::timing::ElapsedTimeRecorder;
 using hydra::timing::ScopedTimer;
 using pose_graph_tools::PoseGraph;
 
@@ -71,6 +73,7 @@ void DsgFrontend::stop() {
   VLOG(2) << "[DSG Frontend] stopping frontend!";
 
   should_shutdown_ = true;
+  notifyStateChange();
   if (mesh_frontend_thread_) {
     VLOG(2) << "[DSG Frontend] joining mesh thread";
     mesh_frontend_thread_->join();
@@ -92,15 +95,21 @@ DsgFrontend::~DsgFrontend() {
 }
 
 void DsgFrontend::handleActivePlaces(const PlacesLayerMsg::ConstPtr& msg) {
-  std::unique_lock<std::mutex> queue_lock(places_queue_mutex_);
-  places_queue_.push(msg);
+  {  // start places queue critical section
+    std::unique_lock<std::mutex> queue_lock(places_queue_mutex_);
+    places_queue_.push(msg);
+  }  // end places queue critical section
+
+  notifyStateChange();
 }
 
 void DsgFrontend::handleLatestMesh(const hydra_msgs::ActiveMesh::ConstPtr& msg) {
   {  // start mesh frontend critical section
     std::unique_lock<std::mutex> mesh_lock(mesh_frontend_mutex_);
     if (mesh_queue_.size() < config_.mesh_queue_size) {
-      mesh_queue_.push(msg);
+      mesh_queue_.push({msg, std::chrono::steady_clock::now()});
+      mesh_lock.unlock();
+      notifyStateChange();
       return;
     }
   }  // end mesh frontend critical section
@@ -116,7 +125,7 @@ void DsgFrontend::handleLatestPoseGraph(const PoseGraph::ConstPtr& msg) {
     return;
   }
 
-  std::unique_lock<std::mutex> lock(dsg_->mutex);
+  auto lock = lockGraph(*dsg_, "frontend/pose_graph");
   const auto& agents = dsg_->graph->getLayer(DsgLayers::AGENTS, robot_prefix_);
 
   for (const auto& node : msg->nodes) {
@@ -144,6 +153,7 @@ void DsgFrontend::handleLatestPoseGraph(const PoseGraph::ConstPtr& msg) {
   }
 
   addAgentPlaceEdges();
+  dsg_->changes.recordGraphChanges(*dsg_->graph);
 }
 
 void DsgFrontend::start() {
@@ -201,36 +211,59 @@ std::optional<Eigen::Vector3d> DsgFrontend::getLatestPose() {
                          msg.transform.translation.z);
 }
 
+bool DsgFrontend::hasQueuedMesh() {
+  std::unique_lock<std::mutex> mesh_lock(mesh_frontend_mutex_);
+  return !mesh_queue_.empty();
+}
+
+void DsgFrontend::notifyStateChange() {
+  {  // taking the lock orders the state change before any waiter's predicate check
+    std::unique_lock<std::mutex> lock(state_mutex_);
+  }
+
+  state_cv_.notify_all();
+}
+
+bool DsgFrontend::waitForState(const std::function<bool()>& ready) {
+  std::unique_lock<std::mutex> lock(state_mutex_);
+  state_cv_.wait(lock, [&] { return should_shutdown_ || ready(); });
+  return !should_shutdown_;
+}
+
 void DsgFrontend::runMeshFrontend() {
-  ros::WallRate r(10);
   while (ros::ok() && !should_shutdown_) {
-    // identify if the places thread is waiting on a new mesh message
-    PlacesQueueState state = getPlacesQueueState();
-    bool newer_place_msg = !state.empty && state.timestamp_ns > last_mesh_timestamp_;
+    PlacesQueueState state;
+    const bool have_input = waitForState([&] {
+      // identify if the places thread is waiting on a new mesh message
+      state = getPlacesQueueState();
+      bool newer_place_msg = !state.empty && state.timestamp_ns > last_mesh_timestamp_;
+      // don't run ahead of the places thread
+      if (last_mesh_timestamp_ > last_places_timestamp_ && !newer_place_msg) {
+        return false;
+      }
 
-    if (last_mesh_timestamp_ > last_places_timestamp_ && !newer_place_msg) {
-      r.sleep();  // the mesh thread is running ahead, spin for a little bit
-      continue;
+      return hasQueuedMesh();
+    });
+
+    if (!have_input) {
+      break;
     }
 
-    hydra_msgs::ActiveMesh::ConstPtr msg(nullptr);
+    MeshQueueEntry entry;
     {  // start mesh critical region
       std::unique_lock<std::mutex> mesh_lock(mesh_frontend_mutex_);
-      if (!mesh_queue_.empty()) {
-        msg = mesh_queue_.front();
-        mesh_queue_.pop();
-      }
+      // this thread is the only consumer, so the queue can't have been emptied
+      entry = mesh_queue_.front();
+      mesh_queue_.pop();
     }  // end mesh critical region
 
-    if (!msg) {
-      r.sleep();
-      continue;
-    }
-
-    voxblox_msgs::Mesh::ConstPtr mesh_msg(new voxblox_msgs::Mesh(msg->mesh));
+    const hydra_msgs::ActiveMesh::ConstPtr& msg = entry.msg;
+    // aliases the mesh inside the active mesh message instead of copying it
+    voxblox_msgs::Mesh::ConstPtr mesh_msg(msg, &msg->mesh);
 
     // let the places thread start working on queued messages
     last_mesh_timestamp_ = msg->header.stamp.toNSec();
+    notifyStateChange();
     uint64_t object_timestamp = msg->header.stamp.toNSec();
     {  // start timing scope
       ScopedTimer timer(
@@ -247,23 +280,39 @@ void DsgFrontend::runMeshFrontend() {
       ScopedTimer timer("frontend/object_detection", object_timestamp, true, 1, false);
       const auto& invalid_indices = mesh_frontend_.getInvalidIndices();
       {  // start dsg critical section
-        std::unique_lock<std::mutex> lock(dsg_->mutex);
-        for (const auto& idx : invalid_indices) {
-          dsg_->graph->invalidateMeshVertex(idx);
-        }
-
+        auto lock = lockGraph(*dsg_, "frontend/object_detection");
+        // invalidating vertices drops mesh edges without the graph tracking it, so
+        // objects connected to an invalidated vertex get journaled explicitly
+        const std::unordered_set<size_t> invalid(invalid_indices.begin(),
+                                                 invalid_indices.end());
         std::vector<NodeId> objects_to_delete;
+        std::vector<NodeId> remeshed_objects;
         const auto& objects = dsg_->graph->getLayer(DsgLayers::OBJECTS);
         for (const auto& id_node_pair : objects.nodes()) {
-          auto connections = dsg_->graph->getMeshConnectionIndices(id_node_pair.first);
-          if (connections.size() < config_.min_object_vertices) {
+          const auto connections =
+              dsg_->graph->getMeshConnectionIndices(id_node_pair.first);
+          size_t num_invalid = 0;
+          for (const auto& vertex : connections) {
+            num_invalid += invalid.count(vertex);
+          }
+
+          if (connections.size() - num_invalid < config_.min_object_vertices) {
             objects_to_delete.push_back(id_node_pair.first);
+          } else if (num_invalid > 0) {
+            remeshed_objects.push_back(id_node_pair.first);
           }
         }
 
+        for (const auto& idx : invalid_indices) {
+          dsg_->graph->invalidateMeshVertex(idx);
+        }
+
         for (const auto& node : objects_to_delete) {
           dsg_->graph->removeNode(node);
         }
+
+        dsg_->changes.recordUpdatedNodes(remeshed_objects);
+        dsg_->changes.recordGraphChanges(*dsg_->graph);
       }  // end dsg critical section
 
       object_clusters = segmenter_->detectObjects(
@@ -272,20 +321,23 @@ void DsgFrontend::runMeshFrontend() {
 
     {  // start dsg critical section
       ScopedTimer timer("frontend/object_graph_update", last_places_timestamp_);
-      std::unique_lock<std::mutex> lock(dsg_->mutex);
+      auto lock = lockGraph(*dsg_, "frontend/object_graph_update");
       segmenter_->updateGraph(*dsg_->graph, object_clusters, last_places_timestamp_);
       addPlaceObjectEdges();
+      dsg_->changes.recordUpdatedNodes(segmenter_->getUpdatedObjects());
+      dsg_->changes.recordGraphChanges(*dsg_->graph);
     }  // end dsg critical section
 
     if (state.timestamp_ns != last_mesh_timestamp_) {
       dsg_->updated = true;
+      recordUpdateLatency(entry);
       continue;  // places dropped a message or is ahead of us, so we don't need
                  // to update the mapping
     }
 
     // wait for the places thread to finish the latest message
-    while (!should_shutdown_ && last_mesh_timestamp_ > last_places_timestamp_) {
-      r.sleep();
+    if (!waitForState([&] { return last_mesh_timestamp_ <= last_places_timestamp_; })) {
+      break;
     }
 
     {
@@ -294,12 +346,24 @@ void DsgFrontend::runMeshFrontend() {
     }
 
     dsg_->updated = true;
+    recordUpdateLatency(entry);
   }
 }
 
+void DsgFrontend::recordUpdateLatency(const MeshQueueEntry& entry) const {
+  const auto elapsed = std::chrono::steady_clock::now() - entry.arrival;
+  ElapsedTimeRecorder::instance().record(
+      "frontend/update_latency",
+      entry.msg->header.stamp.toNSec(),
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+  VLOG(2) << "[DSG Frontend] update latency: "
+          << std::chrono::duration<double>(elapsed).count() << " [s]";
+}
+
 void DsgFrontend::startPlaces() {
   active_places_sub_ =
       nh_.subscribe("active_places", 5, &DsgFrontend::handleActivePlaces, this);
+  places_resync_pub_ = nh_.advertise<std_msgs::Empty>("active_places_resync", 1);
 
   places_thread_.reset(new std::thread(&DsgFrontend::runPlaces, this));
 }
@@ -314,13 +378,15 @@ PlacesQueueState DsgFrontend::getPlacesQueueState() {
 }
 
 void DsgFrontend::runPlaces() {
-  ros::WallRate r(10);
   while (ros::ok() && !should_shutdown_) {
-    PlacesQueueState state = getPlacesQueueState();
-    if (state.empty || state.timestamp_ns > last_mesh_timestamp_) {
-      // we only sleep if there's no pending work
-      r.sleep();
-      continue;
+    const bool have_input = waitForState([&] {
+      // places messages are only processed once the matching mesh has started
+      PlacesQueueState state = getPlacesQueueState();
+      return !state.empty && state.timestamp_ns <= last_mesh_timestamp_;
+    });
+
+    if (!have_input) {
+      break;
     }
 
     // we only peek at the current message (to gate mesh processing)
@@ -342,11 +408,13 @@ void DsgFrontend::runPlaces() {
       std::unique_lock<std::mutex> places_lock(places_queue_mutex_);
       places_queue_.pop();
     }  // end places queue critical section
+    notifyStateChange();
 
     {  // start graph update critical section
-      std::unique_lock<std::mutex> graph_lock(dsg_->mutex);
+      auto graph_lock = lockGraph(*dsg_, "frontend/archive_places");
 
       // find node ids that are valid, but outside active place window
+      std::vector<NodeId> archived;
       for (const auto& prev : previous_active_places_) {
         if (latest_places.count(prev)) {
           continue;
@@ -365,9 +433,15 @@ void DsgFrontend::runPlaces() {
               .is_active = false;
         }
 
-        dsg_->archived_places.insert(prev);
+        {  // start archived critical section
+          std::lock_guard<std::mutex> archived_lock(dsg_->archived_places_mutex);
+          dsg_->archived_places.insert(prev);
+        }  // end archived critical section
+        archived.push_back(prev);
       }
 
+      dsg_->changes.recordUpdatedNodes(archived);
+
       dsg_->last_update_time = curr_message->header.stamp.toNSec();
     }  // end graph update critical section
 
@@ -375,9 +449,10 @@ void DsgFrontend::runPlaces() {
 
     // TODO(nathan) consider moving timestamp solely to dsg structure
     last_places_timestamp_ = curr_message->header.stamp.toNSec();
+    notifyStateChange();
 
     if (config_.should_log) {
-      std::unique_lock<std::mutex> graph_lock(dsg_->mutex);
+      auto graph_lock = lockGraphShared(*dsg_, "frontend/log_graph");
       frontend_graph_logger_.logGraph(dsg_->graph);
     }
     // dsg_->updated = true;
@@ -387,18 +462,45 @@ void DsgFrontend::runPlaces() {
 void DsgFrontend::processLatestPlacesMsg(const PlacesLayerMsg::ConstPtr& msg) {
   const uint64_t msg_time_ns = msg->header.stamp.toNSec();
   ScopedTimer timer("frontend/update_places", msg_time_ns, true, 2, false);
+
+  const bool in_sequence =
+      have_places_sequence_ && msg->sequence_number == last_places_sequence_ + 1;
+  if (!msg->full_update && !in_sequence) {
+    // deltas can only be applied on top of the previous message: drop them until the
+    // topology server sends a full update
+    LOG(WARNING) << "[Places Frontend] Dropping places update "
+                 << msg->sequence_number << ": waiting for full update";
+    have_places_sequence_ = false;
+    places_resync_pub_.publish(std_msgs::Empty());
+    return;
+  }
+
+  have_places_sequence_ = true;
+  last_places_sequence_ = msg->sequence_number;
+
   SceneGraphLayer temp_layer(DsgLayers::PLACES);
   std::unique_ptr<SceneGraphLayer::Edges> edges =
       temp_layer.deserializeLayer(msg->layer_contents);
   VLOG(3) << "[Places Frontend] Received " << temp_layer.numNodes() << " nodes and "
-          << edges->size() << " edges from hydra_topology";
+          << edges->size() << " edges from hydra_topology ("
+          << (msg->full_update ? "full" : "incremental") << " update)";
+
+  if (msg->full_update) {
+    active_places_.clear();
+  }
 
-  NodeIdSet active_nodes;
+  NodeIdSet updated_nodes;
   for (const auto& id_node_pair : temp_layer.nodes()) {
-    active_nodes.insert(id_node_pair.first);
-    auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
-    attrs.is_active = true;
-    attrs.last_update_time_ns = msg_time_ns;
+    updated_nodes.insert(id_node_pair.first);
+    active_places_.insert(id_node_pair.first);
+  }
+
+  for (const auto& node_id : msg->deleted_nodes) {
+    active_places_.erase(node_id);
+  }
+
+  for (const auto& node_id : msg->archived_nodes) {
+    active_places_.erase(node_id);
   }
 
   const auto& objects = dsg_->graph->getLayer(DsgLayers::OBJECTS);
@@ -406,7 +508,7 @@ void DsgFrontend::processLatestPlacesMsg(const PlacesLayerMsg::ConstPtr& msg) {
 
   NodeIdSet objects_to_check;
   {  // start graph update critical section
-    std::unique_lock<std::mutex> graph_lock(dsg_->mutex);
+    auto graph_lock = lockGraph(*dsg_, "frontend/update_places");
     for (const auto& node_id : msg->deleted_nodes) {
       if (dsg_->graph->hasNode(node_id)) {
         const SceneGraphNode& to_check = dsg_->graph->getNode(node_id).value();
@@ -425,12 +527,52 @@ void DsgFrontend::processLatestPlacesMsg(const PlacesLayerMsg::ConstPtr& msg) {
     // TODO(nathan) figure out reindexing (for more logical node ids)
     dsg_->graph->updateFromLayer(temp_layer, std::move(edges));
 
-    places_nn_finder_.reset(new NearestNodeFinder(places, active_nodes));
+    // unchanged active places are not in the message but still count as updated
+    for (const auto& node_id : active_places_) {
+      if (!dsg_->graph->hasNode(node_id)) {
+        continue;
+      }
+
+      auto& attrs = dsg_->graph->getNode(node_id)
+                        .value()
+                        .get()
+                        .attributes<PlaceNodeAttributes>();
+      attrs.is_active = true;
+      attrs.last_update_time_ns = msg_time_ns;
+    }
+
+    if (!places_nn_finder_) {
+      places_nn_finder_.reset(new IncrementalNodeFinder());
+    }
+
+    if (msg->full_update) {
+      places_nn_finder_->update(places, active_places_);
+    } else {
+      // only changed places move in the index
+      for (const auto& node_id : updated_nodes) {
+        if (active_places_.count(node_id)) {
+          places_nn_finder_->insert(node_id, places.getPosition(node_id));
+        }
+      }
+
+      for (const auto& node_id : msg->deleted_nodes) {
+        places_nn_finder_->erase(node_id);
+      }
+
+      for (const auto& node_id : msg->archived_nodes) {
+        places_nn_finder_->erase(node_id);
+      }
+    }
 
     addAgentPlaceEdges();
     addPlaceObjectEdges(&objects_to_check);
 
-    *dsg_->latest_places = active_nodes;
+    *dsg_->latest_places = active_places_;
+    dsg_->latest_places_time_ns = msg_time_ns;
+
+    // consumers derive activity of unchanged places from latest_places
+    dsg_->changes.recordUpdatedNodes(updated_nodes);
+    dsg_->changes.recordGraphChanges(*dsg_->graph);
   }  // end graph update critical section
 
   VLOG(3) << "[Places Frontend] Places layer: " << places.numNodes() << " nodes, "
@@ -449,17 +591,24 @@ void DsgFrontend::addPlaceObjectEdges(NodeIdSet* extra_objects_to_check) {
                             extra_objects_to_check->end());
   }
 
+  std::vector<NodeId> valid_objects;
+  valid_objects.reserve(objects_to_check.size());
   for (const auto& object_id : objects_to_check) {
-    if (!dsg_->graph->hasNode(object_id)) {
-      continue;
+    if (dsg_->graph->hasNode(object_id)) {
+      valid_objects.push_back(object_id);
     }
-    const Eigen::Vector3d object_position = dsg_->graph->getPosition(object_id);
-    places_nn_finder_->find(
-        object_position, 1, false, [&](NodeId place_id, size_t, double) {
-          dsg_->graph->insertEdge(place_id, object_id);
-        });
   }
 
+  Eigen::Matrix3Xd object_positions(3, valid_objects.size());
+  for (size_t i = 0; i < valid_objects.size(); ++i) {
+    object_positions.col(i) = dsg_->graph->getPosition(valid_objects[i]);
+  }
+
+  places_nn_finder_->findMany(
+      object_positions, 1, false, [&](size_t i, NodeId place_id, size_t, double) {
+        dsg_->graph->insertEdge(place_id, valid_objects[i]);
+      });
+
   segmenter_->pruneObjectsToCheckForPlaces(*dsg_->graph);
 }
 
@@ -477,33 +626,44 @@ void DsgFrontend::addAgentPlaceEdges() {
       last_agent_edge_index_[prefix] = 0;
     }
 
-    for (size_t i = last_agent_edge_index_[prefix]; i < layer.numNodes(); ++i) {
-      places_nn_finder_->find(
-          layer.getPositionByIndex(i), 1, false, [&](NodeId place_id, size_t, double) {
-            CHECK(dsg_->graph->insertEdge(place_id, prefix.makeId(i)));
-          });
+    const size_t start = last_agent_edge_index_[prefix];
+    const size_t num_new = layer.numNodes() > start ? layer.numNodes() - start : 0;
+    Eigen::Matrix3Xd agent_positions(3, num_new);
+    for (size_t i = 0; i < num_new; ++i) {
+      agent_positions.col(i) = layer.getPositionByIndex(start + i);
     }
+
+    places_nn_finder_->findMany(
+        agent_positions, 1, false, [&](size_t i, NodeId place_id, size_t, double) {
+          CHECK(dsg_->graph->insertEdge(place_id, prefix.makeId(start + i)));
+        });
     last_agent_edge_index_[prefix] = layer.numNodes();
   }
 
-  for (const auto& node : deleted_agent_edge_indices_) {
-    const Eigen::Vector3d pos = dsg_->graph->getPosition(node);
-    places_nn_finder_->find(pos, 1, false, [&](NodeId place_id, size_t, double) {
-      CHECK(dsg_->graph->insertEdge(place_id, node));
-    });
+  const std::vector<NodeId> deleted_nodes(deleted_agent_edge_indices_.begin(),
+                                          deleted_agent_edge_indices_.end());
+  Eigen::Matrix3Xd deleted_positions(3, deleted_nodes.size());
+  for (size_t i = 0; i < deleted_nodes.size(); ++i) {
+    deleted_positions.col(i) = dsg_->graph->getPosition(deleted_nodes[i]);
   }
 
+  places_nn_finder_->findMany(
+      deleted_positions, 1, false, [&](size_t i, NodeId place_id, size_t, double) {
+        CHECK(dsg_->graph->insertEdge(place_id, deleted_nodes[i]));
+      });
+
   deleted_agent_edge_indices_.clear();
 }
 
 void DsgFrontend::updatePlaceMeshMapping() {
-  std::unique_lock<std::mutex> lock(dsg_->mutex);
+  auto lock = lockGraph(*dsg_, "frontend/place_mesh_mapping");
   const auto& places = dsg_->graph->getLayer(DsgLayers::PLACES);
   const auto& mesh_mappings = mesh_frontend_.getVoxbloxMsgToGraphMapping();
 
   size_t num_invalid = 0;
   size_t num_processed = 0;
   size_t num_vertices_processed = 0;
+  std::vector<NodeId> remapped;
   for (const auto& id_node_pair : places.nodes()) {
     auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
     if (!attrs.is_active) {
@@ -515,6 +675,7 @@ void DsgFrontend::updatePlaceMeshMapping() {
     }
 
     ++num_processed;
+    remapped.push_back(id_node_pair.first);
 
     // reset connections (and mark inactive to avoid processing outside active window)
     attrs.pcl_mesh_connections.clear();
@@ -540,6 +701,8 @@ void DsgFrontend::updatePlaceMeshMapping() {
     }
   }
 
+  dsg_->changes.recordUpdatedNodes(remapped);
+
   VLOG(2) << "[DSG Frontend] Mesh-Remapping: " << num_processed << " places, "
           << num_vertices_processed << " vertices";
 
@@ -45,7 +45,10 @@ using hydra::timing::ScopedTimer;
 using lcd::LayerRegistrationConfig;
 
 DsgLcd::DsgLcd(const ros::NodeHandle& nh, const SharedDsgInfo::Ptr& dsg)
-    : nh_(nh), dsg_(dsg), lcd_graph_(new DynamicSceneGraph()) {
+    : nh_(nh),
+      dsg_(dsg),
+      journal_consumer_(dsg->changes.addConsumer()),
+      lcd_graph_(new DynamicSceneGraph()) {
   // TODO(nathan) rethink
   int robot_id = 0;
   nh_.getParam("robot_id", robot_id);
@@ -73,7 +76,7 @@ void DsgLcd::stop() {
 DsgLcd::~DsgLcd() { stop(); }
 
 void DsgLcd::handleDbowMsg(const pose_graph_tools::BowQuery::ConstPtr& msg) {
-  std::unique_lock<std::mutex> lock(dsg_->mutex);
+  std::unique_lock<std::mutex> lock(bow_mutex_);
   bow_messages_.push_back(msg);
 }
 
@@ -137,9 +140,18 @@ void DsgLcd::runLcd() {
     assignBowVectors();
 
     {  // start critical section
-      std::unique_lock<std::mutex> lock(dsg_->mutex);
-      lcd_graph_->mergeGraph(*dsg_->graph);
+      // only reads from the frontend graph, so the backend can merge concurrently
+      auto lock = lockGraphShared(*dsg_, "lcd/merge_frontend");
+      const auto changes = dsg_->changes.popChanges(journal_consumer_);
+      if (changes.full_sync) {
+        lcd_graph_->mergeGraph(*dsg_->graph);
+      } else {
+        mergeChanges(*dsg_->graph, changes, *lcd_graph_);
+      }
 
+      // read in the same section as the merge so that every archived place is
+      // already in the lcd graph
+      std::lock_guard<std::mutex> archived_lock(dsg_->archived_places_mutex);
       potential_lcd_root_nodes_.insert(potential_lcd_root_nodes_.end(),
                                        dsg_->archived_places.begin(),
                                        dsg_->archived_places.end());
@@ -170,6 +182,12 @@ void DsgLcd::runLcd() {
     NodeIdSet to_cache;
     auto iter = potential_lcd_root_nodes_.begin();
     while (iter != potential_lcd_root_nodes_.end()) {
+      if (!lcd_graph_->hasNode(*iter)) {
+        // the place was deleted after it was archived
+        iter = potential_lcd_root_nodes_.erase(iter);
+        continue;
+      }
+
       const Eigen::Vector3d pos = lcd_graph_->getPosition(*iter);
       if ((latest_pos - pos).norm() < config_.descriptor_creation_horizon_m) {
         ++iter;
@@ -216,34 +234,68 @@ void DsgLcd::runLcd() {
 }
 
 void DsgLcd::assignBowVectors() {
-  std::unique_lock<std::mutex> lock(dsg_->mutex);
-  const auto& agents = dsg_->graph->getLayer(DsgLayers::AGENTS, robot_prefix_);
+  std::list<pose_graph_tools::BowQuery::ConstPtr> messages;
+  {  // start bow critical section
+    std::unique_lock<std::mutex> bow_lock(bow_mutex_);
+    messages.swap(bow_messages_);
+  }  // end bow critical section
+
+  if (messages.empty()) {
+    return;
+  }
+
+  const size_t prior_size = messages.size();
+  {  // start dsg critical section
+    auto lock = lockGraph(*dsg_, "lcd/assign_bow_vectors");
+    for (const auto& node_id :
+         incremental::assignBowVectors(*dsg_, robot_prefix_, messages)) {
+      lcd_queue_.push(node_id);
+    }
+  }  // end dsg critical section
 
-  const size_t prior_size = bow_messages_.size();
-  auto iter = bow_messages_.begin();
-  while (iter != bow_messages_.end()) {
+  VLOG(3) << "[DSG LCD] " << messages.size() << " of " << prior_size
+          << " bow vectors unassigned";
+
+  {  // start bow critical section
+    // keep unassigned vectors (in order) ahead of anything that arrived meanwhile
+    std::unique_lock<std::mutex> bow_lock(bow_mutex_);
+    bow_messages_.splice(bow_messages_.begin(), messages);
+  }  // end bow critical section
+}
+
+std::vector<NodeId> assignBowVectors(
+    SharedDsgInfo& dsg,
+    char robot_prefix,
+    std::list<pose_graph_tools::BowQuery::ConstPtr>& messages) {
+  std::vector<NodeId> assigned;
+  const auto& agents = dsg.graph->getLayer(DsgLayers::AGENTS, robot_prefix);
+
+  auto iter = messages.begin();
+  while (iter != messages.end()) {
     // TODO(nathan) implicit assumption that gtsam symbol and dsg node symbol are same
     const auto& msg = *iter;
     char prefix = kimera_pgmo::robot_id_to_prefix.at(msg->robot_id);
     NodeSymbol pgmo_key(prefix, msg->pose_id);
-    if (dsg_->agent_key_map.count(pgmo_key)) {
-      const auto& node = agents.getNodeByIndex(dsg_->agent_key_map.at(pgmo_key))->get();
-      lcd_queue_.push(node.id);
-
-      AgentNodeAttributes& attrs = node.attributes<AgentNodeAttributes>();
-      attrs.dbow_ids = Eigen::Map<const AgentNodeAttributes::BowIdVector>(
-          msg->bow_vector.word_ids.data(), msg->bow_vector.word_ids.size());
-      attrs.dbow_values = Eigen::Map<const Eigen::VectorXf>(
-          msg->bow_vector.word_values.data(), msg->bow_vector.word_values.size());
-
-      iter = bow_messages_.erase(iter);
-    } else {
+    if (!dsg.agent_key_map.count(pgmo_key)) {
       ++iter;
+      continue;
     }
+
+    const auto& node = agents.getNodeByIndex(dsg.agent_key_map.at(pgmo_key))->get();
+    AgentNodeAttributes& attrs = node.attributes<AgentNodeAttributes>();
+    attrs.dbow_ids = Eigen::Map<const AgentNodeAttributes::BowIdVector>(
+        msg->bow_vector.word_ids.data(), msg->bow_vector.word_ids.size());
+    attrs.dbow_values = Eigen::Map<const Eigen::VectorXf>(
+        msg->bow_vector.word_values.data(), msg->bow_vector.word_values.size());
+
+    assigned.push_back(node.id);
+    iter = messages.erase(iter);
   }
 
-  VLOG(3) << "[DSG LCD] " << bow_messages_.size() << " of " << prior_size
-          << " bow vectors unassigned";
+  // the agents were most likely already merged by the consumers, which only pick up
+  // the new vectors through the journal
+  dsg.changes.recordUpdatedNodes(assigned);
+  return assigned;
 }
 
 }  // namespace incremental
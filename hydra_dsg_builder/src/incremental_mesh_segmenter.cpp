@@ -33,15 +33,19 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #include "hydra_dsg_builder/incremental_mesh_segmenter.h"
+#include "hydra_dsg_builder/voxel_clustering.h"
 
 #include <hydra_utils/timing_utilities.h>
 #include <kimera_semantics_ros/ros_params.h>
-#include <pcl/segmentation/extract_clusters.h>
+#include <pcl/common/io.h>
+#include <pcl/search/kdtree.h>
 #include <pcl_conversions/pcl_conversions.h>
 #include <pcl_ros/point_cloud.h>
 
 #include <glog/logging.h>
 
+#include <algorithm>
+
 namespace hydra {
 namespace incremental {
 
@@ -108,6 +112,7 @@ MeshSegmenter::MeshSegmenter(const ros::NodeHandle& nh,
       active_object_horizon_s_(10.0),
       active_index_horizon_m_(5.0),
       cluster_tolerance_(0.25),
+      use_voxel_clustering_(false),
       enable_active_mesh_pub_(false),
       enable_segmented_mesh_pub_(false) {
   // TODO(nathan) make a config
@@ -120,9 +125,16 @@ MeshSegmenter::MeshSegmenter(const ros::NodeHandle& nh,
   int max_cluster_size = 100000;
   nh_.getParam("max_cluster_size", max_cluster_size);
   max_cluster_size_ = static_cast<size_t>(max_cluster_size);
+  nh_.getParam("use_voxel_clustering", use_voxel_clustering_);
   nh_.getParam("enable_active_mesh_pub", enable_active_mesh_pub_);
   nh_.getParam("enable_segmented_mesh_pub", enable_segmented_mesh_pub_);
 
+  int num_clustering_threads = 4;
+  nh_.getParam("num_clustering_threads", num_clustering_threads);
+  if (num_clustering_threads > 1) {
+    thread_pool_.reset(new topology::ThreadPool(num_clustering_threads));
+  }
+
   double object_detection_period_s = 0.5;
   nh_.getParam("object_detection_period_s", object_detection_period_s);
 
@@ -155,40 +167,91 @@ MeshSegmenter::~MeshSegmenter() {
   segmented_mesh_vertices_pub_.reset();
 }
 
-Clusters MeshSegmenter::findClusters(const MeshVertexCloud::Ptr& cloud,
-                                     const std::vector<size_t>& indices) const {
-  CHECK(cloud);
+struct MeshSegmenter::ObjectVertexIndex {
+  using PointT = pcl::PointXYZ;
+  using CloudT = pcl::PointCloud<PointT>;
 
-  // in general, this is unsafe, but PCL doesn't offer us any alternative
-  pcl::IndicesPtr cloud_indices(new std::vector<int>(indices.begin(), indices.end()));
+  //! positions of every vertex to cluster (vertices of the same label are contiguous)
+  CloudT::Ptr cloud;
+  pcl::search::KdTree<PointT> tree;
+  std::vector<size_t> mesh_indices;
+  std::vector<uint8_t> labels;
+  //! [start, end) of the vertices of each label
+  std::map<uint8_t, std::pair<size_t, size_t>> spans;
+};
 
-  KdTreeT::Ptr tree(new KdTreeT());
-  tree->setInputCloud(cloud, cloud_indices);
+Clusters MeshSegmenter::findClusters(const ObjectVertexIndex& index,
+                                     uint8_t label,
+                                     std::vector<uint8_t>& processed) const {
+  // same as pcl::EuclideanClusterExtraction, but neighbors of other labels (which
+  // share the index) are skipped. Each label only touches its own entries of processed
+  const auto& span = index.spans.at(label);
 
-  pcl::EuclideanClusterExtraction<Cluster::PointT> estimator;
-  estimator.setClusterTolerance(cluster_tolerance_);
-  estimator.setMinClusterSize(min_cluster_size_);
-  estimator.setMaxClusterSize(max_cluster_size_);
-  estimator.setSearchMethod(tree);
-  estimator.setInputCloud(cloud);
-  estimator.setIndices(cloud_indices);
+  Clusters clusters;
+  std::vector<int> neighbors;
+  std::vector<float> distances;
+  for (size_t seed = span.first; seed < span.second; ++seed) {
+    if (processed[seed]) {
+      continue;
+    }
 
-  std::vector<pcl::PointIndices> cluster_indices;
-  estimator.extract(cluster_indices);
+    std::vector<int> members{static_cast<int>(seed)};
+    processed[seed] = 1;
+    for (size_t i = 0; i < members.size(); ++i) {
+      index.tree.radiusSearch(members[i], cluster_tolerance_, neighbors, distances);
+      for (const auto neighbor : neighbors) {
+        if (index.labels[neighbor] != label || processed[neighbor]) {
+          continue;
+        }
 
-  Clusters clusters;
-  clusters.resize(cluster_indices.size());
-  for (size_t k = 0; k < clusters.size(); ++k) {
-    clusters.at(k).indices = cluster_indices.at(k);
-    clusters.at(k).cloud.reset(new MeshVertexCloud());
+        processed[neighbor] = 1;
+        members.push_back(neighbor);
+      }
+    }
 
-    const auto& object_indices = cluster_indices.at(k).indices;
-    clusters.at(k).cloud->resize(object_indices.size());
+    if (members.size() < min_cluster_size_ || members.size() > max_cluster_size_) {
+      continue;
+    }
 
-    for (size_t i = 0; i < object_indices.size(); ++i) {
-      const auto& cp = cloud->at(object_indices.at(i));
-      clusters.at(k).cloud->at(i) = cp;
-      clusters.at(k).centroid.add(pcl::PointXYZ(cp.x, cp.y, cp.z));
+    Cluster cluster;
+    cluster.indices.indices.reserve(members.size());
+    for (const auto member : members) {
+      cluster.indices.indices.push_back(index.mesh_indices[member]);
+      cluster.centroid.add(index.cloud->at(member));
+    }
+
+    clusters.push_back(std::move(cluster));
+  }
+
+  // match the ordering of pcl::EuclideanClusterExtraction (largest first)
+  std::sort(clusters.begin(), clusters.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.indices.indices.size() > rhs.indices.indices.size();
+  });
+
+  return clusters;
+}
+
+Clusters MeshSegmenter::findVoxelHashClusters(const ObjectVertexIndex& index,
+                                              uint8_t label) const {
+  const auto& span = index.spans.at(label);
+
+  std::vector<Eigen::Vector3f> points;
+  points.reserve(span.second - span.first);
+  for (size_t i = span.first; i < span.second; ++i) {
+    points.push_back(index.cloud->at(i).getVector3fMap());
+  }
+
+  const auto voxel_clusters = findVoxelClusters(
+      points, cluster_tolerance_, min_cluster_size_, max_cluster_size_);
+
+  Clusters clusters(voxel_clusters.size());
+  for (size_t k = 0; k < clusters.size(); ++k) {
+    auto& cluster = clusters[k];
+    cluster.indices.indices.reserve(voxel_clusters[k].size());
+    for (const auto point_idx : voxel_clusters[k]) {
+      const size_t member = span.first + point_idx;
+      cluster.indices.indices.push_back(index.mesh_indices[member]);
+      cluster.centroid.add(index.cloud->at(member));
     }
   }
 
@@ -211,21 +274,59 @@ LabelClusters MeshSegmenter::findNewObjectClusters(
   }
   publishObjectClouds(label_indices);
 
-  VLOG(3) << "[Object Detection] Detecting objects";
+  // a single spatial index over every label that could form a cluster
+  ObjectVertexIndex index;
+  index.cloud.reset(new ObjectVertexIndex::CloudT());
+  std::vector<uint8_t> labels;
   for (const auto label : object_labels_) {
     if (!label_indices.count(label)) {
       continue;
     }
 
-    if (label_indices.at(label).size() < min_cluster_size_) {
+    const auto& indices = label_indices.at(label);
+    if (indices.size() < min_cluster_size_) {
       continue;
     }
 
-    const auto clusters = findClusters(full_mesh_vertices_, label_indices.at(label));
+    labels.push_back(label);
+    index.spans[label] = {index.mesh_indices.size(),
+                          index.mesh_indices.size() + indices.size()};
+    for (const auto idx : indices) {
+      const auto& point = full_mesh_vertices_->at(idx);
+      index.cloud->push_back(ObjectVertexIndex::PointT(point.x, point.y, point.z));
+      index.mesh_indices.push_back(idx);
+      index.labels.push_back(label);
+    }
+  }
 
-    VLOG(3) << "[Object Detection]  - Found " << clusters.size() << " objects of label "
-            << static_cast<int>(label);
-    object_clusters.insert({label, clusters});
+  if (labels.empty()) {
+    return object_clusters;
+  }
+
+  if (!use_voxel_clustering_) {
+    index.tree.setInputCloud(index.cloud);
+  }
+
+  VLOG(3) << "[Object Detection] Detecting objects";
+  std::vector<uint8_t> processed(index.mesh_indices.size(), 0);
+  std::vector<Clusters> clusters(labels.size());
+  const auto cluster_label = [&](size_t i) {
+    clusters[i] = use_voxel_clustering_ ? findVoxelHashClusters(index, labels[i])
+                                        : findClusters(index, labels[i], processed);
+  };
+
+  if (thread_pool_) {
+    thread_pool_->parallelFor(labels.size(), cluster_label);
+  } else {
+    for (size_t i = 0; i < labels.size(); ++i) {
+      cluster_label(i);
+    }
+  }
+
+  for (size_t i = 0; i < labels.size(); ++i) {
+    VLOG(3) << "[Object Detection]  - Found " << clusters[i].size()
+            << " objects of label " << static_cast<int>(labels[i]);
+    object_clusters.emplace(labels[i], std::move(clusters[i]));
   }
   return object_clusters;
 }
@@ -331,6 +432,7 @@ LabelIndices MeshSegmenter::getLabelIndices(const std::vector<size_t>& indices)
 void MeshSegmenter::updateGraph(DynamicSceneGraph& graph,
                                 const LabelClusters& clusters,
                                 uint64_t timestamp) {
+  updated_objects_.clear();
   archiveOldObjects(graph, timestamp);
 
   for (const auto& label_clusters : clusters) {
@@ -396,12 +498,13 @@ void MeshSegmenter::updateObjectInGraph(DynamicSceneGraph& graph,
                                         const SceneGraphNode& node,
                                         uint64_t timestamp) {
   active_object_timestamps_.at(node.id) = timestamp;
+  updated_objects_.insert(node.id);
 
   for (const auto& idx : cluster.indices.indices) {
     graph.insertMeshEdge(node.id, idx, true);
   }
 
-  auto new_box = BoundingBox::extract(cluster.cloud, bounding_box_type_);
+  auto new_box = getBoundingBox(cluster);
   ObjectNodeAttributes& attrs = node.attributes<ObjectNodeAttributes>();
   if (attrs.bounding_box.volume() >= new_box.volume()) {
     return;  // prefer the largest detection
@@ -420,14 +523,14 @@ void MeshSegmenter::addObjectToGraph(DynamicSceneGraph& graph,
                                      const Cluster& cluster,
                                      uint8_t label,
                                      uint64_t timestamp) {
-  CHECK(!cluster.cloud->empty());
+  CHECK(!cluster.indices.indices.empty());
 
   ObjectNodeAttributes::Ptr attrs = std::make_unique<ObjectNodeAttributes>();
   attrs->semantic_label = label;
   attrs->name = NodeSymbol(next_node_id_).getLabel();
-  attrs->bounding_box = BoundingBox::extract(cluster.cloud, bounding_box_type_);
+  attrs->bounding_box = getBoundingBox(cluster);
 
-  const pcl::PointXYZRGBA& point = cluster.cloud->at(0);
+  const auto& point = full_mesh_vertices_->at(cluster.indices.indices.front());
   attrs->color << point.r, point.g, point.b;
 
   pcl::PointXYZ centroid;
@@ -447,6 +550,12 @@ void MeshSegmenter::addObjectToGraph(DynamicSceneGraph& graph,
   ++next_node_id_;
 }
 
+BoundingBox MeshSegmenter::getBoundingBox(const Cluster& cluster) const {
+  MeshVertexCloud::Ptr cloud(new MeshVertexCloud());
+  pcl::copyPointCloud(*full_mesh_vertices_, cluster.indices, *cloud);
+  return BoundingBox::extract(cloud, bounding_box_type_);
+}
+
 void MeshSegmenter::publishActiveVertices(const std::vector<size_t>& indices) const {
   if (!enable_active_mesh_pub_) {
     return;
@@ -0,0 +1,209 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_dsg_builder/voxel_clustering.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+namespace hydra {
+namespace incremental {
+
+namespace {
+
+using CellIndex = Eigen::Vector3i;
+
+struct CellHash {
+  size_t operator()(const CellIndex& index) const {
+    // same primes as voxblox::AnyIndexHash
+    return static_cast<size_t>(index.x()) + 1447 * static_cast<size_t>(index.y()) +
+           345637 * static_cast<size_t>(index.z());
+  }
+};
+
+using CellMap = std::unordered_map<CellIndex, std::vector<size_t>, CellHash>;
+
+// cells are small enough that all their points are connected: cells up to two apart
+// can still contain neighboring points. Every pair of cells is visited once, and cells
+// that are too far apart to contain neighbors are skipped
+std::vector<CellIndex> getForwardOffsets() {
+  std::vector<CellIndex> offsets;
+  for (int x = -2; x <= 2; ++x) {
+    for (int y = -2; y <= 2; ++y) {
+      for (int z = -2; z <= 2; ++z) {
+        const bool forward = x > 0 || (x == 0 && (y > 0 || (y == 0 && z > 0)));
+        if (!forward) {
+          continue;
+        }
+
+        // squared minimum distance between the cells (in cell lengths)
+        const CellIndex gap = (CellIndex(x, y, z).cwiseAbs().array() - 1).max(0);
+        if (gap.squaredNorm() <= 3) {
+          offsets.emplace_back(x, y, z);
+        }
+      }
+    }
+  }
+  return offsets;
+}
+
+class UnionFind {
+ public:
+  explicit UnionFind(size_t size) : parents_(size), sizes_(size, 1) {
+    std::iota(parents_.begin(), parents_.end(), 0);
+  }
+
+  size_t find(size_t node) {
+    while (parents_[node] != node) {
+      parents_[node] = parents_[parents_[node]];  // path halving
+      node = parents_[node];
+    }
+    return node;
+  }
+
+  void join(size_t lhs, size_t rhs) {
+    lhs = find(lhs);
+    rhs = find(rhs);
+    if (lhs == rhs) {
+      return;
+    }
+
+    if (sizes_[lhs] < sizes_[rhs]) {
+      std::swap(lhs, rhs);
+    }
+
+    parents_[rhs] = lhs;
+    sizes_[lhs] += sizes_[rhs];
+  }
+
+ private:
+  std::vector<size_t> parents_;
+  std::vector<size_t> sizes_;
+};
+
+bool hasNeighbor(const std::vector<Eigen::Vector3f>& points,
+                 const std::vector<size_t>& lhs,
+                 const std::vector<size_t>& rhs,
+                 float max_dist_sq) {
+  for (const auto i : lhs) {
+    for (const auto j : rhs) {
+      if ((points[i] - points[j]).squaredNorm() <= max_dist_sq) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+}  // namespace
+
+VoxelClusters findVoxelClusters(const std::vector<Eigen::Vector3f>& points,
+                                double tolerance,
+                                size_t min_size,
+                                size_t max_size) {
+  VoxelClusters clusters;
+  if (points.empty() || tolerance <= 0.0) {
+    return clusters;
+  }
+
+  // the cell diagonal is the tolerance, so all points in a cell are neighbors
+  const float inv_cell_size = static_cast<float>(std::sqrt(3.0) / tolerance);
+  const float max_dist_sq = static_cast<float>(tolerance * tolerance);
+
+  CellMap cells;
+  for (size_t i = 0; i < points.size(); ++i) {
+    const CellIndex index = (points[i] * inv_cell_size).array().floor().cast<int>();
+    cells[index].push_back(i);
+  }
+
+  UnionFind components(points.size());
+  for (const auto& cell_points : cells) {
+    const auto& cell = cell_points.second;
+    for (size_t i = 1; i < cell.size(); ++i) {
+      components.join(cell.front(), cell[i]);
+    }
+  }
+
+  const auto offsets = getForwardOffsets();
+  for (const auto& cell_points : cells) {
+    const auto& lhs = cell_points.second;
+    for (const auto& offset : offsets) {
+      auto iter = cells.find(cell_points.first + offset);
+      if (iter == cells.end()) {
+        continue;
+      }
+
+      // cells are already fully connected, so one neighboring pair joins them
+      const auto& rhs = iter->second;
+      if (components.find(lhs.front()) == components.find(rhs.front())) {
+        continue;
+      }
+
+      if (hasNeighbor(points, lhs, rhs, max_dist_sq)) {
+        components.join(lhs.front(), rhs.front());
+      }
+    }
+  }
+
+  std::unordered_map<size_t, size_t> root_to_cluster;
+  VoxelClusters all_clusters;
+  for (size_t i = 0; i < points.size(); ++i) {
+    const size_t root = components.find(i);
+    auto iter = root_to_cluster.find(root);
+    if (iter == root_to_cluster.end()) {
+      iter = root_to_cluster.emplace(root, all_clusters.size()).first;
+      all_clusters.emplace_back();
+    }
+
+    all_clusters[iter->second].push_back(i);
+  }
+
+  for (auto& cluster : all_clusters) {
+    if (cluster.size() >= min_size && cluster.size() <= max_size) {
+      clusters.push_back(std::move(cluster));
+    }
+  }
+
+  std::stable_sort(
+      clusters.begin(), clusters.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.size() > rhs.size();
+      });
+  return clusters;
+}
+
+}  // namespace incremental
+}  // namespace hydra
@@ -0,0 +1,234 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <hydra_dsg_builder/dsg_change_journal.h>
+#include <hydra_dsg_builder/incremental_dsg_lcd.h>
+
+#include <gtest/gtest.h>
+
+namespace hydra {
+namespace incremental {
+
+namespace {
+
+inline PlaceNodeAttributes::Ptr makePlace(double x, double distance) {
+  PlaceNodeAttributes::Ptr attrs(new PlaceNodeAttributes(distance, 0));
+  attrs->position << x, 0.0, 0.0;
+  return attrs;
+}
+
+inline double getDistance(const DynamicSceneGraph& graph, NodeId node) {
+  return graph.getNode(node)->get().attributes<PlaceNodeAttributes>().distance;
+}
+
+}  // namespace
+
+TEST(DsgChangeJournalTests, FirstPopIsFullSync) {
+  DynamicSceneGraph graph;
+  DsgChangeJournal journal;
+  const auto consumer = journal.addConsumer();
+
+  graph.emplaceNode(DsgLayers::PLACES, 0, makePlace(0.0, 1.0));
+  journal.recordGraphChanges(graph);
+
+  DsgChanges changes = journal.popChanges(consumer);
+  EXPECT_TRUE(changes.full_sync);
+
+  changes = journal.popChanges(consumer);
+  EXPECT_FALSE(changes.full_sync);
+  EXPECT_TRUE(changes.empty());
+}
+
+TEST(DsgChangeJournalTests, LastChangeWins) {
+  DynamicSceneGraph graph;
+  DsgChangeJournal journal;
+  const auto consumer = journal.addConsumer();
+  journal.popChanges(consumer);
+
+  graph.emplaceNode(DsgLayers::PLACES, 0, makePlace(0.0, 1.0));
+  graph.emplaceNode(DsgLayers::PLACES, 1, makePlace(1.0, 1.0));
+  graph.insertEdge(0, 1);
+  journal.recordGraphChanges(graph);
+
+  graph.removeEdge(0, 1);
+  graph.removeNode(1);
+  journal.recordGraphChanges(graph);
+  journal.recordUpdatedNodes(std::vector<NodeId>{0});
+
+  EXPECT_EQ(journal.maxPending(), 3u);
+
+  const DsgChanges changes = journal.popChanges(consumer);
+  EXPECT_EQ(changes.nodes, std::unordered_set<NodeId>({0}));
+  EXPECT_EQ(changes.removed_nodes, std::unordered_set<NodeId>({1}));
+  EXPECT_TRUE(changes.edges.empty());
+  EXPECT_EQ(changes.removed_edges, DsgChanges::EdgeSet({{0, 1}}));
+  EXPECT_EQ(journal.maxPending(), 0u);
+}
+
+TEST(DsgChangeJournalTests, ConsumersAreIndependent) {
+  DynamicSceneGraph graph;
+  DsgChangeJournal journal;
+  const auto first = journal.addConsumer();
+  const auto second = journal.addConsumer();
+  journal.popChanges(first);
+  journal.popChanges(second);
+
+  graph.emplaceNode(DsgLayers::PLACES, 0, makePlace(0.0, 1.0));
+  journal.recordGraphChanges(graph);
+  EXPECT_EQ(journal.popChanges(first).nodes.size(), 1u);
+
+  graph.emplaceNode(DsgLayers::PLACES, 1, makePlace(1.0, 1.0));
+  journal.recordGraphChanges(graph);
+  EXPECT_EQ(journal.popChanges(first).nodes.size(), 1u);
+  EXPECT_EQ(journal.popChanges(second).nodes.size(), 2u);
+}
+
+TEST(DsgChangeJournalTests, MergeChangesMatchesSource) {
+  DynamicSceneGraph source;
+  DynamicSceneGraph target;
+  DsgChangeJournal journal;
+  const auto consumer = journal.addConsumer();
+
+  source.emplaceNode(DsgLayers::PLACES, 0, makePlace(0.0, 1.0));
+  source.emplaceNode(DsgLayers::PLACES, 1, makePlace(1.0, 1.0));
+  source.insertEdge(0, 1);
+  journal.recordGraphChanges(source);
+  ASSERT_TRUE(journal.popChanges(consumer).full_sync);
+  target.mergeGraph(source);
+
+  source.emplaceNode(DsgLayers::PLACES, 2, makePlace(2.0, 3.0));
+  source.insertEdge(1, 2);
+  source.removeNode(0);
+  source.getNode(1)->get().attributes<PlaceNodeAttributes>().distance = 2.0;
+  journal.recordUpdatedNodes(std::vector<NodeId>{1});
+  journal.recordGraphChanges(source);
+
+  mergeChanges(source, journal.popChanges(consumer), target);
+  EXPECT_FALSE(target.hasNode(0));
+  ASSERT_TRUE(target.hasNode(1));
+  ASSERT_TRUE(target.hasNode(2));
+  EXPECT_TRUE(target.hasEdge(1, 2));
+  EXPECT_NEAR(getDistance(target, 1), 2.0, 1.0e-9);
+  EXPECT_NEAR(getDistance(target, 2), 3.0, 1.0e-9);
+}
+
+TEST(DsgChangeJournalTests, MergeChangesSkipsMergedNodes) {
+  DynamicSceneGraph source;
+  DynamicSceneGraph target;
+  source.emplaceNode(DsgLayers::PLACES, 0, makePlace(0.0, 1.0));
+  source.emplaceNode(DsgLayers::PLACES, 1, makePlace(1.0, 1.0));
+  source.emplaceNode(DsgLayers::PLACES, 2, makePlace(2.0, 1.0));
+  target.mergeGraph(source);
+
+  // the target merged 1 into 0
+  target.removeNode(1);
+  const std::map<NodeId, NodeId> merges{{1, 0}};
+
+  DsgChanges changes;
+  source.getNode(1)->get().attributes<PlaceNodeAttributes>().distance = 5.0;
+  source.insertEdge(1, 2);
+  changes.nodes.insert(1);
+  changes.edges.insert({1, 2});
+
+  DsgMergeOptions options;
+  options.previous_merges = &merges;
+  mergeChanges(source, changes, target, options);
+  EXPECT_FALSE(target.hasNode(1));
+  EXPECT_TRUE(target.hasEdge(0, 2));
+}
+
+TEST(DsgChangeJournalTests, MergeChangesIntoLayer) {
+  DynamicSceneGraph source;
+  IsolatedSceneGraphLayer target(DsgLayers::PLACES);
+  source.emplaceNode(DsgLayers::PLACES, 0, makePlace(0.0, 1.0));
+  source.emplaceNode(DsgLayers::PLACES, 1, makePlace(1.0, 1.0));
+  source.insertEdge(0, 1);
+
+  ObjectNodeAttributes::Ptr object(new ObjectNodeAttributes);
+  source.emplaceNode(DsgLayers::OBJECTS, NodeSymbol('O', 0), std::move(object));
+
+  DsgChanges changes;
+  changes.nodes = {0, 1, NodeSymbol('O', 0)};
+  changes.edges.insert({0, 1});
+  mergeChanges(source, changes, target);
+
+  EXPECT_EQ(target.numNodes(), 2u);
+  EXPECT_TRUE(target.hasEdge(0, 1));
+}
+
+TEST(DsgChangeJournalTests, BowVectorsReachMergedGraph) {
+  using namespace std::chrono_literals;
+
+  SharedDsgInfo dsg({{DsgLayers::OBJECTS, 'o'}, {DsgLayers::PLACES, 'p'}}, 1);
+  const auto consumer = dsg.changes.addConsumer();
+  DynamicSceneGraph target;
+
+  // the agent node is merged before its bow vector shows up
+  const char prefix = kimera_pgmo::robot_id_to_prefix.at(0);
+  dsg.graph->createDynamicLayer(DsgLayers::AGENTS, prefix);
+  dsg.graph->emplaceNode(DsgLayers::AGENTS,
+                         prefix,
+                         10ns,
+                         std::make_unique<AgentNodeAttributes>(
+                             Eigen::Quaterniond::Identity(),
+                             Eigen::Vector3d::Zero(),
+                             NodeSymbol(prefix, 0)));
+  dsg.agent_key_map[NodeSymbol(prefix, 0)] = 0;
+  dsg.changes.recordGraphChanges(*dsg.graph);
+  ASSERT_TRUE(dsg.changes.popChanges(consumer).full_sync);
+  target.mergeGraph(*dsg.graph);
+
+  pose_graph_tools::BowQuery::Ptr msg(new pose_graph_tools::BowQuery());
+  msg->robot_id = 0;
+  msg->pose_id = 0;
+  msg->bow_vector.word_ids = {1, 5};
+  msg->bow_vector.word_values = {0.5f, 0.25f};
+  std::list<pose_graph_tools::BowQuery::ConstPtr> messages{msg};
+
+  const auto assigned = assignBowVectors(dsg, prefix, messages);
+  EXPECT_TRUE(messages.empty());
+  ASSERT_EQ(assigned.size(), 1u);
+  EXPECT_EQ(assigned.front(), NodeSymbol(prefix, 0));
+
+  mergeChanges(*dsg.graph, dsg.changes.popChanges(consumer), target);
+  const auto& attrs = target.getDynamicNode(NodeSymbol(prefix, 0))
+                          ->get()
+                          .attributes<AgentNodeAttributes>();
+  ASSERT_EQ(attrs.dbow_ids.size(), 2);
+  EXPECT_EQ(attrs.dbow_ids(1), 5u);
+  EXPECT_NEAR(attrs.dbow_values(0), 0.5f, 1.0e-6f);
+}
+
+}  // namespace incremental
+}  // namespace hydra
@@ -360,5 +360,34 @@ TEST_F(LayerRegistrationTests, TestRepeatedRegistration) {
   ASSERT_TRUE(solution.valid);
 }
 
+TEST_F(LayerRegistrationTests, TestSharedMutexRegistration) {
+  teaser::RobustRegistrationSolver::Params params;
+  params.estimate_scaling = false;
+  teaser::RobustRegistrationSolver solver(params);
+
+  // source and destination usually live in the same graph
+  std::shared_mutex mutex;
+  LayerRegistrationProblem problem;
+  problem.src_nodes = node_ids;
+  problem.dest_nodes = node_ids;
+  problem.dest_layer = dest_layer.get();
+  problem.src_mutex = &mutex;
+  problem.dest_mutex = &mutex;
+
+  auto solution =
+      registerDsgLayer(reg_config,
+                       solver,
+                       problem,
+                       *src_layer,
+                       [](const SceneGraphNode& src, const SceneGraphNode& dest) {
+                         return src.id == dest.id;
+                       });
+  ASSERT_TRUE(solution.valid);
+
+  // registration has to leave the mutex unlocked
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
 }  // namespace lcd
 }  // namespace hydra
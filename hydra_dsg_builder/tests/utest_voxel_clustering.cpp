@@ -0,0 +1,142 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <hydra_dsg_builder/voxel_clustering.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+namespace hydra {
+namespace incremental {
+
+namespace {
+
+// brute-force euclidean clustering to compare against
+VoxelClusters findNaiveClusters(const std::vector<Eigen::Vector3f>& points,
+                                double tolerance,
+                                size_t min_size,
+                                size_t max_size) {
+  VoxelClusters clusters;
+  std::vector<bool> seen(points.size(), false);
+  for (size_t seed = 0; seed < points.size(); ++seed) {
+    if (seen[seed]) {
+      continue;
+    }
+
+    std::vector<size_t> cluster{seed};
+    seen[seed] = true;
+    for (size_t i = 0; i < cluster.size(); ++i) {
+      for (size_t j = 0; j < points.size(); ++j) {
+        if (!seen[j] && (points[cluster[i]] - points[j]).norm() <= tolerance) {
+          seen[j] = true;
+          cluster.push_back(j);
+        }
+      }
+    }
+
+    if (cluster.size() >= min_size && cluster.size() <= max_size) {
+      clusters.push_back(cluster);
+    }
+  }
+
+  return clusters;
+}
+
+std::set<std::set<size_t>> toPartition(const VoxelClusters& clusters) {
+  std::set<std::set<size_t>> partition;
+  for (const auto& cluster : clusters) {
+    partition.insert(std::set<size_t>(cluster.begin(), cluster.end()));
+  }
+  return partition;
+}
+
+}  // namespace
+
+TEST(VoxelClusteringTests, EmptyInput) {
+  EXPECT_TRUE(findVoxelClusters({}, 0.25, 1, 100).empty());
+}
+
+TEST(VoxelClusteringTests, NeighborsAcrossCells) {
+  // points straddle cell boundaries (and the origin) but are within tolerance
+  std::vector<Eigen::Vector3f> points{{-0.05f, 0.0f, 0.0f},
+                                      {0.05f, 0.0f, 0.0f},
+                                      {0.2f, 0.1f, -0.1f},
+                                      {1.0f, 1.0f, 1.0f},
+                                      {1.1f, 1.0f, 1.0f}};
+
+  const auto clusters = findVoxelClusters(points, 0.25, 1, 100);
+  ASSERT_EQ(clusters.size(), 2u);
+  EXPECT_EQ(clusters[0].size(), 3u);
+  EXPECT_EQ(clusters[1].size(), 2u);
+}
+
+TEST(VoxelClusteringTests, SizeLimits) {
+  std::vector<Eigen::Vector3f> points;
+  for (size_t i = 0; i < 10; ++i) {
+    points.emplace_back(0.1f * i, 0.0f, 0.0f);
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    points.emplace_back(0.1f * i, 5.0f, 0.0f);
+  }
+  points.emplace_back(-5.0f, 0.0f, 0.0f);
+
+  EXPECT_EQ(findVoxelClusters(points, 0.15, 1, 100).size(), 3u);
+  EXPECT_EQ(findVoxelClusters(points, 0.15, 2, 100).size(), 2u);
+  EXPECT_EQ(findVoxelClusters(points, 0.15, 2, 5).size(), 1u);
+}
+
+TEST(VoxelClusteringTests, MatchesNaiveClustering) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+  for (const double tolerance : {0.1, 0.25, 0.4}) {
+    std::vector<Eigen::Vector3f> points;
+    for (size_t i = 0; i < 1000; ++i) {
+      points.emplace_back(dist(gen), dist(gen), 0.2f * dist(gen));
+    }
+
+    const auto expected = findNaiveClusters(points, tolerance, 3, 500);
+    const auto result = findVoxelClusters(points, tolerance, 3, 500);
+    EXPECT_EQ(toPartition(expected), toPartition(result)) << "tolerance: " << tolerance;
+    EXPECT_TRUE(std::is_sorted(
+        result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+          return lhs.size() > rhs.size();
+        }));
+  }
+}
+
+}  // namespace incremental
+}  // namespace hydra
@@ -74,6 +74,19 @@ struct TopologyServerConfig {
   bool clear_distant_blocks = true;
   double dense_representation_radius_m = 5.0;
   bool publish_archived = true;
+  //! roscpp serializes every message on a latched topic, even for in-process
+  //! subscribers, so disable latching to hand the active mesh off by pointer
+  bool latch_active_mesh = true;
+  bool concurrent_update = false;
+  //! publish and visualize an update on a separate thread while the next one runs
+  bool pipeline_outputs = false;
+  //! maximum number of updates whose outputs are queued or being published
+  size_t max_pending_outputs = 2;
+  size_t coarse_downsample_factor = 0;
+  size_t coarse_update_every_n = 5;
+  double coarse_representation_radius_m = 20.0;
+  bool publish_layer_deltas = true;
+  size_t full_layer_update_every_n = 0;
 
   voxblox::ColorMode mesh_color_mode = voxblox::ColorMode::kLambertColor;
   std::string world_frame = "world";
@@ -126,6 +139,9 @@ void visit_config(const Visitor& v, GvdIntegratorConfig& config) {
   v.visit("graph_extractor", config.graph_extractor_config);
   v.visit("extract_graph", config.extract_graph);
   v.visit("mesh_only", config.mesh_only);
+  v.visit("num_threads", config.num_threads);
+  v.visit("archive_path", config.archive_path);
+  v.visit("archive_max_resident_blocks", config.archive_max_resident_blocks);
 }
 
 template <typename Visitor>
@@ -134,6 +150,15 @@ void visit_config(const Visitor& v, TopologyServerConfig& config) {
   v.visit("show_stats", config.show_stats);
   v.visit("dense_representation_radius_m", config.dense_representation_radius_m);
   v.visit("publish_archived", config.publish_archived);
+  v.visit("latch_active_mesh", config.latch_active_mesh);
+  v.visit("concurrent_update", config.concurrent_update);
+  v.visit("pipeline_outputs", config.pipeline_outputs);
+  v.visit("max_pending_outputs", config.max_pending_outputs);
+  v.visit("coarse_downsample_factor", config.coarse_downsample_factor);
+  v.visit("coarse_update_every_n", config.coarse_update_every_n);
+  v.visit("coarse_representation_radius_m", config.coarse_representation_radius_m);
+  v.visit("publish_layer_deltas", config.publish_layer_deltas);
+  v.visit("full_layer_update_every_n", config.full_layer_update_every_n);
   v.visit("mesh_color_mode", config.mesh_color_mode);
   v.visit("world_frame", config.world_frame);
 }
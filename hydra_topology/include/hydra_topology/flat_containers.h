@@ -0,0 +1,383 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace hydra {
+namespace topology {
+
+namespace detail {
+
+template <typename Value>
+struct IdentityKey {
+  const Value& operator()(const Value& value) const { return value; }
+};
+
+template <typename Pair>
+struct PairKey {
+  const typename Pair::first_type& operator()(const Pair& value) const {
+    return value.first;
+  }
+};
+
+/**
+ * @brief Open-addressing hash table with linear probing and backward-shift deletion
+ *
+ * Entries live in one contiguous array, so lookups touch a single cache line in the
+ * common case. Insertions and erasures invalidate all iterators and references.
+ */
+template <typename Value, typename Key, typename KeyOf, typename Hash, typename Equal>
+class FlatHashTable {
+ public:
+  using key_type = Key;
+  using value_type = Value;
+  using size_type = size_t;
+
+  template <bool IsConst>
+  class Iterator {
+   public:
+    using Table = std::conditional_t<IsConst, const FlatHashTable, FlatHashTable>;
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const Value*, Value*>;
+    using reference = std::conditional_t<IsConst, const Value&, Value&>;
+
+    Iterator() : table_(nullptr), slot_(0) {}
+
+    Iterator(Table* table, size_t slot) : table_(table), slot_(slot) {}
+
+    // allows iterator -> const_iterator
+    Iterator(const Iterator<false>& other) : table_(other.table_), slot_(other.slot_) {}
+
+    reference operator*() const { return *table_->slots_[slot_]; }
+
+    pointer operator->() const { return &(*table_->slots_[slot_]); }
+
+    Iterator& operator++() {
+      slot_ = table_->nextOccupied(slot_ + 1);
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator prev = *this;
+      ++(*this);
+      return prev;
+    }
+
+    bool operator==(const Iterator& other) const { return slot_ == other.slot_; }
+
+    bool operator!=(const Iterator& other) const { return slot_ != other.slot_; }
+
+   private:
+    friend class FlatHashTable;
+    friend class Iterator<true>;
+
+    Table* table_;
+    size_t slot_;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  FlatHashTable() : size_(0), shift_(64) {}
+
+  iterator begin() { return iterator(this, nextOccupied(0)); }
+
+  iterator end() { return iterator(this, slots_.size()); }
+
+  const_iterator begin() const { return const_iterator(this, nextOccupied(0)); }
+
+  const_iterator end() const { return const_iterator(this, slots_.size()); }
+
+  size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  void clear() {
+    slots_.clear();
+    size_ = 0;
+    shift_ = 64;
+  }
+
+  void reserve(size_t num_entries) {
+    size_t capacity = slots_.empty() ? 8 : slots_.size();
+    while (4 * num_entries > 3 * capacity) {
+      capacity *= 2;
+    }
+
+    if (capacity != slots_.size()) {
+      rehash(capacity);
+    }
+  }
+
+  iterator find(const Key& key) { return iterator(this, findSlot(key)); }
+
+  const_iterator find(const Key& key) const {
+    return const_iterator(this, findSlot(key));
+  }
+
+  size_t count(const Key& key) const { return findSlot(key) != slots_.size(); }
+
+  size_t erase(const Key& key) {
+    const size_t slot = findSlot(key);
+    if (slot == slots_.size()) {
+      return 0;
+    }
+
+    eraseSlot(slot);
+    return 1;
+  }
+
+  void erase(const_iterator iter) { eraseSlot(iter.slot_); }
+
+ protected:
+  template <typename... Args>
+  std::pair<iterator, bool> emplaceImpl(const Key& key, Args&&... args) {
+    size_t slot = findSlot(key);
+    if (slot != slots_.size()) {
+      return {iterator(this, slot), false};
+    }
+
+    reserve(size_ + 1);
+    slot = homeSlot(key);
+    while (slots_[slot]) {
+      slot = (slot + 1) & mask();
+    }
+
+    slots_[slot].emplace(std::forward<Args>(args)...);
+    ++size_;
+    return {iterator(this, slot), true};
+  }
+
+ private:
+  size_t mask() const { return slots_.size() - 1; }
+
+  size_t homeSlot(const Key& key) const {
+    // fibonacci hashing: spreads hashes that only differ in a few bits
+    const uint64_t hash = static_cast<uint64_t>(Hash()(key)) * 11400714819323198485ull;
+    return shift_ >= 64 ? 0 : static_cast<size_t>(hash >> shift_);
+  }
+
+  size_t nextOccupied(size_t slot) const {
+    while (slot < slots_.size() && !slots_[slot]) {
+      ++slot;
+    }
+    return slot;
+  }
+
+  size_t findSlot(const Key& key) const {
+    if (slots_.empty()) {
+      return 0;
+    }
+
+    // load factor is bounded, so there's always an empty slot to stop at
+    for (size_t slot = homeSlot(key); slots_[slot]; slot = (slot + 1) & mask()) {
+      if (Equal()(KeyOf()(*slots_[slot]), key)) {
+        return slot;
+      }
+    }
+
+    return slots_.size();
+  }
+
+  void eraseSlot(size_t slot) {
+    slots_[slot].reset();
+    --size_;
+
+    // shift later entries of the probe sequence back so lookups never hit a gap
+    size_t hole = slot;
+    for (size_t curr = (slot + 1) & mask(); slots_[curr]; curr = (curr + 1) & mask()) {
+      const size_t home = homeSlot(KeyOf()(*slots_[curr]));
+      if (((curr - home) & mask()) < ((curr - hole) & mask())) {
+        continue;  // entry would become unreachable if moved before its home slot
+      }
+
+      slots_[hole].emplace(std::move(*slots_[curr]));
+      slots_[curr].reset();
+      hole = curr;
+    }
+  }
+
+  void rehash(size_t capacity) {
+    std::vector<std::optional<Value>> old_slots(capacity);
+    old_slots.swap(slots_);
+
+    shift_ = 64;
+    for (size_t c = capacity; c > 1; c >>= 1) {
+      --shift_;
+    }
+
+    for (auto& entry : old_slots) {
+      if (!entry) {
+        continue;
+      }
+
+      size_t slot = homeSlot(KeyOf()(*entry));
+      while (slots_[slot]) {
+        slot = (slot + 1) & mask();
+      }
+      slots_[slot].emplace(std::move(*entry));
+    }
+  }
+
+  std::vector<std::optional<Value>> slots_;
+  size_t size_;
+  //! 64 - log2(capacity)
+  size_t shift_;
+};
+
+}  // namespace detail
+
+template <typename Key,
+          typename Value,
+          typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>>
+class FlatHashMap
+    : public detail::FlatHashTable<std::pair<const Key, Value>,
+                                   Key,
+                                   detail::PairKey<std::pair<const Key, Value>>,
+                                   Hash,
+                                   Equal> {
+ public:
+  using mapped_type = Value;
+
+  template <typename... Args>
+  auto emplace(const Key& key, Args&&... args) {
+    return this->emplaceImpl(key,
+                             std::piecewise_construct,
+                             std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  auto insert(const std::pair<const Key, Value>& value) {
+    return this->emplaceImpl(value.first, value);
+  }
+
+  Value& operator[](const Key& key) { return emplace(key).first->second; }
+
+  Value& at(const Key& key) {
+    auto iter = this->find(key);
+    if (iter == this->end()) {
+      throw std::out_of_range("missing key in FlatHashMap");
+    }
+    return iter->second;
+  }
+
+  const Value& at(const Key& key) const {
+    auto iter = this->find(key);
+    if (iter == this->end()) {
+      throw std::out_of_range("missing key in FlatHashMap");
+    }
+    return iter->second;
+  }
+};
+
+template <typename Key,
+          typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>>
+class FlatHashSet
+    : public detail::FlatHashTable<Key, Key, detail::IdentityKey<Key>, Hash, Equal> {
+ public:
+  auto insert(const Key& key) { return this->emplaceImpl(key, key); }
+
+  template <typename Iter>
+  void insert(Iter first, Iter last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+};
+
+/**
+ * @brief Ordered set backed by a sorted vector
+ *
+ * Intended for the handful of ids attached to each node or edge: iteration order
+ * matches std::set, but the entries share one allocation.
+ */
+template <typename T>
+class SortedVectorSet {
+ public:
+  using value_type = T;
+  using const_iterator = typename std::vector<T>::const_iterator;
+  using iterator = const_iterator;
+
+  const_iterator begin() const { return values_.begin(); }
+
+  const_iterator end() const { return values_.end(); }
+
+  size_t size() const { return values_.size(); }
+
+  bool empty() const { return values_.empty(); }
+
+  void clear() { values_.clear(); }
+
+  std::pair<const_iterator, bool> insert(const T& value) {
+    auto iter = std::lower_bound(values_.begin(), values_.end(), value);
+    if (iter != values_.end() && *iter == value) {
+      return {iter, false};
+    }
+
+    return {values_.insert(iter, value), true};
+  }
+
+  size_t erase(const T& value) {
+    auto iter = std::lower_bound(values_.begin(), values_.end(), value);
+    if (iter == values_.end() || *iter != value) {
+      return 0;
+    }
+
+    values_.erase(iter);
+    return 1;
+  }
+
+  size_t count(const T& value) const {
+    return std::binary_search(values_.begin(), values_.end(), value);
+  }
+
+ private:
+  std::vector<T> values_;
+};
+
+}  // namespace topology
+}  // namespace hydra
@@ -34,12 +34,16 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include "hydra_topology/gvd_voxel.h"
+#include "hydra_topology/thread_pool.h"
 #include "hydra_topology/voxblox_types.h"
 
 #include <hydra_utils/dsg_types.h>
 
+#include <array>
 #include <bitset>
 #include <iostream>
+#include <limits>
+#include <vector>
 
 namespace hydra {
 namespace topology {
@@ -50,6 +54,43 @@ std::bitset<27> extractNeighborhoodFlags(const Layer<GvdVoxel>& layer,
                                          const GlobalIndex& index,
                                          uint8_t min_extra_basis = 1);
 
+/**
+ * @brief Neighborhood flags for every voxel of a single block
+ *
+ * Caches the validity of a block and a one-voxel border from its neighbors in a
+ * padded (voxels_per_side + 2)^3 slab so that the flags for any voxel in the block
+ * are 27 byte reads at fixed offsets instead of 27 hashed voxel lookups. Flags use
+ * the same ordering as extractNeighborhoodFlags.
+ */
+class BlockNeighborhoodFlags {
+ public:
+  explicit BlockNeighborhoodFlags(int voxels_per_side);
+
+  //! populate the slab for the block at block_index (one lookup per neighbor block)
+  void fill(const Layer<GvdVoxel>& layer,
+            const BlockIndex& block_index,
+            uint8_t min_extra_basis = 1);
+
+  inline std::bitset<27> getFlags(const VoxelIndex& voxel_index) const {
+    const size_t center = static_cast<size_t>(voxel_index.x() + 1) +
+                          padded_side_ * static_cast<size_t>(voxel_index.y() + 1) +
+                          padded_area_ * static_cast<size_t>(voxel_index.z() + 1);
+    uint32_t flags = 0;
+    for (size_t n = 0; n < linear_offsets_.size(); ++n) {
+      flags |= static_cast<uint32_t>(valid_[center + linear_offsets_[n]]) << n;
+    }
+    return std::bitset<27>(flags);
+  }
+
+ private:
+  const int voxels_per_side_;
+  const size_t padded_side_;
+  const size_t padded_area_;
+  //! signed offsets into the slab for each neighbor (plus the center at bit 26)
+  std::array<int64_t, 27> linear_offsets_;
+  std::vector<uint8_t> valid_;
+};
+
 struct GvdCornerTemplate {
   using MaskArray = std::array<std::bitset<27>, 4>;
 
@@ -83,13 +124,16 @@ struct CornerFinder {
 
   ~CornerFinder() = default;
 
+  // each template and rotation pair reduces to a masked compare against the
+  // foreground flags, so matching is a fixed-length branch-free loop over 24 masks
+  // (equivalent to matchesCorner for every template)
   inline bool match(std::bitset<27> values) const {
-    return matchesCorner(negative_x_template, values) ||
-           matchesCorner(positive_x_template, values) ||
-           matchesCorner(negative_y_template, values) ||
-           matchesCorner(positive_y_template, values) ||
-           matchesCorner(negative_z_template, values) ||
-           matchesCorner(positive_z_template, values);
+    const uint32_t state = static_cast<uint32_t>(values.to_ulong());
+    bool matched = false;
+    for (size_t i = 0; i < care_masks_.size(); ++i) {
+      matched |= (state & care_masks_[i]) == fg_masks_[i];
+    }
+    return matched;
   }
 
   GvdCornerTemplate negative_x_template;
@@ -98,11 +142,150 @@ struct CornerFinder {
   GvdCornerTemplate positive_y_template;
   GvdCornerTemplate negative_z_template;
   GvdCornerTemplate positive_z_template;
+
+ private:
+  //! set from the templates on construction (templates are not expected to change)
+  std::array<uint32_t, 24> care_masks_;
+  std::array<uint32_t, 24> fg_masks_;
 };
 
+/**
+ * @brief Visit the interior voxels of a bresenham line without allocating
+ *
+ * Visits the same voxels in the same order as makeBresenhamLine (i.e., excluding
+ * start and end). The visitor is called as visitor(const GlobalIndex&) and returns
+ * false to stop the traversal early.
+ *
+ * @returns false if the visitor stopped the traversal
+ */
+template <typename Visitor>
+bool walkBresenhamLine(const GlobalIndex& start,
+                       const GlobalIndex& end,
+                       Visitor&& visitor) {
+  GlobalIndex diff = end - start;
+  const GlobalIndex inc(
+      diff(0) < 0 ? -1 : 1, diff(1) < 0 ? -1 : 1, diff(2) < 0 ? -1 : 1);
+
+  diff = diff.array().abs();
+  const GlobalIndex diff_twice = 2 * diff;
+
+  int max_idx;
+  int min_idx_1;
+  int min_idx_2;
+  if (diff(0) >= diff(1) && diff(0) >= diff(2)) {
+    max_idx = 0;
+    min_idx_1 = 1;
+    min_idx_2 = 2;
+  } else if (diff(1) >= diff(0) && diff(1) >= diff(2)) {
+    max_idx = 1;
+    min_idx_1 = 0;
+    min_idx_2 = 2;
+  } else {
+    max_idx = 2;
+    min_idx_1 = 0;
+    min_idx_2 = 1;
+  }
+
+  if (diff(max_idx) <= 1) {
+    return true;
+  }
+
+  GlobalIndex point = start;
+  int64_t err_1 = diff_twice(min_idx_1) - diff(max_idx);
+  int64_t err_2 = diff_twice(min_idx_2) - diff(max_idx);
+  for (int64_t i = 0; i < diff(max_idx); ++i) {
+    if (i > 0 && !visitor(static_cast<const GlobalIndex&>(point))) {
+      return false;
+    }
+
+    if (err_1 > 0) {
+      point(min_idx_1) += inc(min_idx_1);
+      err_1 -= diff_twice(max_idx);
+    }
+    if (err_2 > 0) {
+      point(min_idx_2) += inc(min_idx_2);
+      err_2 -= diff_twice(max_idx);
+    }
+    err_1 += diff_twice(min_idx_1);
+    err_2 += diff_twice(min_idx_2);
+    point[max_idx] += inc(max_idx);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Visit the voxels of a layer along a bresenham line
+ *
+ * Consecutive line voxels almost always share a block, so the current block is
+ * cached and only looked up again when the line crosses into a new block. The
+ * visitor is called as visitor(const GlobalIndex&, const Voxel*) where the voxel is
+ * nullptr if its block isn't allocated, and returns false to stop early.
+ *
+ * @returns false if the visitor stopped the traversal
+ */
+template <typename Voxel, typename Visitor>
+bool walkLayerLine(const Layer<Voxel>& layer,
+                   const GlobalIndex& start,
+                   const GlobalIndex& end,
+                   Visitor&& visitor) {
+  const GlobalIndex::Scalar vps = layer.voxels_per_side();
+  GlobalIndex curr_block_index;
+  const voxblox::Block<Voxel>* block = nullptr;
+  bool have_block = false;
+
+  return walkBresenhamLine(start, end, [&](const GlobalIndex& index) {
+    // floor division (global indices can be negative)
+    const auto coords = index.array();
+    const GlobalIndex block_index =
+        (coords >= 0).select(coords / vps, (coords - vps + 1) / vps).matrix();
+    if (!have_block || block_index != curr_block_index) {
+      block = layer.getBlockPtrByIndex(block_index.cast<voxblox::IndexElement>()).get();
+      curr_block_index = block_index;
+      have_block = true;
+    }
+
+    if (!block) {
+      return visitor(index, static_cast<const Voxel*>(nullptr));
+    }
+
+    const VoxelIndex voxel_index =
+        (index - vps * block_index).cast<voxblox::IndexElement>();
+    return visitor(index, &block->getVoxelByVoxelIndex(voxel_index));
+  });
+}
+
 voxblox::AlignedVector<GlobalIndex> makeBresenhamLine(const GlobalIndex& start,
                                                       const GlobalIndex& end);
 
+struct LineClearance {
+  //! false if any voxel was unallocated, unobserved or within the minimum clearance
+  bool clear = true;
+  //! smallest voxel distance checked (infinite for lines without interior voxels)
+  double min_distance = std::numeric_limits<double>::infinity();
+  //! number of voxels checked before stopping
+  size_t num_voxels = 0;
+};
+
+using LineSegment = std::pair<GlobalIndex, GlobalIndex>;
+
+LineClearance checkLineClearance(const Layer<GvdVoxel>& layer,
+                                 const GlobalIndex& start,
+                                 const GlobalIndex& end,
+                                 double min_clearance);
+
+/**
+ * @brief Check the clearance of many line segments against the GVD
+ *
+ * Each segment stops at the first voxel that fails the clearance check. Segments
+ * are checked in parallel if a thread pool is provided.
+ */
+void checkLineClearances(const Layer<GvdVoxel>& layer,
+                         const voxblox::AlignedVector<LineSegment>& segments,
+                         double min_clearance,
+                         std::vector<LineClearance>& results,
+                         ThreadPool* thread_pool = nullptr);
+
 double getNeighborhoodOverlap(const SceneGraphLayer& graph,
                               std::unordered_set<NodeId> neighborhood,
                               NodeId other_node,
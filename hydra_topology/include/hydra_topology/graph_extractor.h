@@ -35,7 +35,10 @@
 #pragma once
 #include "hydra_topology/graph_extraction_utilities.h"
 #include "hydra_topology/graph_extractor_types.h"
+#include "hydra_topology/gvd_basis_store.h"
 #include "hydra_topology/gvd_voxel.h"
+#include "hydra_topology/nearest_neighbor_utilities.h"
+#include "hydra_topology/thread_pool.h"
 #include "hydra_topology/voxblox_types.h"
 
 #include <queue>
@@ -54,6 +57,8 @@ namespace topology {
  * the GVD that still encode meaningful information about the curvature of the GVD.
  */
 struct GraphExtractorConfig {
+  //! Symbol prefix used for the ids of extracted places
+  char node_prefix = 'p';
   //! Number of basis points for a voxel to be consider for extraction
   uint8_t min_extra_basis = 2;
   //! Number of basis points for a voxel to be automatically labeled a vertex
@@ -102,18 +107,20 @@ class GraphExtractor {
   using Ptr = std::unique_ptr<GraphExtractor>;
   using GvdLayer = Layer<GvdVoxel>;
 
-  // TODO(nathan) may need aligned allocator
-  using NodeIdRootMap = std::unordered_map<NodeId, GlobalIndex>;
-  using NodeIdIndexMap = std::unordered_map<NodeId, voxblox::LongIndexSet>;
-  using IndexGraphInfoMap = voxblox::LongIndexHashMapType<VoxelGraphInfo>::type;
-  using EdgeInfoMap = std::unordered_map<size_t, EdgeInfo>;
-  using EdgeSplitQueue =
-      std::priority_queue<EdgeSplitSeed, voxblox::AlignedVector<EdgeSplitSeed>>;
+  using NodeIdRootMap = FlatHashMap<NodeId, GlobalIndex>;
+  using NodeIdIndexMap = FlatHashMap<NodeId, GlobalIndexSet>;
+  using IndexGraphInfoMap =
+      FlatHashMap<GlobalIndex, VoxelGraphInfo, voxblox::LongIndexHash>;
+  using EdgeInfoMap = FlatHashMap<size_t, EdgeInfo>;
+  using NodeEdgeMap = FlatHashMap<NodeId, EdgeIdSet>;
+  using SplitSeeds = voxblox::AlignedVector<EdgeSplitSeed>;
+  using EdgeSplitQueue = std::priority_queue<EdgeSplitSeed, SplitSeeds>;
   using PseudoEdgeInfoMap = std::map<size_t, PseudoEdgeInfo>;
-  using PseudoEdgeMap = voxblox::LongIndexHashMapType<std::unordered_set<size_t>>::type;
+  using PseudoEdgeMap = FlatHashMap<GlobalIndex, EdgeIdSet, voxblox::LongIndexHash>;
   using Components = std::vector<std::vector<NodeId>>;
 
-  explicit GraphExtractor(const GraphExtractorConfig& config);
+  explicit GraphExtractor(const GraphExtractorConfig& config,
+                          const std::shared_ptr<ThreadPool>& thread_pool = nullptr);
 
   inline void pushGvdIndex(const GlobalIndex& index) {
     modified_voxel_queue_.push(index);
@@ -125,9 +132,7 @@ class GraphExtractor {
 
   void extract(const GvdLayer& layer);
 
-  void assignMeshVertices(const GvdLayer& gvd,
-                          const GvdParentMap& parents,
-                          const GvdVertexMap& parent_vertices);
+  void assignMeshVertices(const GvdLayer& gvd, const GvdBasisStore& basis_store);
 
   std::unordered_set<NodeId> getActiveNodes() const;
 
@@ -135,6 +140,19 @@ class GraphExtractor {
 
   void clearDeletedNodes();
 
+  //! nodes that were added or whose attributes or edges changed since the last clear
+  inline const std::unordered_set<NodeId>& getDirtyNodes() const {
+    return dirty_nodes_;
+  }
+
+  //! nodes that left the active window (but are still in the graph) since the last
+  //! clear
+  inline const std::unordered_set<NodeId>& getArchivedNodes() const {
+    return archived_nodes_;
+  }
+
+  void clearDirtyNodes();
+
   inline const SceneGraphLayer& getGraph() const { return *graph_; }
 
   inline const EdgeInfoMap& getGvdEdgeInfo() const { return edge_info_map_; }
@@ -170,7 +188,13 @@ class GraphExtractor {
                       const VoxelGraphInfo& curr_info,
                       const VoxelGraphInfo& neighbor_info);
 
-  void findBadEdgeIndices(const EdgeInfo& info);
+  void findBadEdgeIndices(const EdgeInfo& info, SplitSeeds& seeds) const;
+
+  void findSplitCandidates();
+
+  void classifyVertices(const GvdLayer& layer,
+                        const voxblox::AlignedVector<GlobalIndex>& indices,
+                        std::vector<bool>& is_vertex);
 
   void findNewVertices(const GvdLayer& layer);
 
@@ -188,15 +212,24 @@ class GraphExtractor {
 
   Components filterComponents(const Components& to_filter) const;
 
-  bool addPseudoEdge(const GvdLayer& layer, NodeId source, NodeId target);
+  bool addPseudoEdge(NodeId source, NodeId target, const LineClearance& clearance);
 
   void findComponentConnections(const GvdLayer& layer);
 
   void filterIsolatedNodes();
 
+  inline void markEdgeDirty(NodeId source, NodeId target) {
+    // edges are published with their endpoints, so an edge change dirties both
+    dirty_nodes_.insert(source);
+    dirty_nodes_.insert(target);
+  }
+
  protected:
   GraphExtractorConfig config_;
 
+  //! used to search edges for split candidates in parallel (optional)
+  std::shared_ptr<ThreadPool> thread_pool_;
+
   CornerFinder corner_finder_;
 
   AlignedQueue<GlobalIndex> modified_voxel_queue_;
@@ -209,16 +242,18 @@ class GraphExtractor {
 
   size_t next_edge_id_;
   EdgeInfoMap edge_info_map_;
-  std::map<NodeId, std::set<size_t>> node_edge_id_map_;
-  std::map<NodeId, std::set<size_t>> node_edge_connections_;
+  NodeEdgeMap node_edge_id_map_;
+  NodeEdgeMap node_edge_connections_;
 
   EdgeSplitQueue edge_split_queue_;
 
   // TODO(nathan) rename these
-  std::map<size_t, std::set<size_t>> checked_edges_;
-  std::set<size_t> connected_edges_;
+  EdgeIdSet connected_edges_;
   std::unordered_set<NodeId> visited_nodes_;
   std::unordered_set<NodeId> deleted_nodes_;
+  std::unordered_set<NodeId> dirty_nodes_;
+  std::unordered_set<NodeId> archived_nodes_;
+  IncrementalNodeFinder freespace_node_finder_;
 
   size_t next_pseudo_edge_id_;
   PseudoEdgeInfoMap pseudo_edge_info_;
@@ -242,7 +277,6 @@ class GraphExtractor {
   }
 
   inline void clearNewConnections(bool clear_modified_voxels) {
-    checked_edges_.clear();
     connected_edges_.clear();
     if (clear_modified_voxels) {
       modified_voxel_queue_ = AlignedQueue<GlobalIndex>();
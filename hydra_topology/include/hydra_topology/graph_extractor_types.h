@@ -33,6 +33,7 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include "hydra_topology/flat_containers.h"
 #include "hydra_topology/voxblox_types.h"
 
 #include <hydra_utils/dsg_types.h>
@@ -40,6 +41,10 @@
 namespace hydra {
 namespace topology {
 
+using GlobalIndexSet = FlatHashSet<GlobalIndex, voxblox::LongIndexHash>;
+using NodeIdSet = SortedVectorSet<NodeId>;
+using EdgeIdSet = SortedVectorSet<size_t>;
+
 struct VoxelGraphInfo {
   // TODO(nathan) consider copy constructor-eqsue cleanup of extract edges
   VoxelGraphInfo();
@@ -58,9 +63,9 @@ struct EdgeInfo {
 
   size_t id;
   NodeId source;
-  voxblox::LongIndexSet indices;
-  std::set<NodeId> node_connections;
-  std::set<size_t> connections;
+  GlobalIndexSet indices;
+  NodeIdSet node_connections;
+  EdgeIdSet connections;
 };
 
 struct EdgeSplitSeed {
@@ -0,0 +1,172 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include "hydra_topology/gvd_voxel.h"
+#include "hydra_topology/voxblox_types.h"
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace hydra {
+namespace topology {
+
+/**
+ * @brief Fixed-capacity set of parents that a GVD voxel is equidistant to
+ */
+struct GvdBasis {
+  static constexpr size_t kMaxParents = 12;
+
+  inline GlobalIndex getParent(size_t i) const {
+    return Eigen::Map<const GvdIndex>(parents[i]).cast<GlobalIndex::Scalar>();
+  }
+
+  inline GlobalIndex getVoxelParent() const {
+    return Eigen::Map<const GvdIndex>(voxel_parent).cast<GlobalIndex::Scalar>();
+  }
+
+  inline void setVoxelParent(const GlobalIndex& parent) {
+    Eigen::Map<GvdIndex>(voxel_parent) = parent.cast<GvdIndexScalar>();
+  }
+
+  //! add a parent to the basis (returns false if the basis is full)
+  inline bool addParent(const GlobalIndex& parent) {
+    if (num_parents == kMaxParents) {
+      return false;
+    }
+
+    Eigen::Map<GvdIndex>(parents[num_parents]) = parent.cast<GvdIndexScalar>();
+    ++num_parents;
+    return true;
+  }
+
+  GvdIndexScalar parents[kMaxParents][3];
+  //! parent of the voronoi voxel itself when the basis was computed
+  GvdIndexScalar voxel_parent[3];
+  uint8_t num_parents = 0;
+};
+
+/**
+ * @brief Block-local storage for the GVD basis of each voronoi voxel and the mesh
+ * vertex of each surface voxel that acts as a GVD parent
+ *
+ * Entries are kept in per-block pools that are indexed by the linear voxel index, so
+ * lookups only hash the block index. Vertex info that is still referenced when its
+ * block is removed is moved to a (small) archived map.
+ */
+class GvdBasisStore {
+ public:
+  using VertexCallback = std::function<bool(const GvdVoxel*, GvdVertexInfo&)>;
+
+  explicit GvdBasisStore(int voxels_per_side);
+
+  GvdBasis* getBasis(const GlobalIndex& index);
+
+  const GvdBasis* getBasis(const GlobalIndex& index) const;
+
+  //! get the basis for a voxel, allocating an empty basis if it doesn't exist
+  GvdBasis& allocateBasis(const GlobalIndex& index);
+
+  //! remove the basis for a voxel and release the vertices of its parents
+  void removeBasis(const GlobalIndex& index);
+
+  GvdVertexInfo* getVertex(const GlobalIndex& parent);
+
+  const GvdVertexInfo* getVertex(const GlobalIndex& parent) const;
+
+  //! get the vertex info for a parent, allocating it if it doesn't exist
+  GvdVertexInfo& allocateVertex(const GlobalIndex& parent);
+
+  //! remove the vertex info for a parent (regardless of its ref count)
+  void removeVertex(const GlobalIndex& parent);
+
+  /**
+   * @brief Visit every vertex info, removing those that the callback rejects
+   *
+   * The callback gets the parent voxel from the layer (or nullptr if the parent
+   * block is no longer allocated) and returns whether to keep the vertex info
+   */
+  void filterVertices(const Layer<GvdVoxel>& layer, const VertexCallback& callback);
+
+  //! remove all entries of a block (releasing the vertices of the removed bases)
+  void removeBlock(const BlockIndex& index);
+
+  size_t numBlocks() const { return blocks_.size(); }
+
+  size_t numArchivedVertices() const { return archived_vertices_.size(); }
+
+ private:
+  static constexpr uint32_t kInvalidSlot = std::numeric_limits<uint32_t>::max();
+
+  struct VertexEntry {
+    GvdVertexInfo info;
+    uint32_t voxel = kInvalidSlot;
+  };
+
+  struct BlockEntries {
+    explicit BlockEntries(size_t num_voxels);
+
+    std::vector<uint32_t> basis_slots;
+    std::vector<GvdBasis> basis;
+    std::vector<uint32_t> free_basis;
+
+    std::vector<uint32_t> vertex_slots;
+    std::vector<VertexEntry> vertices;
+    std::vector<uint32_t> free_vertices;
+  };
+
+  using BlockMap = voxblox::AnyIndexHashMapType<std::unique_ptr<BlockEntries>>::type;
+
+  BlockIndex getBlockIndex(const GlobalIndex& index, size_t& linear_index) const;
+
+  BlockEntries* getBlock(const GlobalIndex& index, size_t& linear_index) const;
+
+  BlockEntries& allocateBlock(const GlobalIndex& index, size_t& linear_index);
+
+  GlobalIndex getGlobalIndex(const BlockIndex& block, uint32_t linear_index) const;
+
+  void releaseParents(const GvdBasis& basis);
+
+  void removeVertex(BlockEntries& block, uint32_t slot);
+
+  const int voxels_per_side_;
+  const size_t num_voxels_;
+  BlockMap blocks_;
+  GvdVertexMap archived_vertices_;
+};
+
+}  // namespace topology
+}  // namespace hydra
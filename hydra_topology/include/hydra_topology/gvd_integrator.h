@@ -34,11 +34,18 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include "hydra_topology/graph_extractor.h"
+#include "hydra_topology/gvd_basis_store.h"
+#include "hydra_topology/gvd_neighbor_accessor.h"
 #include "hydra_topology/gvd_utilities.h"
 #include "hydra_topology/gvd_voxel.h"
+#include "hydra_topology/gvd_wavefront.h"
+#include "hydra_topology/thread_pool.h"
+#include "hydra_topology/tsdf_block_archive.h"
 #include "hydra_topology/voxblox_types.h"
 #include "hydra_topology/voxel_aware_mesh_integrator.h"
 
+#include <functional>
+#include <mutex>
 #include <utility>
 
 namespace hydra {
@@ -59,8 +66,24 @@ struct GvdIntegratorConfig {
   GraphExtractorConfig graph_extractor_config;
   bool extract_graph = true;
   bool mesh_only = false;
+  //! number of threads used to propagate the wavefronts (1 uses the serial queues)
+  size_t num_threads = 1;
+  //! scratch file that distant TSDF blocks are archived to (empty deletes them)
+  std::string archive_path = "";
+  //! number of archived blocks that may stay resident in memory
+  size_t archive_max_resident_blocks = 256;
 };
 
+/**
+ * @brief Derive the config of a GVD downsampled by an integer factor
+ *
+ * Distances measured through the GVD are scaled by the factor. min_distance_m is
+ * compared against TSDF distances, which downsampling never pushes past the fine
+ * truncation distance, so it keeps its fine value.
+ */
+GvdIntegratorConfig getCoarseGvdConfig(const GvdIntegratorConfig& config,
+                                       size_t factor);
+
 /**
  * @brief Tracking statistics for what the integrator did
  */
@@ -76,6 +99,8 @@ struct UpdateStatistics {
   size_t number_force_lowered;
 
   void clear();
+
+  void merge(const UpdateStatistics& other);
 };
 
 /**
@@ -104,6 +129,19 @@ class GvdIntegrator {
 
   BlockIndexList removeDistantBlocks(const voxblox::Point& center, double max_distance);
 
+  /**
+   * @brief Copy the updated blocks of a live TSDF layer into the integrator's layer
+   *
+   * Archived blocks that the live layer re-allocated are restored into the live
+   * block before the copy, so that later copies don't drop the archived contents.
+   * Clears the ESDF and mesh updated flags of the live blocks.
+   */
+  void copyUpdatedTsdfBlocks(Layer<TsdfVoxel>& live_layer);
+
+  inline MeshChangeTracker& getMeshChanges() const {
+    return mesh_integrator_->getMeshChanges();
+  }
+
  protected:
   void processTsdfBlock(const Block<TsdfVoxel>& block, const BlockIndex& index);
 
@@ -111,21 +149,30 @@ class GvdIntegrator {
 
   void processLowerSet();
 
+  void processRaiseVoxel(const GlobalIndex& index);
+
+  void processLowerVoxel(const GlobalIndex& index);
+
+  void processTsdfBlocksParallel(const BlockIndexList& blocks);
+
+  void processRaiseSetParallel();
+
+  void processLowerSetParallel();
+
+  void runWavefrontPass(const BlockWavefront::BlockList& blocks,
+                        const std::function<void(WavefrontBlock&)>& callback);
+
+  UpdateStatistics& stats();
+
   void updateFromTsdfBlocks(const BlockIndexList& tsdf_blocks);
 
   bool updateVoxelFromNeighbors(const GlobalIndex& index, GvdVoxel& voxel);
 
-  bool processNeighbor(GvdVoxel& voxel,
-                       const GlobalIndex& voxel_idx,
-                       FloatingPoint neighbor_distance,
-                       const GlobalIndex& neighbor_idx,
+  bool processNeighbor(const GvdNeighborAccessor& neighbors,
+                       unsigned int n,
+                       GvdVoxel& voxel,
                        GvdVoxel& neighbor);
 
-  void updateVoronoiQueue(GvdVoxel& curr_voxel,
-                          const GlobalIndex& curr_pos,
-                          GvdVoxel& neighbor_voxel,
-                          const GlobalIndex& neighbor_pos);
-
   void updateUnobservedGvdVoxel(const TsdfVoxel& tsdf_voxel,
                                 const GlobalIndex& index,
                                 GvdVoxel& gvd_voxel);
@@ -134,10 +181,13 @@ class GvdIntegrator {
                               const GlobalIndex& index,
                               GvdVoxel& gvd_voxel);
 
-  void setFixedParent(const GvdNeighborhood::IndexMatrix& neighbor_indices,
-                      GvdVoxel& voxel);
+  void setFixedParent(const GvdNeighborAccessor& neighbors, GvdVoxel& voxel);
 
-  void raiseVoxel(GvdVoxel& voxel, const GlobalIndex& voxel_index);
+  void setFixedParents(const BlockIndexList& blocks);
+
+  void updateVoronoi();
+
+  void raiseVoxel(GvdVoxel& voxel);
 
   uint8_t updateGvdParentMap(const GlobalIndex& voxel_index, const GvdVoxel& neighbor);
 
@@ -156,7 +206,14 @@ class GvdIntegrator {
 
   void markNewGvdParent(const GlobalIndex& parent);
 
+  void setParentVertex(const GvdVoxel& parent_voxel, GvdVertexInfo& info);
+
+  void resolvePendingParents();
+
  protected:
+  //! shared by the mesh integrator and the parallel wavefront
+  std::shared_ptr<ThreadPool> thread_pool_;
+
   std::unique_ptr<VoxelAwareMeshIntegrator> mesh_integrator_;
 
   enum class PushType {
@@ -173,8 +230,8 @@ class GvdIntegrator {
   Layer<GvdVoxel>::Ptr gvd_layer_;
   MeshLayer::Ptr mesh_layer_;
 
-  GvdParentMap gvd_parents_;
-  GvdVertexMap gvd_parent_vertices_;
+  GvdBasisStore gvd_basis_;
+  std::unique_ptr<TsdfBlockArchive> tsdf_archive_;
 
   GraphExtractor::Ptr graph_extractor_;
 
@@ -182,6 +239,16 @@ class GvdIntegrator {
 
   AlignedQueue<GlobalIndex> raise_;
 
+  //! block-partitioned queues (only used if config_.num_threads > 1)
+  std::unique_ptr<BlockWavefront> wavefront_;
+  //! guards the GVD basis store and the graph extractor during parallel updates
+  std::mutex gvd_mutex_;
+  //! parents allocated during the parallel wavefront that still need a vertex
+  voxblox::AlignedVector<GlobalIndex> pending_parents_;
+  //! voxels raised or lowered by the serial wavefront (GVD membership is updated
+  //! once the wavefront settles)
+  voxblox::AlignedVector<GlobalIndex> touched_voxels_;
+
   FloatingPoint voxel_size_;
 
  protected:
@@ -189,23 +256,23 @@ class GvdIntegrator {
     switch (action) {
       case PushType::NEW:
         voxel.in_queue = true;
-        lower_.push(index, voxel.distance);
-        update_stats_.number_new_voxels++;
+        pushLower(index, voxel);
+        stats().number_new_voxels++;
         break;
       case PushType::LOWER:
         voxel.in_queue = true;
-        lower_.push(index, voxel.distance);
-        update_stats_.number_lowered_voxels++;
+        pushLower(index, voxel);
+        stats().number_lowered_voxels++;
         break;
       case PushType::RAISE:
-        raise_.push(index);
-        update_stats_.number_raised_voxels++;
+        pushRaise(index);
+        stats().number_raised_voxels++;
         break;
       case PushType::BOTH:
         voxel.in_queue = true;
-        lower_.push(index, voxel.distance);
-        raise_.push(index);
-        update_stats_.number_raised_voxels++;
+        pushLower(index, voxel);
+        pushRaise(index);
+        stats().number_raised_voxels++;
         break;
       default:
         LOG(FATAL) << "Invalid push type!";
@@ -213,6 +280,22 @@ class GvdIntegrator {
     }
   }
 
+  inline void pushLower(const GlobalIndex& index, const GvdVoxel& voxel) {
+    if (wavefront_) {
+      wavefront_->pushLower(index, voxel.distance);
+    } else {
+      lower_.push(index, voxel.distance);
+    }
+  }
+
+  inline void pushRaise(const GlobalIndex& index) {
+    if (wavefront_) {
+      wavefront_->pushRaise(index);
+    } else {
+      raise_.push(index);
+    }
+  }
+
   inline GlobalIndex popFromLower() {
     GlobalIndex index = lower_.front();
     lower_.pop();
@@ -252,6 +335,10 @@ class GvdIntegrator {
 
     return true;
   }
+
+  inline bool canBeVoronoi(const GvdVoxel* voxel) {
+    return voxel && !voxel->on_surface && voxel->has_parent && voxelHasDistance(*voxel);
+  }
 };
 
 }  // namespace topology
@@ -0,0 +1,138 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include "hydra_topology/gvd_voxel.h"
+#include "hydra_topology/voxblox_types.h"
+
+#include <array>
+
+namespace hydra {
+namespace topology {
+
+/**
+ * @brief Serves the 26-connected neighborhood of a GVD voxel from cached block
+ * pointers
+ *
+ * The blocks that the neighborhood touches (at most eight) are resolved once per
+ * call to setIndex. Neighbors of voxels that are not on a block face are read
+ * directly from the center block without any block lookups.
+ */
+class GvdNeighborAccessor {
+ public:
+  explicit GvdNeighborAccessor(Layer<GvdVoxel>& layer);
+
+  /**
+   * @brief Resolve the neighborhood around a voxel
+   * @returns the voxel at the index (or nullptr if the block isn't allocated)
+   */
+  GvdVoxel* setIndex(const GlobalIndex& index);
+
+  inline bool isInterior() const { return interior_; }
+
+  inline const GlobalIndex& getIndex() const { return index_; }
+
+  inline const voxblox::Point& getPosition() const { return position_; }
+
+  inline GlobalIndex getNeighborIndex(unsigned int n) const {
+    return index_ + GvdNeighborhood::kOffsets.col(n);
+  }
+
+  inline GvdVoxel* getNeighbor(unsigned int n) const {
+    if (interior_) {
+      return &block_->getVoxelByLinearIndex(linear_index_ + linear_offsets_[n]);
+    }
+
+    VoxelIndex neighbor_index;
+    Block<GvdVoxel>* block = getNeighborBlock(n, neighbor_index);
+    return block ? &block->getVoxelByVoxelIndex(neighbor_index) : nullptr;
+  }
+
+  /**
+   * @brief Get the position of a neighbor (must have an allocated block)
+   */
+  inline voxblox::Point getNeighborPosition(unsigned int n) const {
+    const VoxelIndex offset = GvdNeighborhood::kOffsets.col(n).cast<IndexElement>();
+    if (interior_) {
+      return block_->computeCoordinatesFromVoxelIndex(voxel_index_ + offset);
+    }
+
+    VoxelIndex neighbor_index;
+    const Block<GvdVoxel>* block = getNeighborBlock(n, neighbor_index);
+    CHECK(block) << "Attempting to look up coordinates for "
+                 << getNeighborIndex(n).transpose()
+                 << ", which is outside of the allocated blocks";
+    return block->computeCoordinatesFromVoxelIndex(neighbor_index);
+  }
+
+ private:
+  using IndexElement = voxblox::IndexElement;
+
+  inline Block<GvdVoxel>* getNeighborBlock(unsigned int n,
+                                           VoxelIndex& neighbor_index) const {
+    neighbor_index =
+        voxel_index_ + GvdNeighborhood::kOffsets.col(n).cast<IndexElement>();
+
+    size_t block_offset = 13;  // center of the 3x3x3 block cache
+    size_t stride = 1;
+    for (int i = 0; i < 3; ++i) {
+      if (neighbor_index(i) < 0) {
+        neighbor_index(i) += voxels_per_side_;
+        block_offset -= stride;
+      } else if (neighbor_index(i) >= voxels_per_side_) {
+        neighbor_index(i) -= voxels_per_side_;
+        block_offset += stride;
+      }
+      stride *= 3;
+    }
+
+    return blocks_[block_offset];
+  }
+
+  Layer<GvdVoxel>& layer_;
+  const IndexElement voxels_per_side_;
+  std::array<int64_t, GvdNeighborhood::IndexOffsets::ColsAtCompileTime> linear_offsets_;
+
+  GlobalIndex index_;
+  VoxelIndex voxel_index_;
+  voxblox::Point position_;
+  Block<GvdVoxel>* block_;
+  size_t linear_index_;
+  bool interior_;
+  //! blocks around the center block indexed by (x + 1) + 3 * (y + 1) + 9 * (z + 1)
+  std::array<Block<GvdVoxel>*, 27> blocks_;
+};
+
+}  // namespace topology
+}  // namespace hydra
@@ -36,6 +36,8 @@
 #include "hydra_topology/gvd_voxel.h"
 #include "hydra_topology/voxblox_types.h"
 
+#include <algorithm>
+
 namespace hydra {
 namespace topology {
 
@@ -49,11 +51,10 @@ inline void setSdfParent(GvdVoxel& voxel,
                          const voxblox::Point& ancestor_pos) {
   voxel.has_parent = true;
   if (ancestor.has_parent) {
-    std::memcpy(voxel.parent, ancestor.parent, sizeof(voxel.parent));
-    std::memcpy(voxel.parent_pos, ancestor.parent_pos, sizeof(voxel.parent_pos));
+    copyParent(voxel, ancestor);
   } else {
-    Eigen::Map<GlobalIndex>(voxel.parent) = ancestor_index;
-    Eigen::Map<voxblox::Point>(voxel.parent_pos) = ancestor_pos;
+    setParentIndex(voxel, ancestor_index);
+    setParentPosition(voxel, ancestor_pos);
   }
 }
 
@@ -65,6 +66,34 @@ inline void setGvdSurfaceVoxel(GvdVoxel& voxel) {
   resetGvdParent(voxel);
 }
 
+//! strict lexicographic order on voxel indices (used to break ties deterministically)
+inline bool indexLess(const GlobalIndex& lhs, const GlobalIndex& rhs) {
+  return std::lexicographical_compare(
+      lhs.data(), lhs.data() + 3, rhs.data(), rhs.data() + 3);
+}
+
+/**
+ * @brief Check whether a voxel is closer to a candidate parent than to its current
+ * parent
+ *
+ * Distances are compared in index space (so equal distances compare equal) and ties
+ * go to the smaller parent index, which makes the settled parents independent of
+ * the order that the wavefront visits voxels in
+ */
+inline bool isCloserParent(const GlobalIndex& index,
+                           const GlobalIndex& candidate,
+                           const GlobalIndex& current) {
+  const GlobalIndex candidate_diff = index - candidate;
+  const GlobalIndex current_diff = index - current;
+  const GlobalIndex::Scalar candidate_dist = candidate_diff.dot(candidate_diff);
+  const GlobalIndex::Scalar current_dist = current_diff.dot(current_diff);
+  if (candidate_dist != current_dist) {
+    return candidate_dist < current_dist;
+  }
+
+  return indexLess(candidate, current);
+}
+
 struct DistancePotential {
   bool is_lower;
   double distance;
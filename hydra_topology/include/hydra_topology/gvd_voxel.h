@@ -35,35 +35,87 @@
 #pragma once
 #include "hydra_topology/voxblox_types.h"
 
+#include <cstring>
 #include <iostream>
 
 namespace hydra {
 namespace topology {
 
-// TODO(nathan) packed?
+//! Scalar used for global indices stored in voxels (covers 2^31 voxels per axis)
+using GvdIndexScalar = int32_t;
+using GvdIndex = Eigen::Matrix<GvdIndexScalar, 3, 1>;
+
+/**
+ * @brief GVD voxel with bit-packed flags and 32-bit indices
+ *
+ * Building with HYDRA_GVD_RECOMPUTE_PARENT_POS drops the stored parent position
+ * and recomputes it from the parent index instead (see getParentPosition)
+ */
 struct GvdVoxel {
-  float distance;
-  bool observed = false;
-  bool fixed = false;
-  bool in_queue = false;
+  GvdVoxel()
+      : observed(false),
+        fixed(false),
+        in_queue(false),
+        has_parent(false),
+        on_surface(false),
+        is_voronoi_parent(false) {}
 
-  bool has_parent = false;
-  GlobalIndex::Scalar parent[3];
+  float distance;
+  GvdIndexScalar parent[3];
+#ifndef HYDRA_GVD_RECOMPUTE_PARENT_POS
   // required for removing blocks (parents leave a dangling reference otherwise)
   voxblox::Point::Scalar parent_pos[3];
+#endif
 
-  uint8_t num_extra_basis = 0;
-
-  bool on_surface = false;
   // TODO(nathan) leave this unitialized
-  size_t block_vertex_index = 123456789;
+  uint32_t block_vertex_index = 123456789;
   int32_t mesh_block[3];
 
-  bool is_voronoi_parent = false;
-  GlobalIndex::Scalar nearest_voronoi[3];
-  GlobalIndex::Scalar nearest_voronoi_distance;
+  uint8_t num_extra_basis = 0;
+
+  bool observed : 1;
+  bool fixed : 1;
+  bool in_queue : 1;
+  bool has_parent : 1;
+  bool on_surface : 1;
+  bool is_voronoi_parent : 1;
 };
 
+inline GlobalIndex getParentIndex(const GvdVoxel& voxel) {
+  return Eigen::Map<const GvdIndex>(voxel.parent).cast<GlobalIndex::Scalar>();
+}
+
+inline void setParentIndex(GvdVoxel& voxel, const GlobalIndex& index) {
+  Eigen::Map<GvdIndex>(voxel.parent) = index.cast<GvdIndexScalar>();
+}
+
+inline voxblox::Point getParentPosition(const GvdVoxel& voxel,
+                                        FloatingPoint voxel_size) {
+#ifdef HYDRA_GVD_RECOMPUTE_PARENT_POS
+  return voxblox::getCenterPointFromGridIndex(getParentIndex(voxel), voxel_size);
+#else
+  (void)voxel_size;
+  return Eigen::Map<const voxblox::Point>(voxel.parent_pos);
+#endif
+}
+
+inline void setParentPosition(GvdVoxel& voxel, const voxblox::Point& pos) {
+#ifdef HYDRA_GVD_RECOMPUTE_PARENT_POS
+  (void)voxel;
+  (void)pos;
+#else
+  Eigen::Map<voxblox::Point>(voxel.parent_pos) = pos;
+#endif
+}
+
+//! copy the parent index (and position if stored) from another voxel
+inline void copyParent(GvdVoxel& voxel, const GvdVoxel& other) {
+  std::memcpy(voxel.parent, other.parent, sizeof(voxel.parent));
+#ifndef HYDRA_GVD_RECOMPUTE_PARENT_POS
+  std::memcpy(voxel.parent_pos, other.parent_pos, sizeof(voxel.parent_pos));
+#endif
+}
+
 std::ostream& operator<<(std::ostream& out, const GvdVoxel& voxel);
 
 struct GvdVertexInfo {
@@ -73,7 +125,6 @@ struct GvdVertexInfo {
   size_t ref_count = 0;
 };
 
-using GvdParentMap = voxblox::LongIndexHashMapType<voxblox::LongIndexSet>::type;
 using GvdVertexMap = voxblox::LongIndexHashMapType<GvdVertexInfo>::type;
 using GvdNeighborhood = Neighborhood<voxblox::Connectivity::kTwentySix>;
 
@@ -0,0 +1,152 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include "hydra_topology/gvd_voxel.h"
+#include "hydra_topology/voxblox_types.h"
+
+#include <array>
+#include <memory>
+#include <mutex>
+
+namespace hydra {
+namespace topology {
+
+/**
+ * @brief Per-block portion of the raise and lower wavefronts
+ *
+ * Each block owns the queue entries for its own voxels. The mutex guards both the
+ * queues and the GVD voxels of the block while the wavefront is processed by
+ * multiple threads.
+ */
+struct WavefrontBlock {
+  using Ptr = std::unique_ptr<WavefrontBlock>;
+
+  WavefrontBlock(const BlockIndex& index, size_t num_buckets);
+
+  void pushLower(const GlobalIndex& index, size_t bucket);
+
+  bool hasLower(size_t max_bucket) const;
+
+  GlobalIndex popLower();
+
+  void clear();
+
+  const BlockIndex index;
+  std::mutex mutex;
+  AlignedQueue<GlobalIndex> raise;
+  std::vector<AlignedQueue<GlobalIndex>> lower;
+  size_t num_lower;
+  size_t min_bucket;
+  //! voxels of the block that were raised or lowered since the last popTouched
+  voxblox::AlignedVector<GlobalIndex> touched;
+};
+
+/**
+ * @brief Locks the (up to eight) blocks that a voxel and its 26-connected
+ * neighborhood touch in a consistent order to avoid deadlocks
+ */
+class WavefrontLock {
+ public:
+  WavefrontLock() = default;
+
+  ~WavefrontLock();
+
+  void add(WavefrontBlock* block);
+
+  void lock();
+
+  void unlock();
+
+  inline size_t size() const { return num_blocks_; }
+
+  inline bool isLocked() const { return locked_; }
+
+  bool contains(const WavefrontBlock* block) const;
+
+ private:
+  std::array<WavefrontBlock*, 8> blocks_;
+  size_t num_blocks_ = 0;
+  bool locked_ = false;
+};
+
+/**
+ * @brief Raise and lower wavefronts partitioned by voxblox block
+ *
+ * Voxels are queued in the block that contains them. Updating a voxel next to a
+ * block boundary hands the neighbor off to the adjacent block's queue, which
+ * requires the caller to hold the lock for every block the voxel touches (see
+ * getTouchedBlocks).
+ */
+class BlockWavefront {
+ public:
+  using BlockList = std::vector<WavefrontBlock*>;
+
+  BlockWavefront(int voxels_per_side, int num_buckets, FloatingPoint max_distance);
+
+  void syncBlocks(const Layer<GvdVoxel>& layer);
+
+  WavefrontBlock* getBlock(const BlockIndex& index) const;
+
+  WavefrontBlock* getBlockForVoxel(const GlobalIndex& index) const;
+
+  void getTouchedBlocks(const GlobalIndex& index, WavefrontLock& lock) const;
+
+  void pushLower(const GlobalIndex& index, FloatingPoint distance);
+
+  void pushRaise(const GlobalIndex& index);
+
+  size_t getBucket(FloatingPoint distance) const;
+
+  BlockList getLowerBlocks(size_t max_bucket) const;
+
+  BlockList getRaiseBlocks() const;
+
+  BlockList getAllBlocks() const;
+
+  //! move the touched voxels of every block to the output (without locking)
+  void popTouched(voxblox::AlignedVector<GlobalIndex>& touched);
+
+  inline size_t numBuckets() const { return num_buckets_; }
+
+ private:
+  const int voxels_per_side_;
+  const size_t num_buckets_;
+  const FloatingPoint max_distance_;
+
+  voxblox::AnyIndexHashMapType<WavefrontBlock::Ptr>::type blocks_;
+};
+
+}  // namespace topology
+}  // namespace hydra
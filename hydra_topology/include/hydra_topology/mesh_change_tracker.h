@@ -0,0 +1,80 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include "hydra_topology/voxblox_types.h"
+
+#include <cstdint>
+
+namespace hydra {
+namespace topology {
+
+/**
+ * @brief Per-block generation counters for a mesh layer
+ *
+ * Every call to markUpdated starts a new generation and stamps the re-meshed blocks
+ * with it. Consumers remember the last generation they serialized and only ask for
+ * blocks that are newer, so publishing scales with the number of changed blocks
+ * instead of the size of the mesh.
+ */
+class MeshChangeTracker {
+ public:
+  MeshChangeTracker() = default;
+
+  //! start a new generation and stamp the blocks with it
+  void markUpdated(const BlockIndexList& blocks);
+
+  void removeBlock(const BlockIndex& index);
+
+  //! get all blocks stamped after the provided generation
+  BlockIndexList getUpdatedSince(uint64_t generation) const;
+
+  BlockIndexList getAllBlocks() const;
+
+  //! the most recently started generation (0 if nothing was marked yet)
+  uint64_t generation() const { return generation_; }
+
+  bool hasBlock(const BlockIndex& index) const { return blocks_.count(index); }
+
+  size_t numBlocks() const { return blocks_.size(); }
+
+ private:
+  using GenerationMap = voxblox::AnyIndexHashMapType<uint64_t>::type;
+
+  uint64_t generation_ = 0;
+  GenerationMap blocks_;
+};
+
+}  // namespace topology
+}  // namespace hydra
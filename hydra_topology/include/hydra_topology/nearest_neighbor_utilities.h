@@ -34,6 +34,7 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <hydra_utils/dsg_types.h>
+#include "hydra_topology/thread_pool.h"
 #include "hydra_topology/voxblox_types.h"
 
 #include <memory>
@@ -47,6 +48,8 @@ namespace topology {
 class NearestNodeFinder {
  public:
   using Callback = std::function<void(NodeId, size_t, double)>;
+  //! same as Callback, but with the index of the query position first
+  using BatchCallback = std::function<void(size_t, NodeId, size_t, double)>;
 
   NearestNodeFinder(const SceneGraphLayer& layer, const std::vector<NodeId>& nodes);
 
@@ -58,7 +61,69 @@ class NearestNodeFinder {
   void find(const Eigen::Vector3d& position,
             size_t num_to_find,
             bool skip_first,
-            const Callback& callback);
+            const Callback& callback) const;
+
+  /**
+   * @brief Find nearest nodes for every column of positions
+   *
+   * Searches run in parallel if a thread pool is provided, but the callback is
+   * always invoked from the calling thread in query order.
+   */
+  void findMany(const Eigen::Matrix3Xd& positions,
+                size_t num_to_find,
+                bool skip_first,
+                const BatchCallback& callback,
+                ThreadPool* thread_pool = nullptr) const;
+
+ private:
+  struct Detail;
+
+  std::unique_ptr<Detail> internals_;
+};
+
+/**
+ * @brief Spatial index over scene graph nodes that can be updated in place
+ *
+ * Nodes are bucketed by position into a sparse hash grid, so inserting, moving and
+ * removing a node are constant time and never require rebuilding the index.
+ * Queries search outward from the query cell one shell of cells at a time. Distances
+ * passed to the callback are squared (matching NearestNodeFinder).
+ */
+class IncrementalNodeFinder {
+ public:
+  using Callback = NearestNodeFinder::Callback;
+  using BatchCallback = NearestNodeFinder::BatchCallback;
+
+  explicit IncrementalNodeFinder(double cell_size = 1.0);
+
+  virtual ~IncrementalNodeFinder();
+
+  //! add a node or move an existing node to a new position
+  void insert(NodeId node, const Eigen::Vector3d& position);
+
+  //! remove a node (returns false if the node isn't in the index)
+  bool erase(NodeId node);
+
+  //! make the index contain exactly the provided nodes at their current positions
+  void update(const SceneGraphLayer& layer, const std::unordered_set<NodeId>& nodes);
+
+  bool contains(NodeId node) const;
+
+  size_t size() const;
+
+  void clear();
+
+  void find(const Eigen::Vector3d& position,
+            size_t num_to_find,
+            bool skip_first,
+            const Callback& callback) const;
+
+  //! batched queries (see NearestNodeFinder::findMany)
+  void findMany(const Eigen::Matrix3Xd& positions,
+                size_t num_to_find,
+                bool skip_first,
+                const BatchCallback& callback,
+                ThreadPool* thread_pool = nullptr) const;
 
  private:
   struct Detail;
@@ -0,0 +1,116 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+namespace topology {
+
+/**
+ * @brief Runs the outputs of an update (publishing, visualization) on a worker thread
+ *
+ * Tasks are collected into a batch by the update thread and own a snapshot of
+ * everything they publish. Batches run in submission order while the next update is
+ * being computed. At most max_pending batches are in flight: submit blocks until the
+ * worker catches up, which keeps the memory used by queued messages bounded.
+ */
+class OutputPipeline {
+ public:
+  using Task = std::function<void()>;
+
+  struct Stats {
+    size_t num_batches = 0;
+    //! batches queued or running at the time the stats were read
+    size_t queue_depth = 0;
+    size_t max_queue_depth = 0;
+    //! time the last batch spent in the queue
+    double last_wait_s = 0.0;
+    //! time the last batch took to run
+    double last_run_s = 0.0;
+  };
+
+  explicit OutputPipeline(size_t max_pending);
+
+  //! runs every submitted batch before joining the worker
+  ~OutputPipeline();
+
+  OutputPipeline(const OutputPipeline& other) = delete;
+
+  OutputPipeline& operator=(const OutputPipeline& other) = delete;
+
+  //! add a task to the batch being collected (not thread-safe w.r.t. submit)
+  void add(Task task);
+
+  //! hand the collected batch to the worker, blocking while too many are in flight
+  void submit();
+
+  //! block until every submitted batch has run
+  void flush();
+
+  Stats getStats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Batch {
+    std::vector<Task> tasks;
+    Clock::time_point submitted;
+  };
+
+  inline size_t numInFlight() const { return batches_.size() + (running_ ? 1 : 0); }
+
+  void workerLoop();
+
+  const size_t max_pending_;
+  std::vector<Task> current_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable batch_cv_;
+  std::condition_variable done_cv_;
+  std::deque<Batch> batches_;
+  bool running_;
+  bool should_exit_;
+  Stats stats_;
+  std::thread worker_;
+};
+
+}  // namespace topology
+}  // namespace hydra
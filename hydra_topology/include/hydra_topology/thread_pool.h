@@ -0,0 +1,134 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+namespace topology {
+
+/**
+ * @brief Long-lived pool of worker threads shared by the parallel update stages
+ *
+ * Tasks are pulled from a single shared queue and belong to a TaskGroup that can be
+ * waited on independently of the rest of the pool. Tasks may push further tasks to
+ * their group (e.g., to release work once its dependencies are done). The thread
+ * that calls wait() helps run the queued tasks of its group, so a pool of N threads
+ * spawns N - 1 workers and tasks can wait on nested groups without deadlocking.
+ */
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  /**
+   * @brief Tracks the outstanding tasks of one batch
+   *
+   * A group has to be waited on before it goes out of scope
+   */
+  class TaskGroup {
+   public:
+    TaskGroup() = default;
+
+    TaskGroup(const TaskGroup& other) = delete;
+
+    TaskGroup& operator=(const TaskGroup& other) = delete;
+
+   private:
+    friend class ThreadPool;
+
+    size_t num_pending_ = 0;
+    //! first exception thrown by a task of the group
+    std::exception_ptr error_;
+  };
+
+  explicit ThreadPool(size_t num_threads);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool& other) = delete;
+
+  ThreadPool& operator=(const ThreadPool& other) = delete;
+
+  inline size_t numThreads() const { return workers_.size() + 1; }
+
+  void push(TaskGroup& group, Task task);
+
+  /**
+   * @brief run queued tasks until every task of the group (and its children) is done
+   *
+   * Rethrows the first exception thrown by a task of the group
+   */
+  void wait(TaskGroup& group);
+
+  /**
+   * @brief call the callback for [0, num_tasks) in parallel and wait for completion
+   *
+   * The range is split into at most numThreads() contiguous chunks (one task each)
+   * of at least min_chunk_size indices. A range that only makes one chunk runs on
+   * the calling thread.
+   */
+  void parallelFor(size_t num_tasks,
+                   const std::function<void(size_t)>& callback,
+                   size_t min_chunk_size = 1);
+
+ private:
+  struct QueuedTask {
+    Task task;
+    TaskGroup* group;
+  };
+
+  void runTask(std::unique_lock<std::mutex>& lock,
+               std::deque<QueuedTask>::iterator iter);
+
+  std::deque<QueuedTask>::iterator findTask(const TaskGroup& group);
+
+  void workerLoop();
+
+  std::mutex mutex_;
+  std::condition_variable task_cv_;
+  std::condition_variable done_cv_;
+  std::deque<QueuedTask> tasks_;
+  size_t num_waiting_;
+  bool should_exit_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace topology
+}  // namespace hydra
@@ -34,11 +34,16 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include "hydra_topology/configs.h"
+#include "hydra_topology/nearest_neighbor_utilities.h"
+#include "hydra_topology/output_pipeline.h"
 #include "hydra_topology/topology_server_visualizer.h"
+#include "hydra_topology/tsdf_downsampler.h"
 
 #include <hydra_msgs/ActiveLayer.h>
 #include <hydra_msgs/ActiveMesh.h>
 #include <hydra_utils/display_utils.h>
+#include <std_msgs/Empty.h>
+#include <std_msgs/Float64.h>
 #include <std_msgs/Time.h>
 #include <voxblox_ros/conversions.h>
 #include <voxblox_ros/mesh_vis.h>
@@ -47,6 +52,14 @@
 #include <glog/logging.h>
 #include <ros/ros.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+
 namespace hydra {
 namespace topology {
 
@@ -75,6 +88,10 @@ class TopologyServer {
       time_pub.publish(msg);
     }
 
+    ros::Time lastPointcloudTime() const {
+      return BaseTsdfServerType::last_msg_time_ptcloud_;
+    }
+
     bool has_pose;
     voxblox::Transformation T_G_C_last;
     ros::Publisher time_pub;
@@ -83,27 +100,73 @@ class TopologyServer {
     using BaseTsdfServerType::nh_;
   };
 
+  //! all parameters and topics live under the namespace of nh, which lets the server
+  //! run inside another node's process
   explicit TopologyServer(const ros::NodeHandle& nh) : nh_(nh) {
-    setupConfig("~");
+    setupConfig();
     setupLayers();
 
-    visualizer_.reset(new TopologyServerVisualizer("~"));
+    if (config_.pipeline_outputs) {
+      output_pipeline_.reset(new OutputPipeline(config_.max_pending_outputs));
+    }
+
+    visualizer_.reset(new TopologyServerVisualizer(nh_, output_pipeline_.get()));
 
     // we need two publishers for the mesh: voxblox offers no way to distinguish between
     // deleted blocks and blocks that were cleared by observation
+    // only changed mesh blocks are published, so new subscribers get a full snapshot
+    const bool latch = config_.latch_active_mesh;
+    const ros::SubscriberStatusCallback active_connect_cb =
+        [this](const ros::SingleSubscriberPublisher&) {
+          active_mesh_snapshot_requested_ = true;
+        };
     if (config_.publish_archived) {
-      mesh_pub_ = nh_.advertise<hydra_msgs::ActiveMesh>("active_mesh", 1, true);
+      mesh_pub_ = nh_.advertise<hydra_msgs::ActiveMesh>(
+          "active_mesh", 1, active_connect_cb, {}, {}, latch);
     } else {
-      mesh_pub_ = nh_.advertise<voxblox_msgs::Mesh>("active_mesh", 1, true);
+      mesh_pub_ = nh_.advertise<voxblox_msgs::Mesh>(
+          "active_mesh", 1, active_connect_cb, {}, {}, latch);
     }
 
-    mesh_viz_pub_ = nh_.advertise<voxblox_msgs::Mesh>("mesh_viz", 1, true);
+    const ros::SubscriberStatusCallback viz_connect_cb =
+        [this](const ros::SingleSubscriberPublisher&) {
+          mesh_viz_snapshot_requested_ = true;
+        };
+    mesh_viz_pub_ = nh_.advertise<voxblox_msgs::Mesh>(
+        "mesh_viz", 1, viz_connect_cb, {}, {}, true);
+    mesh_resync_sub_ =
+        nh_.subscribe("mesh_resync", 1, &TopologyServer::handleMeshResync, this);
 
     layer_pub_ = nh_.advertise<hydra_msgs::ActiveLayer>("active_layer", 2, false);
+    layer_resync_sub_ = nh_.subscribe(
+        "active_layer_resync", 1, &TopologyServer::handleLayerResync, this);
+    latency_pub_ = nh_.advertise<std_msgs::Float64>("update_latency", 1, false);
+
+    if (!config_.concurrent_update) {
+      update_timer_ =
+          nh_.createTimer(ros::Duration(config_.update_period_s),
+                          [&](const ros::TimerEvent& event) { serialUpdate(event); });
+      return;
+    }
 
-    update_timer_ = nh_.createTimer(
-        ros::Duration(config_.update_period_s),
-        [&](const ros::TimerEvent& event) { runUpdate(event.current_real); });
+    update_thread_ = std::thread(&TopologyServer::updateLoop, this);
+    update_timer_ =
+        nh_.createTimer(ros::Duration(config_.update_period_s),
+                        [&](const ros::TimerEvent& event) { takeSnapshot(event); });
+  }
+
+  ~TopologyServer() {
+    if (!update_thread_.joinable()) {
+      return;
+    }
+
+    {  // start critical section
+      std::unique_lock<std::mutex> lock(update_mutex_);
+      should_shutdown_ = true;
+    }  // end critical section
+
+    update_cv_.notify_all();
+    update_thread_.join();
   }
 
   void spin() const { ros::spin(); }
@@ -113,10 +176,23 @@ class TopologyServer {
     // this intentionally disables marching cubes in the native voxblox server
     nh_.setParam("update_mesh_every_n_sec", 0.0);
     // TODO(nathan) explicit configs
-    tsdf_server_.reset(new TsdfServerType(ros::NodeHandle(), nh_));
-
-    tsdf_layer_ = tsdf_server_->getTsdfMapPtr()->getTsdfLayerPtr();
-    CHECK_NOTNULL(tsdf_layer_);
+    // the public handle shares the callback queue of nh (which may not be the global
+    // queue when the server runs inside another node)
+    ros::NodeHandle public_nh;
+    public_nh.setCallbackQueue(nh_.getCallbackQueue());
+    tsdf_server_.reset(new TsdfServerType(public_nh, nh_));
+
+    live_tsdf_layer_ = tsdf_server_->getTsdfMapPtr()->getTsdfLayerPtr();
+    CHECK_NOTNULL(live_tsdf_layer_);
+
+    if (config_.concurrent_update) {
+      // the GVD only ever sees a copy of the TSDF that the spinner thread refreshes
+      snapshot_tsdf_layer_.reset(new Layer<TsdfVoxel>(
+          live_tsdf_layer_->voxel_size(), live_tsdf_layer_->voxels_per_side()));
+      tsdf_layer_ = snapshot_tsdf_layer_.get();
+    } else {
+      tsdf_layer_ = live_tsdf_layer_;
+    }
 
     gvd_layer_.reset(
         new Layer<GvdVoxel>(tsdf_layer_->voxel_size(), tsdf_layer_->voxels_per_side()));
@@ -124,75 +200,227 @@ class TopologyServer {
 
     gvd_integrator_.reset(
         new GvdIntegrator(gvd_config_, tsdf_layer_, gvd_layer_, mesh_layer_));
+
+    if (config_.coarse_downsample_factor == 0) {
+      return;
+    }
+
+    // the coarse layers keep the same block layout as the fine layers, so a coarse
+    // block covers coarse_downsample_factor^3 fine blocks
+    const size_t vps = tsdf_layer_->voxels_per_side();
+    const double coarse_voxel_size =
+        config_.coarse_downsample_factor * tsdf_layer_->voxel_size();
+    coarse_tsdf_layer_.reset(new Layer<TsdfVoxel>(coarse_voxel_size, vps));
+    coarse_gvd_layer_.reset(new Layer<GvdVoxel>(coarse_voxel_size, vps));
+    coarse_mesh_layer_.reset(new MeshLayer(coarse_tsdf_layer_->block_size()));
+
+    coarse_gvd_integrator_.reset(new GvdIntegrator(coarse_gvd_config_,
+                                                   coarse_tsdf_layer_.get(),
+                                                   coarse_gvd_layer_,
+                                                   coarse_mesh_layer_));
   }
 
-  void setupConfig(const std::string& config_ns) {
-    gvd_config_ = config_parser::load_from_ros<GvdIntegratorConfig>(
-        config_ns, std::make_shared<TopologyParamLogger>());
-    config_ = config_parser::load_from_ros<TopologyServerConfig>(
-        config_ns, std::make_shared<TopologyParamLogger>());
+  void setupConfig() {
+    gvd_config_ = config_parser::load_from_ros_nh<GvdIntegratorConfig>(
+        nh_, "", std::make_shared<TopologyParamLogger>());
+    config_ = config_parser::load_from_ros_nh<TopologyServerConfig>(
+        nh_, "", std::make_shared<TopologyParamLogger>());
+
+    // the coarse config defaults to the fine config scaled to the coarse voxel size;
+    // anything under "coarse" overrides that
+    coarse_gvd_config_ = getCoarseGvdConfig(
+        gvd_config_, std::max<size_t>(config_.coarse_downsample_factor, 1));
+
+    config_parser::RosParser parser(
+        std::make_unique<config_parser::RosParserImpl>(nh_, "coarse"));
+    parser.setLogger(std::make_shared<TopologyParamLogger>());
+    config_parser::ConfigVisitor<GvdIntegratorConfig>::visit_config(parser,
+                                                                   coarse_gvd_config_);
+    // coarse places share the places layer with the fine places
+    coarse_gvd_config_.graph_extractor_config.node_prefix = 'P';
   }
 
-  void publishMesh(const ros::Time& timestamp, const BlockIndexList& archived_blocks) {
-    voxblox_msgs::Mesh mesh_msg;
-    generateVoxbloxMeshMsg(mesh_layer_, config_.mesh_color_mode, &mesh_msg);
-    mesh_msg.header.frame_id = config_.world_frame;
-    mesh_msg.header.stamp = timestamp;
-    mesh_viz_pub_.publish(mesh_msg);
-
-    auto iter = mesh_msg.mesh_blocks.begin();
-    while (iter != mesh_msg.mesh_blocks.end()) {
-      // we can't just check if the message is empty (it's valid for an observed and
-      // active block to be empty), so we have to check if the GVD layer has pruned the
-      // corresponding block yet)
-      BlockIndex idx(iter->index[0], iter->index[1], iter->index[2]);
-      if (!gvd_layer_->hasBlock(idx)) {
-        iter = mesh_msg.mesh_blocks.erase(iter);
+  void addOutput(OutputPipeline::Task task) {
+    if (output_pipeline_) {
+      output_pipeline_->add(std::move(task));
+    } else {
+      task();
+    }
+  }
+
+  //! messages are handed to the output pipeline by value (i.e. as a snapshot)
+  template <typename Msg>
+  void publishOutput(const ros::Publisher& pub, Msg msg) {
+    addOutput([pub, msg = std::move(msg)]() { pub.publish(msg); });
+  }
+
+  void fillMeshMsg(const BlockIndexList& blocks,
+                   const ros::Time& timestamp,
+                   voxblox_msgs::Mesh& msg) const {
+    // mirrors generateVoxbloxMeshMsg, but only for the requested blocks and without
+    // touching the updated flags of the mesh layer
+    msg.header.frame_id = config_.world_frame;
+    msg.header.stamp = timestamp;
+    msg.block_edge_length = mesh_layer_->block_size();
+    msg.mesh_blocks.reserve(msg.mesh_blocks.size() + blocks.size());
+
+    const float point_conv_factor = 2.0f / std::numeric_limits<uint16_t>::max();
+    const float block_size = msg.block_edge_length;
+    for (const auto& idx : blocks) {
+      if (!mesh_layer_->hasMesh(idx)) {
         continue;
       }
 
-      ++iter;
+      voxblox::Mesh::ConstPtr mesh = mesh_layer_->getMeshPtrByIndex(idx);
+      msg.mesh_blocks.emplace_back();
+      voxblox_msgs::MeshBlock& block = msg.mesh_blocks.back();
+      block.index[0] = idx.x();
+      block.index[1] = idx.y();
+      block.index[2] = idx.z();
+
+      const size_t num_vertices = mesh->vertices.size();
+      block.x.reserve(num_vertices);
+      block.y.reserve(num_vertices);
+      block.z.reserve(num_vertices);
+      block.r.reserve(num_vertices);
+      block.g.reserve(num_vertices);
+      block.b.reserve(num_vertices);
+      for (size_t i = 0; i < num_vertices; ++i) {
+        const voxblox::Point normalized =
+            (mesh->vertices[i] - idx.cast<float>() * block_size) / block_size;
+        block.x.push_back(static_cast<uint16_t>(normalized.x() / point_conv_factor));
+        block.y.push_back(static_cast<uint16_t>(normalized.y() / point_conv_factor));
+        block.z.push_back(static_cast<uint16_t>(normalized.z() / point_conv_factor));
+
+        voxblox::Color color;
+        voxblox::getVertexColor(mesh, config_.mesh_color_mode, i, &color);
+        block.r.push_back(color.r);
+        block.g.push_back(color.g);
+        block.b.push_back(color.b);
+      }
+    }
+  }
+
+  void publishMesh(const ros::Time& timestamp, const BlockIndexList& archived_blocks) {
+    // the integrator already dropped the mesh blocks of archived blocks
+    const MeshChangeTracker& changes = gvd_integrator_->getMeshChanges();
+
+    const bool viz_snapshot = mesh_viz_snapshot_requested_.exchange(false);
+    if (viz_snapshot || mesh_viz_pub_.getNumSubscribers() > 0) {
+      voxblox_msgs::Mesh viz_msg;
+      fillMeshMsg(viz_snapshot ? changes.getAllBlocks()
+                               : changes.getUpdatedSince(mesh_viz_generation_),
+                  timestamp,
+                  viz_msg);
+      // empty blocks clear the archived meshes in the visualizer
+      for (const auto& idx : archived_blocks) {
+        voxblox_msgs::MeshBlock block;
+        block.index[0] = idx.x();
+        block.index[1] = idx.y();
+        block.index[2] = idx.z();
+        viz_msg.mesh_blocks.push_back(block);
+      }
+
+      publishOutput(mesh_viz_pub_, std::move(viz_msg));
+    }
+    mesh_viz_generation_ = changes.generation();
+
+    // we can't just check if a block is empty (it's valid for an observed and active
+    // block to be empty), so we have to check if the GVD layer has pruned the
+    // corresponding block yet
+    const bool active_snapshot = active_mesh_snapshot_requested_.exchange(false);
+    BlockIndexList active_blocks;
+    for (const auto& idx : active_snapshot
+                               ? changes.getAllBlocks()
+                               : changes.getUpdatedSince(active_mesh_generation_)) {
+      if (gvd_layer_->hasBlock(idx)) {
+        active_blocks.push_back(idx);
+      }
     }
+    active_mesh_generation_ = changes.generation();
+
+    // messages are published by pointer so that in-process subscribers (i.e. the
+    // frontend when running in the same process) receive them without a copy
+    hydra_msgs::ActiveMesh::Ptr msg(new hydra_msgs::ActiveMesh());
+    fillMeshMsg(active_blocks, timestamp, msg->mesh);
 
     if (!config_.publish_archived) {
-      mesh_pub_.publish(mesh_msg);
+      // aliases the mesh inside the wrapper message instead of copying it
+      voxblox_msgs::Mesh::ConstPtr mesh_ptr(msg, &msg->mesh);
+      publishOutput(mesh_pub_, mesh_ptr);
       return;
     }
 
-    voxblox_msgs::Mesh archived_msg;
     for (const auto& block_idx : archived_blocks) {
       voxblox_msgs::MeshBlock block;
       block.index[0] = block_idx.x();
       block.index[1] = block_idx.y();
       block.index[2] = block_idx.z();
-      archived_msg.mesh_blocks.push_back(block);
+      msg->archived_blocks.mesh_blocks.push_back(block);
     }
 
-    hydra_msgs::ActiveMesh msg;
-    msg.header.stamp = timestamp;
-    msg.mesh = mesh_msg;
-    msg.archived_blocks = archived_msg;
-    mesh_pub_.publish(msg);
+    msg->header.stamp = timestamp;
+    publishOutput(mesh_pub_, msg);
   }
 
-  void publishActiveLayer(const ros::Time& timestamp) const {
-    hydra_msgs::ActiveLayer msg;
-    msg.header.stamp = timestamp;
-    msg.header.frame_id = config_.world_frame;
+  void handleMeshResync(const std_msgs::Empty::ConstPtr&) {
+    VLOG(1) << "[Hydra Topology] full mesh requested";
+    mesh_viz_snapshot_requested_ = true;
+    active_mesh_snapshot_requested_ = true;
+  }
+
+  void publishActiveLayer(const ros::Time& timestamp) {
+    hydra_msgs::ActiveLayer::Ptr msg(new hydra_msgs::ActiveLayer());
+    msg->header.stamp = timestamp;
+    msg->header.frame_id = config_.world_frame;
+    msg->sequence_number = layer_sequence_number_++;
 
     // non-const, as clearDeletedNodes modifies internal state
     GraphExtractor& extractor = gvd_integrator_->getGraphExtractor();
-    std::unordered_set<NodeId> active_nodes = extractor.getActiveNodes();
+    const SceneGraphLayer& graph = extractor.getGraph();
     std::unordered_set<NodeId> removed_nodes = extractor.getDeletedNodes();
     extractor.clearDeletedNodes();
-    msg.layer_contents = extractor.getGraph().serializeLayer(active_nodes);
-    msg.deleted_nodes.insert(
-        msg.deleted_nodes.begin(), removed_nodes.begin(), removed_nodes.end());
-    layer_pub_.publish(msg);
-
-    for (const auto& id : active_nodes) {
-      auto& attr =
-          extractor.getGraph().getNode(id)->get().attributes<PlaceNodeAttributes>();
+
+    const bool periodic_full_update = config_.full_layer_update_every_n > 0 &&
+                                      layer_updates_since_full_ + 1 >=
+                                          config_.full_layer_update_every_n;
+    const bool resync_requested = layer_resync_requested_.exchange(false);
+    msg->full_update =
+        !config_.publish_layer_deltas || periodic_full_update || resync_requested;
+
+    std::unordered_set<NodeId> to_publish;
+    if (msg->full_update) {
+      to_publish = extractor.getActiveNodes();
+      layer_updates_since_full_ = 0;
+    } else {
+      // dirty nodes include nodes archived this update so that their final state
+      // reaches the frontend
+      for (const auto& node_id : extractor.getDirtyNodes()) {
+        if (graph.hasNode(node_id)) {
+          to_publish.insert(node_id);
+        }
+      }
+
+      for (const auto& node_id : extractor.getArchivedNodes()) {
+        msg->archived_nodes.push_back(node_id);
+      }
+
+      ++layer_updates_since_full_;
+    }
+    extractor.clearDirtyNodes();
+
+    if (coarse_gvd_integrator_) {
+      msg->layer_contents = serializeWithCoarsePlaces(to_publish, removed_nodes);
+    } else {
+      msg->layer_contents = graph.serializeLayer(to_publish);
+    }
+
+    msg->deleted_nodes.insert(
+        msg->deleted_nodes.begin(), removed_nodes.begin(), removed_nodes.end());
+    publishOutput(layer_pub_, msg);
+
+    for (const auto& id : to_publish) {
+      const auto& attr = graph.getNode(id)->get().attributes<PlaceNodeAttributes>();
       for (const auto& connection : attr.voxblox_mesh_connections) {
         BlockIndex idx = Eigen::Map<const BlockIndex>(connection.block);
         // mesh api is stupid and logs warnings...
@@ -207,6 +435,234 @@ class TopologyServer {
     }
   }
 
+  void handleLayerResync(const std_msgs::Empty::ConstPtr&) {
+    VLOG(1) << "[Hydra Topology] full active layer requested";
+    layer_resync_requested_ = true;
+  }
+
+  void copyPlace(const SceneGraphLayer& source,
+                 NodeId node_id,
+                 bool clear_mesh_connections,
+                 IsolatedSceneGraphLayer& combined) const {
+    if (combined.hasNode(node_id)) {
+      return;
+    }
+
+    const auto& attrs =
+        source.getNode(node_id)->get().attributes<PlaceNodeAttributes>();
+    PlaceNodeAttributes::Ptr new_attrs(new PlaceNodeAttributes(attrs));
+    if (clear_mesh_connections) {
+      new_attrs->voxblox_mesh_connections.clear();
+    }
+
+    combined.emplaceNode(node_id, std::move(new_attrs));
+  }
+
+  void copyPlaces(const SceneGraphLayer& source,
+                  const std::unordered_set<NodeId>& nodes,
+                  bool clear_mesh_connections,
+                  bool with_outside_siblings,
+                  IsolatedSceneGraphLayer& combined) const {
+    for (const auto& node_id : nodes) {
+      copyPlace(source, node_id, clear_mesh_connections, combined);
+    }
+
+    // siblings outside of the set are copied as endpoints only: they are not
+    // serialized, but the frontend already has them and needs every edge incident
+    // to an updated node
+    for (const auto& node_id : nodes) {
+      for (const auto& sibling : source.getNode(node_id)->get().siblings()) {
+        if (combined.hasEdge(node_id, sibling)) {
+          continue;
+        }
+
+        if (!with_outside_siblings && !nodes.count(sibling)) {
+          continue;
+        }
+
+        copyPlace(source, sibling, clear_mesh_connections, combined);
+        const auto& info = *(source.getEdge(node_id, sibling)->get().info);
+        combined.insertEdge(node_id, sibling, std::make_unique<EdgeAttributes>(info));
+      }
+    }
+  }
+
+  bool overlapsArchivedPlace(const PlaceNodeAttributes& coarse_attrs,
+                             const NearestNodeFinder* archived) const {
+    if (!archived) {
+      return false;
+    }
+
+    bool overlaps = false;
+    archived->find(coarse_attrs.position, 1, false, [&](NodeId, size_t, double dist) {
+      overlaps = std::sqrt(dist) <= coarse_attrs.distance;
+    });
+    return overlaps;
+  }
+
+  //! link a coarse place to the closest fine place with an overlapping free-space
+  //! sphere (if there is one). max_fine_distance is the largest fine place radius
+  void linkCoarsePlace(NodeId coarse_id,
+                       const PlaceNodeAttributes& coarse_attrs,
+                       const NearestNodeFinder& fine_finder,
+                       double max_fine_distance,
+                       IsolatedSceneGraphLayer& combined) const {
+    const SceneGraphLayer& fine_graph = gvd_integrator_->getGraph();
+    NodeId best_id = 0;
+    double best_distance = std::numeric_limits<double>::max();
+
+    // candidates arrive closest first, so the search widens until a candidate
+    // overlaps or no further fine place could reach the coarse sphere
+    size_t num_found = 0;
+    double last_distance = 0.0;
+    auto check_candidate = [&](NodeId node, size_t, double dist) {
+      ++num_found;
+      last_distance = std::sqrt(dist);
+      if (best_distance != std::numeric_limits<double>::max()) {
+        return;
+      }
+
+      const auto& attrs =
+          fine_graph.getNode(node)->get().attributes<PlaceNodeAttributes>();
+      if (last_distance < coarse_attrs.distance + attrs.distance) {
+        best_id = node;
+        best_distance = last_distance;
+      }
+    };
+
+    size_t num_to_find = 4;
+    while (true) {
+      num_found = 0;
+      fine_finder.find(coarse_attrs.position, num_to_find, false, check_candidate);
+      if (best_distance != std::numeric_limits<double>::max()) {
+        break;
+      }
+
+      if (num_found < num_to_find ||
+          last_distance >= coarse_attrs.distance + max_fine_distance) {
+        return;
+      }
+
+      num_to_find *= 2;
+    }
+
+    copyPlace(fine_graph, best_id, false, combined);
+    combined.insertEdge(
+        coarse_id, best_id, std::make_unique<EdgeAttributes>(best_distance));
+  }
+
+  std::string serializeWithCoarsePlaces(const std::unordered_set<NodeId>& fine_nodes,
+                                        std::unordered_set<NodeId>& removed_nodes) {
+    GraphExtractor& coarse_extractor = coarse_gvd_integrator_->getGraphExtractor();
+    const SceneGraphLayer& coarse_graph = coarse_extractor.getGraph();
+    for (const auto& node_id : coarse_extractor.getDeletedNodes()) {
+      if (published_coarse_nodes_.erase(node_id)) {
+        removed_nodes.insert(node_id);
+      }
+    }
+    coarse_extractor.clearDeletedNodes();
+    // coarse places are always published in full (there are few of them)
+    coarse_extractor.clearDirtyNodes();
+
+    // archived fine places stay in the frontend, so coarse places are only published
+    // where the fine places never reached: outside of the dense window and away from
+    // any archived fine place
+    const GraphExtractor& fine_extractor = gvd_integrator_->getGraphExtractor();
+    const SceneGraphLayer& fine_graph = fine_extractor.getGraph();
+    const auto& active_roots = fine_extractor.getNodeRootMap();
+    std::vector<NodeId> fine_ids;
+    std::vector<NodeId> archived_ids;
+    double max_fine_distance = 0.0;
+    for (const auto& id_node_pair : fine_graph.nodes()) {
+      fine_ids.push_back(id_node_pair.first);
+      const auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
+      max_fine_distance = std::max(max_fine_distance, attrs.distance);
+      if (!active_roots.count(id_node_pair.first)) {
+        archived_ids.push_back(id_node_pair.first);
+      }
+    }
+
+    // both indices are built once per message instead of scanning every fine place
+    // for every coarse place
+    std::unique_ptr<NearestNodeFinder> fine_finder;
+    if (!fine_ids.empty()) {
+      fine_finder.reset(new NearestNodeFinder(fine_graph, fine_ids));
+    }
+
+    std::unique_ptr<NearestNodeFinder> archived_finder;
+    if (!archived_ids.empty()) {
+      archived_finder.reset(new NearestNodeFinder(fine_graph, archived_ids));
+    }
+
+    std::unordered_set<NodeId> coarse_nodes;
+    if (has_pose_) {
+      const Eigen::Vector3d robot_pos = robot_position_.cast<double>();
+      const double radius = config_.dense_representation_radius_m;
+      for (const auto& id_node_pair : coarse_graph.nodes()) {
+        const auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
+        if ((attrs.position - robot_pos).norm() <= radius) {
+          continue;
+        }
+
+        if (overlapsArchivedPlace(attrs, archived_finder.get())) {
+          continue;
+        }
+
+        coarse_nodes.insert(id_node_pair.first);
+      }
+    }
+
+    for (const auto& node_id : published_coarse_nodes_) {
+      if (!coarse_nodes.count(node_id)) {
+        removed_nodes.insert(node_id);
+      }
+    }
+    published_coarse_nodes_ = coarse_nodes;
+
+    // coarse mesh connections index into the coarse mesh, which is not published
+    IsolatedSceneGraphLayer combined(DsgLayers::PLACES);
+    copyPlaces(fine_graph, fine_nodes, false, true, combined);
+    // unpublished coarse places were never sent (or were removed), so they can't be
+    // edge endpoints
+    copyPlaces(coarse_graph, coarse_nodes, true, false, combined);
+
+    // both resolutions live in the places layer, so the coarse-to-fine links are
+    // (weighted) sibling edges
+    for (const auto& node_id : coarse_nodes) {
+      if (!fine_finder) {
+        break;  // nothing to link to
+      }
+
+      const auto& attrs =
+          coarse_graph.getNode(node_id)->get().attributes<PlaceNodeAttributes>();
+      linkCoarsePlace(node_id, attrs, *fine_finder, max_fine_distance, combined);
+    }
+
+    std::unordered_set<NodeId> to_serialize = fine_nodes;
+    to_serialize.insert(coarse_nodes.begin(), coarse_nodes.end());
+    return combined.serializeLayer(to_serialize);
+  }
+
+  void updateCoarseLayer() {
+    // downsampling happens every update: fine blocks may be archived before the next
+    // coarse update, and the coarse TSDF keeps its updated flags until then
+    BlockIndexList blocks;
+    tsdf_layer_->getAllUpdatedBlocks(voxblox::Update::kEsdf, &blocks);
+    downsampleTsdfBlocks(*tsdf_layer_, blocks, *coarse_tsdf_layer_);
+
+    ++updates_since_coarse_;
+    if (updates_since_coarse_ < config_.coarse_update_every_n) {
+      return;
+    }
+
+    updates_since_coarse_ = 0;
+    coarse_gvd_integrator_->updateFromTsdfLayer(true);
+    if (config_.clear_distant_blocks && has_pose_) {
+      const double radius = config_.coarse_representation_radius_m;
+      coarse_gvd_integrator_->removeDistantBlocks(robot_position_, radius);
+    }
+  }
+
   void showStats(const ros::Time& timestamp) const {
     LOG(INFO) << "Timings: (stamp: " << timestamp.toNSec() << ")" << std::endl
               << voxblox::timing::Timing::Print();
@@ -218,39 +674,143 @@ class TopologyServer {
         hydra_utils::getHumanReadableMemoryString(mesh_layer_->getMemorySize());
     LOG(INFO) << "Memory used: [TSDF=" << tsdf_memory_str << ", GVD=" << gvd_memory_str
               << ", Mesh= " << mesh_memory_str << "]";
+
+    if (output_pipeline_) {
+      const auto stats = output_pipeline_->getStats();
+      LOG(INFO) << "Outputs: [queued=" << stats.queue_depth
+                << ", max queued=" << stats.max_queue_depth
+                << ", last wait=" << stats.last_wait_s
+                << " s, last publish=" << stats.last_run_s << " s]";
+    }
+
+    if (!coarse_gvd_integrator_) {
+      return;
+    }
+
+    const std::string coarse_tsdf_str =
+        hydra_utils::getHumanReadableMemoryString(coarse_tsdf_layer_->getMemorySize());
+    const std::string coarse_gvd_str =
+        hydra_utils::getHumanReadableMemoryString(coarse_gvd_layer_->getMemorySize());
+    LOG(INFO) << "Coarse memory used: [TSDF=" << coarse_tsdf_str
+              << ", GVD=" << coarse_gvd_str << "]";
   }
 
-  void runUpdate(const ros::Time& timestamp) {
-    if (!tsdf_layer_ || tsdf_layer_->getNumberOfAllocatedBlocks() == 0) {
+  void serialUpdate(const ros::TimerEvent& event) {
+    has_pose_ = tsdf_server_->has_pose;
+    robot_position_ = tsdf_server_->T_G_C_last.getPosition();
+    runUpdate(event.current_real, tsdf_server_->lastPointcloudTime());
+  }
+
+  void takeSnapshot(const ros::TimerEvent& event) {
+    // runs on the spinner thread, so integration can't touch the TSDF while we copy
+    std::unique_lock<std::mutex> lock(update_mutex_);
+    if (update_pending_ || update_running_) {
+      // the live updated flags are left alone, so nothing is lost by skipping
       return;
     }
 
+    for (const auto& idx : blocks_to_remove_) {
+      live_tsdf_layer_->removeBlock(idx);
+    }
+    blocks_to_remove_.clear();
+
+    voxblox::timing::Timer snapshot_timer("topology/snapshot");
+    gvd_integrator_->copyUpdatedTsdfBlocks(*live_tsdf_layer_);
+    snapshot_timer.Stop();
+
+    has_pose_ = tsdf_server_->has_pose;
+    robot_position_ = tsdf_server_->T_G_C_last.getPosition();
+    pending_timestamp_ = event.current_real;
+    pending_pointcloud_time_ = tsdf_server_->lastPointcloudTime();
+    update_pending_ = true;
+    lock.unlock();
+
+    update_cv_.notify_one();
+  }
+
+  void updateLoop() {
+    while (true) {
+      ros::Time timestamp;
+      ros::Time pointcloud_time;
+      {  // start critical section
+        std::unique_lock<std::mutex> lock(update_mutex_);
+        update_cv_.wait(lock, [&] { return update_pending_ || should_shutdown_; });
+        if (should_shutdown_) {
+          return;
+        }
+
+        timestamp = pending_timestamp_;
+        pointcloud_time = pending_pointcloud_time_;
+        update_pending_ = false;
+        update_running_ = true;
+      }  // end critical section
+
+      const BlockIndexList archived = runUpdate(timestamp, pointcloud_time);
+
+      std::unique_lock<std::mutex> lock(update_mutex_);
+      // the live layer belongs to the spinner thread, so it gets pruned there
+      blocks_to_remove_.insert(
+          blocks_to_remove_.end(), archived.begin(), archived.end());
+      update_running_ = false;
+    }
+  }
+
+  BlockIndexList runUpdate(const ros::Time& timestamp,
+                           const ros::Time& pointcloud_time) {
+    if (!tsdf_layer_ || tsdf_layer_->getNumberOfAllocatedBlocks() == 0) {
+      return {};
+    }
+
+    if (coarse_gvd_integrator_) {
+      // has to happen before the fine update clears the updated flags
+      updateCoarseLayer();
+    }
+
+    voxblox::timing::Timer compute_timer("topology/compute");
     gvd_integrator_->updateFromTsdfLayer(true);
 
     BlockIndexList archived_blocks;
-    if (config_.clear_distant_blocks && tsdf_server_->has_pose) {
-      archived_blocks =
-          gvd_integrator_->removeDistantBlocks(tsdf_server_->T_G_C_last.getPosition(),
-                                               config_.dense_representation_radius_m);
-
-      // this needs to be paired with publishMesh (i.e. generateVoxbloxMeshMsg)
-      // to actual remove allocated blocks (instead of getting rid of the contents).
-      // handled through publishMesh
-      mesh_layer_->clearDistantMesh(tsdf_server_->T_G_C_last.getPosition(),
-                                    config_.dense_representation_radius_m);
+    if (config_.clear_distant_blocks && has_pose_) {
+      archived_blocks = gvd_integrator_->removeDistantBlocks(
+          robot_position_, config_.dense_representation_radius_m);
     }
 
     publishMesh(timestamp, archived_blocks);
     publishActiveLayer(timestamp);
 
+    addOutput([pub = latency_pub_, pointcloud_time]() {
+      // time from the newest integrated pointcloud to the outputs being available
+      std_msgs::Float64 latency_msg;
+      latency_msg.data = (ros::Time::now() - pointcloud_time).toSec();
+      pub.publish(latency_msg);
+      VLOG(1) << "[Topology] update latency: " << latency_msg.data << " [s]";
+    });
+
+    compute_timer.Stop();
+
+    // marker construction reads the live gvd and graph, so it stays on this thread
+    // (only publishing is pipelined) and is timed separately from the update
+    voxblox::timing::Timer viz_timer("topology/visualize");
     visualizer_->visualize(gvd_integrator_->getGraphExtractor(),
                            gvd_integrator_->getGraph(),
                            *gvd_layer_,
                            *tsdf_layer_);
+    viz_timer.Stop();
+
+    if (output_pipeline_) {
+      // the outputs for this update are published while the next update computes
+      output_pipeline_->submit();
+      const auto stats = output_pipeline_->getStats();
+      VLOG(1) << "[Topology] output queue depth: " << stats.queue_depth
+              << ", last batch waited " << stats.last_wait_s << " [s] and ran "
+              << stats.last_run_s << " [s]";
+    }
 
     if (config_.show_stats) {
       showStats(timestamp);
     }
+
+    return archived_blocks;
   }
 
  private:
@@ -258,21 +818,63 @@ class TopologyServer {
 
   TopologyServerConfig config_;
   GvdIntegratorConfig gvd_config_;
+  GvdIntegratorConfig coarse_gvd_config_;
 
   std::unique_ptr<TopologyServerVisualizer> visualizer_;
 
   ros::Publisher mesh_viz_pub_;
   ros::Publisher mesh_pub_;
   ros::Publisher layer_pub_;
-
+  ros::Publisher latency_pub_;
+  ros::Subscriber layer_resync_sub_;
+  ros::Subscriber mesh_resync_sub_;
+
+  //! last mesh generation sent to each mesh topic
+  uint64_t mesh_viz_generation_ = 0;
+  uint64_t active_mesh_generation_ = 0;
+  std::atomic<bool> mesh_viz_snapshot_requested_{false};
+  std::atomic<bool> active_mesh_snapshot_requested_{false};
+
+  uint64_t layer_sequence_number_ = 0;
+  size_t layer_updates_since_full_ = 0;
+  //! the first message is always a full update
+  std::atomic<bool> layer_resync_requested_{true};
+
+  //! layer the voxblox server integrates into
+  Layer<TsdfVoxel>* live_tsdf_layer_;
+  //! layer the GVD is computed from (the live layer unless updates are concurrent)
   Layer<TsdfVoxel>* tsdf_layer_;
+  std::unique_ptr<Layer<TsdfVoxel>> snapshot_tsdf_layer_;
   Layer<GvdVoxel>::Ptr gvd_layer_;
   MeshLayer::Ptr mesh_layer_;
 
   std::unique_ptr<TsdfServerType> tsdf_server_;
   std::unique_ptr<GvdIntegrator> gvd_integrator_;
 
+  std::unique_ptr<Layer<TsdfVoxel>> coarse_tsdf_layer_;
+  Layer<GvdVoxel>::Ptr coarse_gvd_layer_;
+  MeshLayer::Ptr coarse_mesh_layer_;
+  std::unique_ptr<GvdIntegrator> coarse_gvd_integrator_;
+  size_t updates_since_coarse_ = 0;
+  std::unordered_set<NodeId> published_coarse_nodes_;
+
+  bool has_pose_ = false;
+  voxblox::Point robot_position_;
+
+  std::thread update_thread_;
+  std::mutex update_mutex_;
+  std::condition_variable update_cv_;
+  bool update_pending_ = false;
+  bool update_running_ = false;
+  bool should_shutdown_ = false;
+  ros::Time pending_timestamp_;
+  ros::Time pending_pointcloud_time_;
+  BlockIndexList blocks_to_remove_;
+
   ros::Timer update_timer_;
+
+  //! declared last so that queued outputs are published before anything is destroyed
+  std::unique_ptr<OutputPipeline> output_pipeline_;
 };
 
 }  // namespace topology
@@ -35,6 +35,7 @@
 #pragma once
 #include "hydra_topology/configs.h"
 #include "hydra_topology/gvd_visualization_utilities.h"
+#include "hydra_topology/output_pipeline.h"
 
 #include <hydra_utils/config.h>
 #include <hydra_utils/visualizer_types.h>
@@ -73,7 +74,9 @@ void visit_config(const Visitor& v, TopologyVisualizerConfig& config) {
 
 class TopologyServerVisualizer {
  public:
-  explicit TopologyServerVisualizer(const std::string& ns);
+  //! markers are published through the pipeline if one is provided
+  explicit TopologyServerVisualizer(const ros::NodeHandle& nh,
+                                    OutputPipeline* pipeline = nullptr);
 
   virtual ~TopologyServerVisualizer() = default;
 
@@ -102,16 +105,29 @@ class TopologyServerVisualizer {
 
   void setupConfigServers();
 
+  template <typename Msg>
+  void publish(const ros::Publisher& pub, Msg msg) const {
+    if (!pipeline_) {
+      pub.publish(msg);
+      return;
+    }
+
+    pipeline_->add([pub, msg = std::move(msg)]() { pub.publish(msg); });
+  }
+
+  //! config_ns is relative to the visualizer namespace
   template <typename Config, typename Callback>
   void startRqtServer(const std::string& config_ns,
                       std::unique_ptr<dynamic_reconfigure::Server<Config>>& server,
                       const Callback& callback) {
-    server.reset(new dynamic_reconfigure::Server<Config>(ros::NodeHandle(config_ns)));
+    ros::NodeHandle config_nh(nh_, config_ns);
+    server.reset(new dynamic_reconfigure::Server<Config>(config_nh));
     server->setCallback(boost::bind(callback, this, _1, _2));
   }
 
  private:
   ros::NodeHandle nh_;
+  OutputPipeline* pipeline_;
 
   ros::Publisher gvd_viz_pub_;
   ros::Publisher graph_viz_pub_;
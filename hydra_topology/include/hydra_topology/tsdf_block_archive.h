@@ -0,0 +1,114 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include "hydra_topology/voxblox_types.h"
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+namespace topology {
+
+/**
+ * @brief Memory-mapped, block-indexed store for TSDF blocks that left the active window
+ *
+ * Each archived block occupies one page-aligned slot of a scratch file. Only the
+ * most recently touched slots stay mapped; older slots are dropped from the process
+ * (the kernel writes them back and reclaims the page cache as needed), so the
+ * resident footprint stays bounded regardless of how many blocks have been archived.
+ */
+class TsdfBlockArchive {
+ public:
+  TsdfBlockArchive(const std::string& path,
+                   size_t voxels_per_side,
+                   size_t max_resident_blocks);
+
+  ~TsdfBlockArchive();
+
+  TsdfBlockArchive(const TsdfBlockArchive& other) = delete;
+
+  TsdfBlockArchive& operator=(const TsdfBlockArchive& other) = delete;
+
+  //! store (or overwrite) the contents of a block
+  void archiveBlock(const BlockIndex& index, const Block<TsdfVoxel>& block);
+
+  bool hasBlock(const BlockIndex& index) const;
+
+  /**
+   * @brief Merge an archived block into a live block and release its slot
+   * @returns false if the block was never archived
+   */
+  bool restoreBlock(const BlockIndex& index, Block<TsdfVoxel>& block);
+
+  size_t numBlocks() const { return slots_.size(); }
+
+  size_t numResidentBlocks() const { return lru_.size(); }
+
+ private:
+  TsdfVoxel* getSlot(size_t slot) const;
+
+  size_t allocateSlot();
+
+  void touchSlot(size_t slot);
+
+  void releaseSlot(size_t slot);
+
+  void evictSlot(size_t slot);
+
+  void resize(size_t num_slots);
+
+  using SlotMap = voxblox::AnyIndexHashMapType<size_t>::type;
+
+  const std::string path_;
+  const size_t num_voxels_;
+  const size_t max_resident_;
+  size_t slot_bytes_;
+
+  int fd_;
+  char* data_;
+  size_t capacity_;
+
+  SlotMap slots_;
+  std::vector<size_t> free_slots_;
+
+  //! resident slots, most recently used first
+  std::list<size_t> lru_;
+  std::unordered_map<size_t, std::list<size_t>::iterator> lru_lookup_;
+};
+
+}  // namespace topology
+}  // namespace hydra
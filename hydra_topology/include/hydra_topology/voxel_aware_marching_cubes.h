@@ -38,18 +38,38 @@
 
 #include <voxblox/mesh/marching_cubes.h>
 
+#include <array>
+
 namespace hydra {
 namespace topology {
 
 using PointMatrix = Eigen::Matrix<FloatingPoint, 3, 8>;
 using SdfMatrix = Eigen::Matrix<FloatingPoint, 8, 1>;
 using EdgeIndexMatrix = Eigen::Matrix<FloatingPoint, 3, 12>;
+using CubeGvdVoxels = std::array<GvdVoxel*, 8>;
+using CubeVoxelMask = std::array<bool, 8>;
+using EdgeStatus = std::array<uint8_t, 12>;
+//! SDF values of the four voxel columns (along z) under a row of cubes
+using SdfColumns = Eigen::Array<FloatingPoint, Eigen::Dynamic, 4>;
+//! whether each voxel of the four columns under a row of cubes is observed
+using ValidColumns = Eigen::Array<int, Eigen::Dynamic, 4>;
 
 void interpolateEdges(const PointMatrix& vertex_coords,
                       const SdfMatrix& vertex_sdf,
                       EdgeIndexMatrix& edge_coords,
-                      std::vector<uint8_t>& edge_status,
-                      const std::vector<GvdVoxel*>& gvd_voxels);
+                      EdgeStatus& edge_status,
+                      const CubeGvdVoxels& gvd_voxels);
+
+/**
+ * @brief Compute the vertex configuration of every cube in a row along z
+ *
+ * The columns are ordered like the first four cube corners, i.e., (x, y), (x + 1, y),
+ * (x + 1, y + 1) and (x, y + 1). Cubes with an unobserved corner get a configuration
+ * of -1.
+ */
+void calculateRowConfigs(const SdfColumns& sdf,
+                         const ValidColumns& valid,
+                         Eigen::ArrayXi& configs);
 
 /**
  * Performs the marching cubes algorithm to generate a mesh layer from a TSDF.
@@ -67,8 +87,8 @@ class VoxelAwareMarchingCubes : voxblox::MarchingCubes {
                        const SdfMatrix& vertex_sdf,
                        VertexIndex* next_index,
                        Mesh* mesh,
-                       const std::vector<GvdVoxel*>& gvd_voxels,
-                       const std::vector<bool>& voxels_in_block);
+                       const CubeGvdVoxels& gvd_voxels,
+                       const CubeVoxelMask& voxels_in_block);
 };
 
 }  // namespace topology
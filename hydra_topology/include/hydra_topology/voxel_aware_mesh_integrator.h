@@ -34,10 +34,14 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include "hydra_topology/gvd_voxel.h"
+#include "hydra_topology/mesh_change_tracker.h"
+#include "hydra_topology/thread_pool.h"
 #include "hydra_topology/voxblox_types.h"
 
 #include <voxblox/mesh/mesh_integrator.h>
 
+#include <memory>
+
 namespace hydra {
 namespace topology {
 
@@ -48,7 +52,8 @@ class VoxelAwareMeshIntegrator : public voxblox::MeshIntegrator<TsdfVoxel> {
   VoxelAwareMeshIntegrator(const voxblox::MeshIntegratorConfig& config,
                            Layer<TsdfVoxel>* sdf_layer,
                            Layer<GvdVoxel>* gvd_layer,
-                           MeshLayer* mesh_layer);
+                           MeshLayer* mesh_layer,
+                           const std::shared_ptr<ThreadPool>& thread_pool = nullptr);
 
   virtual ~VoxelAwareMeshIntegrator() = default;
 
@@ -67,18 +72,23 @@ class VoxelAwareMeshIntegrator : public voxblox::MeshIntegrator<TsdfVoxel> {
                                    VertexIndex* next_mesh_index,
                                    Mesh* mesh) override;
 
-  void processInterior(const BlockIndexList& blocks, ThreadSafeIndex* index_getter);
-
-  void processExterior(const BlockIndexList& blocks, ThreadSafeIndex* index_getter);
-
   void updateBlockInterior(const BlockIndex& block_index);
 
   void updateBlockExterior(const BlockIndex& block_index);
 
-  void launchThreads(const BlockIndexList& blocks, bool interior_pass);
+  /**
+   * @brief Mesh the blocks, starting the exterior of a block as soon as the
+   * interiors of the block and its neighbors in the positive direction are done
+   */
+  void processBlocks(const BlockIndexList& blocks);
+
+  //! generations of the blocks re-meshed by generateMesh
+  inline MeshChangeTracker& getMeshChanges() { return mesh_changes_; }
 
  protected:
   Layer<GvdVoxel>* gvd_layer_;
+  std::shared_ptr<ThreadPool> thread_pool_;
+  MeshChangeTracker mesh_changes_;
 
   Eigen::Matrix<FloatingPoint, 3, 8> cube_coord_offsets_;
 };
@@ -40,6 +40,7 @@ namespace topology {
 using voxblox::Connectivity;
 using Neighborhood26Connected = Neighborhood<Connectivity::kTwentySix>;
 using IndexOffsets26Connected = Neighborhood<Connectivity::kTwentySix>::IndexOffsets;
+using voxblox::IndexElement;
 
 std::bitset<27> convertRowMajorFlags(std::bitset<27> flags_row_major) {
   std::bitset<27> flags_neighborhood{0};
@@ -89,6 +90,65 @@ std::bitset<27> extractNeighborhoodFlags(const Layer<GvdVoxel>& layer,
   return neighbor_values;
 }
 
+BlockNeighborhoodFlags::BlockNeighborhoodFlags(int voxels_per_side)
+    : voxels_per_side_(voxels_per_side),
+      padded_side_(voxels_per_side + 2),
+      padded_area_(padded_side_ * padded_side_),
+      valid_(padded_area_ * padded_side_, 0) {
+  const auto& offsets = Neighborhood26Connected::kOffsets;
+  const int64_t stride_y = padded_side_;
+  const int64_t stride_z = padded_area_;
+  for (int n = 0; n < offsets.cols(); ++n) {
+    linear_offsets_[n] =
+        offsets(0, n) + stride_y * offsets(1, n) + stride_z * offsets(2, n);
+  }
+  linear_offsets_[26] = 0;
+}
+
+void BlockNeighborhoodFlags::fill(const Layer<GvdVoxel>& layer,
+                                  const BlockIndex& block_index,
+                                  uint8_t min_extra_basis) {
+  // block cache follows the same layout as GvdNeighborAccessor (x fastest)
+  std::array<const voxblox::Block<GvdVoxel>*, 27> blocks;
+  for (int dz = -1; dz <= 1; ++dz) {
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        const BlockIndex neighbor = block_index + BlockIndex(dx, dy, dz);
+        const auto block = layer.getBlockPtrByIndex(neighbor);
+        blocks[(dx + 1) + 3 * (dy + 1) + 9 * (dz + 1)] = block.get();
+      }
+    }
+  }
+
+  // per-axis mapping from padded coordinate to (block offset, voxel coordinate)
+  std::vector<int> block_offset(padded_side_);
+  std::vector<IndexElement> local(padded_side_);
+  for (size_t p = 0; p < padded_side_; ++p) {
+    const int v = static_cast<int>(p) - 1;
+    block_offset[p] = v < 0 ? 0 : (v >= voxels_per_side_ ? 2 : 1);
+    local[p] = v < 0 ? v + voxels_per_side_
+                     : (v >= voxels_per_side_ ? v - voxels_per_side_ : v);
+  }
+
+  size_t slab_index = 0;
+  for (size_t z = 0; z < padded_side_; ++z) {
+    for (size_t y = 0; y < padded_side_; ++y) {
+      for (size_t x = 0; x < padded_side_; ++x, ++slab_index) {
+        const auto block =
+            blocks[block_offset[x] + 3 * block_offset[y] + 9 * block_offset[z]];
+        if (!block) {
+          valid_[slab_index] = 0;
+          continue;
+        }
+
+        const VoxelIndex voxel_index(local[x], local[y], local[z]);
+        const GvdVoxel& voxel = block->getVoxelByVoxelIndex(voxel_index);
+        valid_[slab_index] = isValidPoint(&voxel, min_extra_basis);
+      }
+    }
+  }
+}
+
 // by default, a template only passes if all points in the 3x3 cube are voronoi
 GvdCornerTemplate::GvdCornerTemplate() : fg_mask(0x7FFF'FFFF) {
   unused_mask_array = MaskArray{0, 0, 0, 0};
@@ -165,62 +225,82 @@ CornerFinder::CornerFinder() {
                           0b000'000'000'110'100'000'110'100'000,
                           0b000'000'000'011'001'000'011'001'000,
                           0b000'000'000'000'001'011'000'001'011}};
+
+  const std::array<const GvdCornerTemplate*, 6> templates{&negative_x_template,
+                                                          &positive_x_template,
+                                                          &negative_y_template,
+                                                          &positive_y_template,
+                                                          &negative_z_template,
+                                                          &positive_z_template};
+  // a template matches if every flag outside an unused mask agrees with the fg mask
+  const uint32_t all_flags = 0x7FF'FFFF;
+  size_t index = 0;
+  for (const auto corner_template : templates) {
+    const uint32_t fg = static_cast<uint32_t>(corner_template->fg_mask.to_ulong());
+    for (const auto& unused : corner_template->unused_mask_array) {
+      const uint32_t care = ~static_cast<uint32_t>(unused.to_ulong()) & all_flags;
+      care_masks_[index] = care;
+      fg_masks_[index] = fg & care;
+      ++index;
+    }
+  }
 }
 
 // implementation loosely based on: https://gist.github.com/yamamushi/5823518
 voxblox::AlignedVector<GlobalIndex> makeBresenhamLine(const GlobalIndex& start,
                                                       const GlobalIndex& end) {
-  GlobalIndex diff = end - start;
-  GlobalIndex inc(diff(0) < 0 ? -1 : 1, diff(1) < 0 ? -1 : 1, diff(2) < 0 ? -1 : 1);
-
-  diff = diff.array().abs();
-  const GlobalIndex diff_twice = 2 * diff;
-
-  int max_idx;
-  int min_idx_1;
-  int min_idx_2;
-  if (diff(0) >= diff(1) && diff(0) >= diff(2)) {
-    max_idx = 0;
-    min_idx_1 = 1;
-    min_idx_2 = 2;
-  } else if (diff(1) >= diff(0) && diff(1) >= diff(2)) {
-    max_idx = 1;
-    min_idx_1 = 0;
-    min_idx_2 = 2;
-  } else {
-    max_idx = 2;
-    min_idx_1 = 0;
-    min_idx_2 = 1;
+  voxblox::AlignedVector<GlobalIndex> line_points;
+  const int64_t length = (end - start).cwiseAbs().maxCoeff();
+  if (length <= 1) {
+    return line_points;
   }
 
-  if (diff(max_idx) <= 1) {
-    return voxblox::AlignedVector<GlobalIndex>();
-  }
-
-  voxblox::AlignedVector<GlobalIndex> line_points(diff(max_idx) - 1);
-  GlobalIndex point = start;
+  line_points.reserve(length - 1);
+  walkBresenhamLine(start, end, [&](const GlobalIndex& index) {
+    line_points.push_back(index);
+    return true;
+  });
+  return line_points;
+}
 
-  int64_t err_1 = diff_twice(min_idx_1) - diff(max_idx);
-  int64_t err_2 = diff_twice(min_idx_2) - diff(max_idx);
-  for (int64_t i = 0; i < diff(max_idx); ++i) {
-    if (i > 0) {
-      line_points[i - 1] = point;
-    }
+LineClearance checkLineClearance(const Layer<GvdVoxel>& layer,
+                                 const GlobalIndex& start,
+                                 const GlobalIndex& end,
+                                 double min_clearance) {
+  LineClearance result;
+  result.clear = walkLayerLine(
+      layer, start, end, [&](const GlobalIndex&, const GvdVoxel* voxel) {
+        if (!voxel) {
+          return false;
+        }
+
+        ++result.num_voxels;
+        result.min_distance = std::min<double>(result.min_distance, voxel->distance);
+        return voxel->observed && voxel->distance > min_clearance;
+      });
+  return result;
+}
 
-    if (err_1 > 0) {
-      point(min_idx_1) += inc(min_idx_1);
-      err_1 -= diff_twice(max_idx);
+void checkLineClearances(const Layer<GvdVoxel>& layer,
+                         const voxblox::AlignedVector<LineSegment>& segments,
+                         double min_clearance,
+                         std::vector<LineClearance>& results,
+                         ThreadPool* thread_pool) {
+  results.resize(segments.size());
+  auto check_segment = [&](size_t i) {
+    results[i] =
+        checkLineClearance(layer, segments[i].first, segments[i].second, min_clearance);
+  };
+
+  if (!thread_pool || thread_pool->numThreads() <= 1) {
+    for (size_t i = 0; i < segments.size(); ++i) {
+      check_segment(i);
     }
-    if (err_2 > 0) {
-      point(min_idx_2) += inc(min_idx_2);
-      err_2 -= diff_twice(max_idx);
-    }
-    err_1 += diff_twice(min_idx_1);
-    err_2 += diff_twice(min_idx_2);
-    point[max_idx] += inc(max_idx);
+    return;
   }
 
-  return line_points;
+  // a single line walk is too cheap to be worth a task of its own
+  thread_pool->parallelFor(segments.size(), check_segment, 64);
 }
 
 // TODO(nathan) consider removing
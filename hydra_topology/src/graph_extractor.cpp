@@ -33,7 +33,6 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #include "hydra_topology/graph_extractor.h"
-#include "hydra_topology/nearest_neighbor_utilities.h"
 
 namespace hydra {
 namespace topology {
@@ -61,9 +60,11 @@ std::ostream& operator<<(std::ostream& out, const EdgeInfo& info) {
   return out;
 }
 
-GraphExtractor::GraphExtractor(const GraphExtractorConfig& config)
+GraphExtractor::GraphExtractor(const GraphExtractorConfig& config,
+                               const std::shared_ptr<ThreadPool>& thread_pool)
     : config_(config),
-      next_node_id_('p', 0),
+      thread_pool_(thread_pool),
+      next_node_id_(config.node_prefix, 0),
       next_edge_id_(0),
       next_pseudo_edge_id_(0),
       graph_(new IsolatedSceneGraphLayer(DsgLayers::PLACES)) {}
@@ -82,6 +83,11 @@ std::unordered_set<NodeId> GraphExtractor::getDeletedNodes() const {
 
 void GraphExtractor::clearDeletedNodes() { deleted_nodes_.clear(); }
 
+void GraphExtractor::clearDirtyNodes() {
+  dirty_nodes_.clear();
+  archived_nodes_.clear();
+}
+
 void GraphExtractor::clearGvdIndex(const GlobalIndex& index) {
   const auto& info_iter = index_graph_info_map_.find(index);
   if (info_iter == index_graph_info_map_.end()) {
@@ -146,14 +152,19 @@ void GraphExtractor::clearEdgeInfo(size_t edge_id, bool clear_indices) {
     visited_nodes_.insert(info.source);
 
     for (size_t other_edge_id : info.connections) {
-      visited_nodes_.insert(edge_info_map_.at(other_edge_id).source);
-      graph_->removeEdge(info.source, edge_info_map_.at(other_edge_id).source);
+      const NodeId other_source = edge_info_map_.at(other_edge_id).source;
+      visited_nodes_.insert(other_source);
+      if (graph_->removeEdge(info.source, other_source)) {
+        markEdgeDirty(info.source, other_source);
+      }
       edge_info_map_.at(other_edge_id).connections.erase(edge_id);
     }
 
     for (NodeId node_id : info.node_connections) {
       visited_nodes_.insert(node_id);
-      graph_->removeEdge(info.source, node_id);
+      if (graph_->removeEdge(info.source, node_id)) {
+        markEdgeDirty(info.source, node_id);
+      }
       node_edge_connections_.at(node_id).erase(edge_id);
     }
 
@@ -179,7 +190,7 @@ void GraphExtractor::clearPseudoEdgeInfo(const GlobalIndex& root_index) {
     return;
   }
 
-  std::unordered_set<size_t> edges_to_erase = info_iter->second;
+  const EdgeIdSet edges_to_erase = info_iter->second;
   for (const auto edge_id : edges_to_erase) {
     const PseudoEdgeInfo& edge_info = pseudo_edge_info_.at(edge_id);
 
@@ -215,6 +226,7 @@ void GraphExtractor::removeDistantIndex(const GlobalIndex& index) {
 }
 
 void GraphExtractor::removeNodeIndex(NodeId node_id) {
+  archived_nodes_.insert(node_id);
   index_graph_info_map_.erase(node_id_root_map_.at(node_id));
   node_id_root_map_.erase(node_id);
 
@@ -301,12 +313,13 @@ void GraphExtractor::addPlaceToGraph(const GvdLayer& layer,
   attributes->color = decltype(attributes->color)::Zero();
 
   index_graph_info_map_.emplace(index, VoxelGraphInfo(next_node_id_, is_from_split));
-  node_id_index_map_[next_node_id_] = voxblox::LongIndexSet();
+  node_id_index_map_[next_node_id_] = GlobalIndexSet();
   node_id_root_map_[next_node_id_] = index;
-  node_edge_id_map_[next_node_id_] = std::set<size_t>();
-  node_edge_connections_[next_node_id_] = std::set<size_t>();
+  node_edge_id_map_[next_node_id_] = EdgeIdSet();
+  node_edge_connections_[next_node_id_] = EdgeIdSet();
 
   graph_->emplaceNode(next_node_id_, std::move(attributes));
+  dirty_nodes_.insert(next_node_id_);
   next_node_id_++;
 }
 
@@ -339,25 +352,17 @@ EdgeAttributes::Ptr GraphExtractor::makeEdgeInfo(const GvdLayer& layer,
 
   double min_weight = std::min(source_dist, target_dist);
 
-  const GlobalIndex source = node_id_root_map_.at(source_id);
-  const GlobalIndex target = node_id_root_map_.at(target_id);
-  GlobalIndexVector path = makeBresenhamLine(source, target);
-  if (path.empty()) {
-    // edge is smaller than voxel size, so we just take the min distance between two
-    // voxels
-    return std::make_unique<EdgeAttributes>(min_weight);
-  }
-
-  for (const auto& index : path) {
-    const GvdVoxel* voxel = layer.getVoxelPtrByGlobalIndex(index);
-    if (!voxel) {
-      continue;
-    }
-
-    if (voxel->distance < min_weight) {
-      min_weight = voxel->distance;
-    }
-  }
+  // edges smaller than the voxel size have no interior voxels, so they just take the
+  // min distance between the two voxels
+  walkLayerLine(layer,
+                node_id_root_map_.at(source_id),
+                node_id_root_map_.at(target_id),
+                [&](const GlobalIndex&, const GvdVoxel* voxel) {
+                  if (voxel && voxel->distance < min_weight) {
+                    min_weight = voxel->distance;
+                  }
+                  return true;
+                });
 
   return std::make_unique<EdgeAttributes>(min_weight);
 }
@@ -368,9 +373,11 @@ void GraphExtractor::addEdgeToGraph(const GvdLayer& layer,
   if (curr_info.is_node && neighbor_info.is_node) {
     // this case can happen (potentially frequently) if the basis count is noisy
     // ideally adjacent vertices get clustered downstream and pruned
-    graph_->insertEdge(curr_info.id,
-                       neighbor_info.id,
-                       makeEdgeInfo(layer, curr_info.id, neighbor_info.id));
+    if (graph_->insertEdge(curr_info.id,
+                           neighbor_info.id,
+                           makeEdgeInfo(layer, curr_info.id, neighbor_info.id))) {
+      markEdgeDirty(curr_info.id, neighbor_info.id);
+    }
     return;
   }
 
@@ -381,9 +388,11 @@ void GraphExtractor::addEdgeToGraph(const GvdLayer& layer,
   // TODO(nathan) check if we really need symmetric lookup
   updateEdgeMaps(neighbor_info, curr_info);
 
-  graph_->insertEdge(curr_info.id,
-                     neighbor_info.id,
-                     makeEdgeInfo(layer, curr_info.id, neighbor_info.id));
+  if (graph_->insertEdge(curr_info.id,
+                         neighbor_info.id,
+                         makeEdgeInfo(layer, curr_info.id, neighbor_info.id))) {
+    markEdgeDirty(curr_info.id, neighbor_info.id);
+  }
 
   if (!curr_info.is_node) {
     connected_edges_.insert(curr_info.edge_id);
@@ -394,14 +403,16 @@ void GraphExtractor::addEdgeToGraph(const GvdLayer& layer,
   }
 }
 
-void GraphExtractor::findBadEdgeIndices(const EdgeInfo& info) {
+void GraphExtractor::findBadEdgeIndices(const EdgeInfo& info, SplitSeeds& seeds) const {
   const GlobalIndex start = node_id_root_map_.at(info.source);
   voxblox::AlignedVector<GlobalIndex> indices(info.indices.begin(), info.indices.end());
 
-  checked_edges_[info.id] = info.connections;
   for (auto other_edge : info.connections) {
-    if (checked_edges_.count(other_edge) &&
-        checked_edges_.at(other_edge).count(info.id)) {
+    // connected edges are checked in increasing order, so a lower id that also lists
+    // this edge has already looked at the pair
+    if (other_edge < info.id && connected_edges_.count(other_edge) &&
+        edge_info_map_.count(other_edge) &&
+        edge_info_map_.at(other_edge).connections.count(info.id)) {
       continue;  // we've seen this before from the other direction
     }
 
@@ -417,7 +428,7 @@ void GraphExtractor::findBadEdgeIndices(const EdgeInfo& info) {
         findFurthestIndexFromLine(curr_indices, start, end, indices.size());
 
     if (result.distance > config_.max_edge_deviation && result.valid) {
-      edge_split_queue_.emplace(
+      seeds.emplace_back(
           result.index, result.distance, result.from_source ? info.id : other_edge);
     }
   }
@@ -427,61 +438,149 @@ void GraphExtractor::findBadEdgeIndices(const EdgeInfo& info) {
     FurthestIndexResult result = findFurthestIndexFromLine(indices, start, end);
 
     if (result.distance > config_.max_edge_deviation && result.valid) {
-      edge_split_queue_.emplace(result.index, result.distance, info.id);
+      seeds.emplace_back(result.index, result.distance, info.id);
     }
   }
 }
 
-void GraphExtractor::findNewVertices(const GvdLayer& layer) {
-  voxblox::LongIndexSet seen_nodes;
+void GraphExtractor::findSplitCandidates() {
+  std::vector<const EdgeInfo*> edges;
+  for (size_t edge_id : connected_edges_) {
+    const auto iter = edge_info_map_.find(edge_id);
+    if (iter == edge_info_map_.end()) {
+      LOG(WARNING) << "[Graph Extractor] edge " << edge_id << "does not exists";
+      continue;
+    }
+    edges.push_back(&iter->second);
+  }
 
-  while (!modified_voxel_queue_.empty()) {
-    const GlobalIndex index = popFromModifiedGvd();
+  // the search only reads the edge bookkeeping, so every edge can run independently
+  std::vector<SplitSeeds> seeds(edges.size());
+  const auto find_seeds = [&](size_t i) { findBadEdgeIndices(*edges[i], seeds[i]); };
+  if (thread_pool_ && thread_pool_->numThreads() > 1) {
+    thread_pool_->parallelFor(edges.size(), find_seeds, 8);
+  } else {
+    for (size_t i = 0; i < edges.size(); ++i) {
+      find_seeds(i);
+    }
+  }
 
-    if (seen_nodes.count(index)) {
-      continue;
+  // merged in edge order so that ties in the queue break the same way as serially
+  for (const auto& edge_seeds : seeds) {
+    for (const auto& seed : edge_seeds) {
+      edge_split_queue_.push(seed);
     }
+  }
+}
 
-    seen_nodes.insert(index);
+void GraphExtractor::classifyVertices(
+    const GvdLayer& layer,
+    const voxblox::AlignedVector<GlobalIndex>& indices,
+    std::vector<bool>& is_vertex) {
+  // filling a block slab costs about as much as (vps + 2)^3 / 27 individual lookups,
+  // so sparsely touched blocks fall back to per-voxel extraction
+  const int vps = layer.voxels_per_side();
+  const size_t min_slab_voxels = (vps + 2) * (vps + 2) * (vps + 2) / 27;
+
+  voxblox::AnyIndexHashMapType<std::vector<size_t>>::type block_entries;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    const BlockIndex block_index =
+        voxblox::getBlockIndexFromGlobalVoxelIndex(indices[i], 1.0 / vps);
+    block_entries[block_index].push_back(i);
+  }
 
-    const auto& info_iter = index_graph_info_map_.find(index);
-    if (info_iter != index_graph_info_map_.end() && info_iter->second.is_node &&
-        info_iter->second.is_split_node) {
-      // we don't check the vertex condition for nodes that were from edge
-      // splits to reduce thrashing
-      floodfill_frontier_.push(index);
-      continue;
+  is_vertex.assign(indices.size(), false);
+  BlockNeighborhoodFlags slab(vps);
+  for (const auto& block_entry_pair : block_entries) {
+    const auto block = layer.getBlockPtrByIndex(block_entry_pair.first);
+    if (!block) {
+      continue;  // reported when the index is processed
     }
 
-    // TODO(nathan) slightly duplicated with neighbor flag extraction
-    const GvdVoxel* voxel = layer.getVoxelPtrByGlobalIndex(index);
-    if (voxel == nullptr) {
-      VLOG(1) << "[Graph Extraction] Invalid index: " << index.transpose()
-              << " found in modified queue";
-      continue;
+    const auto& entries = block_entry_pair.second;
+    const bool use_slab = entries.size() >= min_slab_voxels;
+    if (use_slab) {
+      slab.fill(layer, block_entry_pair.first, config_.min_extra_basis);
     }
 
-    if (!isVertex(layer, *voxel, index)) {
-      if (info_iter != index_graph_info_map_.end() && info_iter->second.is_node) {
-        // node no longer matches criteria
-        clearNodeInfo(info_iter->second.id);
+    for (const size_t i : entries) {
+      const VoxelIndex voxel_index =
+          voxblox::getLocalFromGlobalVoxelIndex(indices[i], vps);
+      const GvdVoxel& voxel = block->getVoxelByVoxelIndex(voxel_index);
+      if (!use_slab) {
+        is_vertex[i] = isVertex(layer, voxel, indices[i]);
+        continue;
       }
-      continue;
+
+      is_vertex[i] = voxel.num_extra_basis >= config_.min_vertex_basis ||
+                     corner_finder_.match(slab.getFlags(voxel_index));
     }
+  }
+}
 
-    if (info_iter != index_graph_info_map_.end()) {
-      if (info_iter->second.is_node) {
-        continue;  // don't try to do anything with a valid previous vertex
-      }
-      // we just found a vertex, but we had an edge previously, so throw out the
-      // previous edge
-      clearEdgeInfo(info_iter->second.edge_id);
+void GraphExtractor::findNewVertices(const GvdLayer& layer) {
+  voxblox::LongIndexSet seen_nodes;
+
+  voxblox::AlignedVector<GlobalIndex> round;
+  std::vector<bool> round_is_vertex;
+  while (!modified_voxel_queue_.empty()) {
+    // classification only reads the layer, so the queue is drained in rounds and
+    // each round is classified block by block up front. Indices pushed while
+    // processing a round (from clearing nodes) are handled in the next round, which
+    // preserves the original queue order.
+    round.clear();
+    while (!modified_voxel_queue_.empty()) {
+      round.push_back(popFromModifiedGvd());
     }
 
-    floodfill_frontier_.push(index);
-    // we use addPlaceToGraph for edge-splitting, so we need to grab the right node id
-    // outside of addPlacetoGraph
-    addPlaceToGraph(layer, *voxel, index);
+    classifyVertices(layer, round, round_is_vertex);
+
+    for (size_t i = 0; i < round.size(); ++i) {
+      const GlobalIndex& index = round[i];
+      if (seen_nodes.count(index)) {
+        continue;
+      }
+
+      seen_nodes.insert(index);
+
+      const auto& info_iter = index_graph_info_map_.find(index);
+      if (info_iter != index_graph_info_map_.end() && info_iter->second.is_node &&
+          info_iter->second.is_split_node) {
+        // we don't check the vertex condition for nodes that were from edge
+        // splits to reduce thrashing
+        floodfill_frontier_.push(index);
+        continue;
+      }
+
+      const GvdVoxel* voxel = layer.getVoxelPtrByGlobalIndex(index);
+      if (voxel == nullptr) {
+        VLOG(1) << "[Graph Extraction] Invalid index: " << index.transpose()
+                << " found in modified queue";
+        continue;
+      }
+
+      if (!round_is_vertex[i]) {
+        if (info_iter != index_graph_info_map_.end() && info_iter->second.is_node) {
+          // node no longer matches criteria
+          clearNodeInfo(info_iter->second.id);
+        }
+        continue;
+      }
+
+      if (info_iter != index_graph_info_map_.end()) {
+        if (info_iter->second.is_node) {
+          continue;  // don't try to do anything with a valid previous vertex
+        }
+        // we just found a vertex, but we had an edge previously, so throw out the
+        // previous edge
+        clearEdgeInfo(info_iter->second.edge_id);
+      }
+
+      floodfill_frontier_.push(index);
+      // we use addPlaceToGraph for edge-splitting, so we need to grab the right node
+      // id outside of addPlacetoGraph
+      addPlaceToGraph(layer, *voxel, index);
+    }
   }
 }
 
@@ -580,13 +679,7 @@ void GraphExtractor::splitEdges(const GvdLayer& layer) {
   bool reached_max_iters = true;
   for (size_t iter = 0; iter < config_.max_edge_split_iterations; ++iter) {
     // identify best edge split candidates
-    for (size_t edge_id : connected_edges_) {
-      if (!edge_info_map_.count(edge_id)) {
-        LOG(WARNING) << "[Graph Extractor] edge " << edge_id << "does not exists";
-        continue;
-      }
-      findBadEdgeIndices(edge_info_map_.at(edge_id));
-    }
+    findSplitCandidates();
 
     clearNewConnections(false);  // clear new edges that we processed
 
@@ -652,18 +745,27 @@ void GraphExtractor::findFreespaceEdges() {
   std::unordered_set<NodeId> active_neighborhood =
       graph_->getNeighborhood(root_nodes, config_.freespace_active_neighborhood_hops);
 
-  NearestNodeFinder node_finder(*graph_, active_neighborhood);
-  // kdtree will return the query node first
+  // the neighborhood changes incrementally between updates, so the index is kept
+  // between calls and only updated for nodes that entered, left or moved
+  freespace_node_finder_.update(*graph_, active_neighborhood);
+  // finder will return the query node first
   const size_t num_to_find = config_.freespace_edge_num_neighbors + 1;
 
   for (const auto node : active_neighborhood) {
-    node_finder.find(
+    freespace_node_finder_.find(
         graph_->getPosition(node),
         num_to_find,
         true,
         [&](NodeId neighbor, size_t, double) {
+          if (graph_->hasEdge(node, neighbor)) {
+            return;
+          }
+
           addFreespaceEdge(
               *graph_, node, neighbor, config_.freespace_edge_min_clearance_m);
+          if (graph_->hasEdge(node, neighbor)) {
+            markEdgeDirty(node, neighbor);
+          }
         });
   }
 }
@@ -698,22 +800,19 @@ Components GraphExtractor::filterComponents(const Components& to_filter) const {
   return to_return;
 }
 
-bool GraphExtractor::addPseudoEdge(const GvdLayer& layer,
-                                   NodeId node,
-                                   NodeId other_node) {
+bool GraphExtractor::addPseudoEdge(NodeId node,
+                                   NodeId other_node,
+                                   const LineClearance& clearance) {
   // TODO(nathan) remove when sure code is working
   CHECK(node_id_root_map_.count(node));
   CHECK(node_id_root_map_.count(other_node));
-  const GlobalIndex source = node_id_root_map_[node];
-  const GlobalIndex target = node_id_root_map_[other_node];
 
   if (graph_->hasEdge(node, other_node)) {
     return false;
   }
 
   // TODO(nathan) projective edge finding
-  GlobalIndexVector path = makeBresenhamLine(source, target);
-  if (path.empty()) {
+  if (!clearance.clear || clearance.num_voxels == 0) {
     return false;
   }
 
@@ -721,30 +820,15 @@ bool GraphExtractor::addPseudoEdge(const GvdLayer& layer,
       graph_->getNode(node)->get().attributes<PlaceNodeAttributes>().distance;
   const double target_dist =
       graph_->getNode(other_node)->get().attributes<PlaceNodeAttributes>().distance;
-  double min_weight = std::min(source_dist, target_dist);
-
-  bool valid_path = true;
-  for (const auto& index : path) {
-    const GvdVoxel* voxel = layer.getVoxelPtrByGlobalIndex(index);
-    if (!voxel) {
-      return false;  // avoid adding edges along removed voxels
-    }
-
-    if (voxel->distance < min_weight) {
-      min_weight = voxel->distance;
-    }
-
-    if (voxel->distance <= config_.component_min_clearance_m || !voxel->observed) {
-      valid_path = false;
-      break;
-    }
-  }
-
-  if (!valid_path) {
-    return false;
-  }
+  const double min_weight =
+      std::min({source_dist, target_dist, clearance.min_distance});
 
   graph_->insertEdge(node, other_node, std::make_unique<EdgeAttributes>(min_weight));
+  markEdgeDirty(node, other_node);
+
+  // the line only needs to be materialized for edges that are kept
+  const GlobalIndexVector path =
+      makeBresenhamLine(node_id_root_map_[node], node_id_root_map_[other_node]);
 
   // no split nodes yet
   PseudoEdgeInfo info;
@@ -752,9 +836,6 @@ bool GraphExtractor::addPseudoEdge(const GvdLayer& layer,
   pseudo_edge_info_[next_pseudo_edge_id_] = info;
 
   for (const auto& index : path) {
-    if (!pseudo_edge_map_.count(index)) {
-      pseudo_edge_map_[index] = std::unordered_set<size_t>();
-    }
     pseudo_edge_map_[index].insert(next_pseudo_edge_id_);
   }
 
@@ -782,37 +863,60 @@ void GraphExtractor::findComponentConnections(const GvdLayer& layer) {
     return;  // nothing to do
   }
 
-  std::vector<NodeId> largest_component = filtered_components.front();
+  IncrementalNodeFinder node_finder;
+  for (const auto node : filtered_components.front()) {
+    node_finder.insert(node, graph_->getPosition(node));
+  }
 
   for (size_t i = 1; i < filtered_components.size(); ++i) {
-    // TODO(nathan) this is potentially expensive (rebuilds the KD tree index every
-    // time)
-    NearestNodeFinder node_finder(*graph_, largest_component);
-
     const auto& component = filtered_components[i];
     const size_t num_to_check = component.size() < config_.component_nodes_to_check
                                     ? component.size()
                                     : config_.component_nodes_to_check;
 
-    bool inserted_edge = false;
+    Eigen::Matrix3Xd positions(3, num_to_check);
     for (size_t j = 0; j < num_to_check; ++j) {
-      const NodeId node = component[j];
-      const Eigen::Vector3d pos = graph_->getPosition(node);
-      node_finder.find(pos,
-                       config_.component_nearest_neighbors,
-                       false,
-                       [&](NodeId other_node, size_t, double distance) {
-                         if (distance > config_.component_max_edge_length_m) {
-                           return;
-                         }
-                         inserted_edge |= addPseudoEdge(layer, node, other_node);
-                       });
+      positions.col(j) = graph_->getPosition(component[j]);
+    }
+
+    // candidates are gathered first so that their clearance can be checked in one
+    // batch (in parallel if possible) and then inserted in the original order
+    std::vector<std::pair<NodeId, NodeId>> candidates;
+    voxblox::AlignedVector<LineSegment> segments;
+    node_finder.findMany(
+        positions,
+        config_.component_nearest_neighbors,
+        false,
+        [&](size_t j, NodeId other_node, size_t, double distance) {
+          const NodeId node = component[j];
+          if (distance > config_.component_max_edge_length_m ||
+              graph_->hasEdge(node, other_node)) {
+            return;
+          }
+
+          candidates.emplace_back(node, other_node);
+          segments.emplace_back(node_id_root_map_.at(node),
+                                node_id_root_map_.at(other_node));
+        });
+
+    std::vector<LineClearance> clearances;
+    checkLineClearances(layer,
+                        segments,
+                        config_.component_min_clearance_m,
+                        clearances,
+                        thread_pool_.get());
+
+    bool inserted_edge = false;
+    for (size_t j = 0; j < candidates.size(); ++j) {
+      inserted_edge |=
+          addPseudoEdge(candidates[j].first, candidates[j].second, clearances[j]);
     }
 
     if (inserted_edge) {
       // merge components if an edge was inserted
-      largest_component.insert(
-          largest_component.end(), component.begin(), component.end());
+      for (const auto node : component) {
+        node_finder.insert(node, graph_->getPosition(node));
+      }
     }
   }
 }
@@ -896,40 +1000,60 @@ void GraphExtractor::extract(const GvdLayer& layer) {
   CHECK_EQ(num_valid, num_total) << num_valid << " / " << num_total;
 }
 
+namespace {
+
+inline bool sameConnection(const NearestVertexInfo& lhs, const NearestVertexInfo& rhs) {
+  return std::memcmp(lhs.block, rhs.block, sizeof(lhs.block)) == 0 &&
+         std::memcmp(lhs.voxel_pos, rhs.voxel_pos, sizeof(lhs.voxel_pos)) == 0 &&
+         lhs.vertex == rhs.vertex;
+}
+
+template <typename Connections>
+bool sameMeshConnections(const Connections& lhs, const Connections& rhs) {
+  return lhs.size() == rhs.size() &&
+         std::equal(lhs.begin(), lhs.end(), rhs.begin(), sameConnection);
+}
+
+}  // namespace
+
 void GraphExtractor::assignMeshVertices(const GvdLayer& gvd,
-                                        const GvdParentMap& parents,
-                                        const GvdVertexMap& parent_vertices) {
+                                        const GvdBasisStore& basis_store) {
   for (const auto& id_index_pair : node_id_root_map_) {
     const NodeId node_id = id_index_pair.first;
     const GlobalIndex& node_index = id_index_pair.second;
 
     auto& attrs = graph_->getNode(node_id)->get().attributes<PlaceNodeAttributes>();
-    attrs.voxblox_mesh_connections.clear();
+    decltype(attrs.voxblox_mesh_connections) connections;
 
     const GvdVoxel* voxel = CHECK_NOTNULL(gvd.getVoxelPtrByGlobalIndex(node_index));
-    const GlobalIndex curr_parent = Eigen::Map<const GlobalIndex>(voxel->parent);
-    auto iter = parent_vertices.find(curr_parent);
-    if (iter != parent_vertices.end()) {
-      const auto& parent_info = iter->second;
+    const GlobalIndex curr_parent = getParentIndex(*voxel);
+    const GvdVertexInfo* curr_info = basis_store.getVertex(curr_parent);
+    if (curr_info) {
       NearestVertexInfo info;
-      std::memcpy(info.block, parent_info.block, sizeof(info.block));
-      std::memcpy(info.voxel_pos, parent_info.pos, sizeof(info.voxel_pos));
-      info.vertex = parent_info.vertex;
-      attrs.voxblox_mesh_connections.push_back(info);
+      std::memcpy(info.block, curr_info->block, sizeof(info.block));
+      std::memcpy(info.voxel_pos, curr_info->pos, sizeof(info.voxel_pos));
+      info.vertex = curr_info->vertex;
+      connections.push_back(info);
     }
 
-    CHECK(parents.count(node_index));
-    for (const auto& parent : parents.at(node_index)) {
-      if (!parent_vertices.count(parent)) {
+    const GvdBasis* basis = CHECK_NOTNULL(basis_store.getBasis(node_index));
+    for (size_t i = 0; i < basis->num_parents; ++i) {
+      const GvdVertexInfo* parent_info = basis_store.getVertex(basis->getParent(i));
+      if (!parent_info) {
         continue;
       }
 
-      const auto& parent_info = parent_vertices.at(parent);
       NearestVertexInfo info;
-      std::memcpy(info.block, parent_info.block, sizeof(info.block));
-      std::memcpy(info.voxel_pos, parent_info.pos, sizeof(info.voxel_pos));
-      info.vertex = parent_info.vertex;
-      attrs.voxblox_mesh_connections.push_back(info);
+      std::memcpy(info.block, parent_info->block, sizeof(info.block));
+      std::memcpy(info.voxel_pos, parent_info->pos, sizeof(info.voxel_pos));
+      info.vertex = parent_info->vertex;
+      connections.push_back(info);
+    }
+
+    // most nodes keep the same connections, so only actual changes are dirty
+    if (!sameMeshConnections(connections, attrs.voxblox_mesh_connections)) {
+      attrs.voxblox_mesh_connections = std::move(connections);
+      dirty_nodes_.insert(node_id);
     }
   }
 }
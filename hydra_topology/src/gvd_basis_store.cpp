@@ -0,0 +1,264 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/gvd_basis_store.h"
+
+namespace hydra {
+namespace topology {
+
+GvdBasisStore::BlockEntries::BlockEntries(size_t num_voxels)
+    : basis_slots(num_voxels, kInvalidSlot), vertex_slots(num_voxels, kInvalidSlot) {}
+
+GvdBasisStore::GvdBasisStore(int voxels_per_side)
+    : voxels_per_side_(voxels_per_side),
+      num_voxels_(voxels_per_side * voxels_per_side * voxels_per_side) {}
+
+BlockIndex GvdBasisStore::getBlockIndex(const GlobalIndex& index,
+                                        size_t& linear_index) const {
+  BlockIndex block_index;
+  VoxelIndex voxel_index;
+  voxblox::getBlockAndVoxelIndexFromGlobalVoxelIndex(
+      index, voxels_per_side_, &block_index, &voxel_index);
+  linear_index = voxel_index.x() +
+                 voxels_per_side_ * (voxel_index.y() + voxels_per_side_ * voxel_index.z());
+  return block_index;
+}
+
+GvdBasisStore::BlockEntries* GvdBasisStore::getBlock(const GlobalIndex& index,
+                                                     size_t& linear_index) const {
+  auto iter = blocks_.find(getBlockIndex(index, linear_index));
+  return iter == blocks_.end() ? nullptr : iter->second.get();
+}
+
+GvdBasisStore::BlockEntries& GvdBasisStore::allocateBlock(const GlobalIndex& index,
+                                                          size_t& linear_index) {
+  auto& block = blocks_[getBlockIndex(index, linear_index)];
+  if (!block) {
+    block.reset(new BlockEntries(num_voxels_));
+  }
+
+  return *block;
+}
+
+GlobalIndex GvdBasisStore::getGlobalIndex(const BlockIndex& block,
+                                          uint32_t linear_index) const {
+  VoxelIndex voxel_index(linear_index % voxels_per_side_,
+                         (linear_index / voxels_per_side_) % voxels_per_side_,
+                         linear_index / (voxels_per_side_ * voxels_per_side_));
+  return voxblox::getGlobalVoxelIndexFromBlockAndVoxelIndex(
+      block, voxel_index, voxels_per_side_);
+}
+
+const GvdBasis* GvdBasisStore::getBasis(const GlobalIndex& index) const {
+  size_t linear_index;
+  const BlockEntries* block = getBlock(index, linear_index);
+  if (!block) {
+    return nullptr;
+  }
+
+  const uint32_t slot = block->basis_slots[linear_index];
+  return slot == kInvalidSlot ? nullptr : &block->basis[slot];
+}
+
+GvdBasis* GvdBasisStore::getBasis(const GlobalIndex& index) {
+  return const_cast<GvdBasis*>(static_cast<const GvdBasisStore*>(this)->getBasis(index));
+}
+
+GvdBasis& GvdBasisStore::allocateBasis(const GlobalIndex& index) {
+  size_t linear_index;
+  BlockEntries& block = allocateBlock(index, linear_index);
+  uint32_t& slot = block.basis_slots[linear_index];
+  if (slot != kInvalidSlot) {
+    return block.basis[slot];
+  }
+
+  if (block.free_basis.empty()) {
+    slot = block.basis.size();
+    block.basis.emplace_back();
+  } else {
+    slot = block.free_basis.back();
+    block.free_basis.pop_back();
+    block.basis[slot] = GvdBasis();
+  }
+
+  return block.basis[slot];
+}
+
+void GvdBasisStore::removeBasis(const GlobalIndex& index) {
+  size_t linear_index;
+  BlockEntries* block = getBlock(index, linear_index);
+  if (!block) {
+    return;
+  }
+
+  uint32_t& slot = block->basis_slots[linear_index];
+  if (slot == kInvalidSlot) {
+    return;
+  }
+
+  releaseParents(block->basis[slot]);
+  block->free_basis.push_back(slot);
+  slot = kInvalidSlot;
+}
+
+void GvdBasisStore::releaseParents(const GvdBasis& basis) {
+  for (size_t i = 0; i < basis.num_parents; ++i) {
+    GvdVertexInfo* info = getVertex(basis.getParent(i));
+    if (info) {
+      // decrement the ref count (we garbage collect later to avoid losing parents
+      // due to thrashing)
+      info->ref_count--;
+    }
+  }
+}
+
+const GvdVertexInfo* GvdBasisStore::getVertex(const GlobalIndex& parent) const {
+  size_t linear_index;
+  const BlockEntries* block = getBlock(parent, linear_index);
+  if (block) {
+    const uint32_t slot = block->vertex_slots[linear_index];
+    if (slot != kInvalidSlot) {
+      return &block->vertices[slot].info;
+    }
+  }
+
+  if (archived_vertices_.empty()) {
+    return nullptr;
+  }
+
+  auto iter = archived_vertices_.find(parent);
+  return iter == archived_vertices_.end() ? nullptr : &iter->second;
+}
+
+GvdVertexInfo* GvdBasisStore::getVertex(const GlobalIndex& parent) {
+  return const_cast<GvdVertexInfo*>(
+      static_cast<const GvdBasisStore*>(this)->getVertex(parent));
+}
+
+GvdVertexInfo& GvdBasisStore::allocateVertex(const GlobalIndex& parent) {
+  GvdVertexInfo* existing = getVertex(parent);
+  if (existing) {
+    return *existing;
+  }
+
+  size_t linear_index;
+  BlockEntries& block = allocateBlock(parent, linear_index);
+  uint32_t& slot = block.vertex_slots[linear_index];
+  if (block.free_vertices.empty()) {
+    slot = block.vertices.size();
+    block.vertices.emplace_back();
+  } else {
+    slot = block.free_vertices.back();
+    block.free_vertices.pop_back();
+  }
+
+  VertexEntry& entry = block.vertices[slot];
+  entry.info = GvdVertexInfo();
+  entry.voxel = linear_index;
+  return entry.info;
+}
+
+void GvdBasisStore::removeVertex(const GlobalIndex& parent) {
+  size_t linear_index;
+  BlockEntries* block = getBlock(parent, linear_index);
+  if (block && block->vertex_slots[linear_index] != kInvalidSlot) {
+    removeVertex(*block, block->vertex_slots[linear_index]);
+    return;
+  }
+
+  archived_vertices_.erase(parent);
+}
+
+void GvdBasisStore::removeVertex(BlockEntries& block, uint32_t slot) {
+  VertexEntry& entry = block.vertices[slot];
+  block.vertex_slots[entry.voxel] = kInvalidSlot;
+  entry.voxel = kInvalidSlot;
+  block.free_vertices.push_back(slot);
+}
+
+void GvdBasisStore::filterVertices(const Layer<GvdVoxel>& layer,
+                                   const VertexCallback& callback) {
+  for (auto& id_block_pair : blocks_) {
+    BlockEntries& block = *id_block_pair.second;
+    const auto gvd_block = layer.getBlockPtrByIndex(id_block_pair.first);
+    for (uint32_t slot = 0; slot < block.vertices.size(); ++slot) {
+      VertexEntry& entry = block.vertices[slot];
+      if (entry.voxel == kInvalidSlot) {
+        continue;
+      }
+
+      const GvdVoxel* voxel =
+          gvd_block ? &gvd_block->getVoxelByLinearIndex(entry.voxel) : nullptr;
+      if (!callback(voxel, entry.info)) {
+        removeVertex(block, slot);
+      }
+    }
+  }
+
+  auto iter = archived_vertices_.begin();
+  while (iter != archived_vertices_.end()) {
+    const GvdVoxel* voxel = layer.getVoxelPtrByGlobalIndex(iter->first);
+    if (!callback(voxel, iter->second)) {
+      iter = archived_vertices_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void GvdBasisStore::removeBlock(const BlockIndex& index) {
+  auto iter = blocks_.find(index);
+  if (iter == blocks_.end()) {
+    return;
+  }
+
+  const BlockEntries& block = *iter->second;
+  for (const uint32_t slot : block.basis_slots) {
+    if (slot != kInvalidSlot) {
+      releaseParents(block.basis[slot]);
+    }
+  }
+
+  // parents in this block may still be referenced by voronoi voxels elsewhere
+  for (const auto& entry : block.vertices) {
+    if (entry.voxel != kInvalidSlot && entry.info.ref_count) {
+      archived_vertices_[getGlobalIndex(iter->first, entry.voxel)] = entry.info;
+    }
+  }
+
+  blocks_.erase(iter);
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -46,9 +46,50 @@
 
 #include <voxblox/utils/timing.h>
 
+#include <algorithm>
+
 namespace hydra {
 namespace topology {
 
+namespace {
+
+// statistics of the current wavefront worker (if any)
+thread_local UpdateStatistics* worker_stats = nullptr;
+
+// adds the parent to the basis if it is distinct from every parent already in it
+bool addUniqueParent(const VoronoiCheckConfig& config,
+                     const GlobalIndex& voxel_index,
+                     const GlobalIndex& parent,
+                     GvdBasis& basis) {
+  for (size_t i = 0; i < basis.num_parents; ++i) {
+    if (!isParentUnique(config, voxel_index, basis.getParent(i), parent)) {
+      return false;
+    }
+  }
+
+  // parent is unique enough (but the basis may already be saturated)
+  return basis.addParent(parent);
+}
+
+}  // namespace
+
+GvdIntegratorConfig getCoarseGvdConfig(const GvdIntegratorConfig& config,
+                                       size_t factor) {
+  GvdIntegratorConfig coarse = config;
+  // the archive file belongs to the fine integrator
+  coarse.archive_path = "";
+
+  coarse.max_distance_m *= factor;
+  coarse.voronoi_config.min_distance_m *= factor;
+
+  auto& extractor = coarse.graph_extractor_config;
+  extractor.node_merge_distance_m *= factor;
+  extractor.freespace_edge_min_clearance_m *= factor;
+  extractor.component_max_edge_length_m *= factor;
+  extractor.component_min_clearance_m *= factor;
+  return coarse;
+}
+
 void UpdateStatistics::clear() {
   number_lowered_voxels = 0;
   number_raised_voxels = 0;
@@ -61,6 +102,18 @@ void UpdateStatistics::clear() {
   number_force_lowered = 0;
 }
 
+void UpdateStatistics::merge(const UpdateStatistics& other) {
+  number_lowered_voxels += other.number_lowered_voxels;
+  number_raised_voxels += other.number_raised_voxels;
+  number_new_voxels += other.number_new_voxels;
+  number_raise_updates += other.number_raise_updates;
+  number_voronoi_found += other.number_voronoi_found;
+  number_lower_skipped += other.number_lower_skipped;
+  number_lower_updated += other.number_lower_updated;
+  number_fixed_no_parent += other.number_fixed_no_parent;
+  number_force_lowered += other.number_force_lowered;
+}
+
 std::ostream& operator<<(std::ostream& out, const UpdateStatistics& stats) {
   out << "  - Voxel changes: ";
   out << stats.number_lowered_voxels << " lowered, ";
@@ -82,7 +135,8 @@ GvdIntegrator::GvdIntegrator(const GvdIntegratorConfig& config,
     : config_(config),
       tsdf_layer_(tsdf_layer),
       gvd_layer_(gvd_layer),
-      mesh_layer_(mesh_layer) {
+      mesh_layer_(mesh_layer),
+      gvd_basis_(gvd_layer->voxels_per_side()) {
   // TODO(nathan) we could consider an exception here for any of these
   CHECK(tsdf_layer_);
   CHECK(gvd_layer_);
@@ -94,56 +148,79 @@ GvdIntegrator::GvdIntegrator(const GvdIntegratorConfig& config,
 
   lower_.setNumBuckets(config_.num_buckets, config_.max_distance_m);
 
+  if (!config_.archive_path.empty()) {
+    tsdf_archive_.reset(new TsdfBlockArchive(config_.archive_path,
+                                             gvd_layer_->voxels_per_side(),
+                                             config_.archive_max_resident_blocks));
+  }
+
+  if (config_.num_threads > 1) {
+    wavefront_.reset(new BlockWavefront(
+        gvd_layer_->voxels_per_side(), config_.num_buckets, config_.max_distance_m));
+  }
+
+  thread_pool_ = std::make_shared<ThreadPool>(std::max(
+      config_.num_threads, config_.mesh_integrator_config.integrator_threads));
+
   mesh_integrator_.reset(new VoxelAwareMeshIntegrator(config_.mesh_integrator_config,
                                                       tsdf_layer_,
                                                       gvd_layer_.get(),
-                                                      mesh_layer_.get()));
+                                                      mesh_layer_.get(),
+                                                      thread_pool_));
 
-  graph_extractor_.reset(new GraphExtractor(config_.graph_extractor_config));
+  graph_extractor_.reset(
+      new GraphExtractor(config_.graph_extractor_config, thread_pool_));
 }
 
 uint8_t GvdIntegrator::updateGvdParentMap(const GlobalIndex& voxel_index,
                                           const GvdVoxel& neighbor) {
-  const GlobalIndex neighbor_parent = Eigen::Map<const GlobalIndex>(neighbor.parent);
-  if (!gvd_parents_.count(voxel_index)) {
-    gvd_parents_[voxel_index] = voxblox::LongIndexSet();
-  }
+  const GlobalIndex neighbor_parent = getParentIndex(neighbor);
+  GvdBasis& basis = gvd_basis_.allocateBasis(voxel_index);
 
-  uint8_t curr_extra_basis = gvd_parents_[voxel_index].size();
-  for (const auto& other_parent : gvd_parents_[voxel_index]) {
-    const bool is_unique = isParentUnique(
-        config_.voronoi_config, voxel_index, other_parent, neighbor_parent);
-    if (!is_unique) {
-      return curr_extra_basis;
-    }
+  uint8_t curr_extra_basis = basis.num_parents;
+  if (!addUniqueParent(
+          config_.voronoi_config, voxel_index, neighbor_parent, basis)) {
+    return curr_extra_basis;
   }
 
-  // parent is unique enough
-  gvd_parents_[voxel_index].insert(neighbor_parent);
   markNewGvdParent(neighbor_parent);
   return curr_extra_basis + 1;
 }
 
 void GvdIntegrator::markNewGvdParent(const GlobalIndex& parent) {
-  if (gvd_parent_vertices_.count(parent)) {
+  GvdVertexInfo* existing = gvd_basis_.getVertex(parent);
+  if (existing) {
     // make sure the parent vertex map stays alive for this gvd member
-    gvd_parent_vertices_[parent].ref_count++;
+    existing->ref_count++;
+    return;
+  }
+
+  if (wavefront_) {
+    // the parent block may belong to another worker (and the voxel flags share bytes
+    // with the fields we need), so the parent is only read after the wavefront
+    GvdVertexInfo& info = gvd_basis_.allocateVertex(parent);
+    info.ref_count = 1;
+    pending_parents_.push_back(parent);
     return;
   }
 
-  GvdVoxel* parent_voxel = gvd_layer_->getVoxelPtrByGlobalIndex(parent);
+  const GvdVoxel* parent_voxel = gvd_layer_->getVoxelPtrByGlobalIndex(parent);
   if (!parent_voxel || !parent_voxel->on_surface) {
     // we can't do anything for parents that have left the active mesh before being used
     // as a GVD parent, or parents that aren't registered to the mesh
     return;
   }
 
-  GvdVertexInfo info;
-  info.vertex = parent_voxel->block_vertex_index;
+  GvdVertexInfo& info = gvd_basis_.allocateVertex(parent);
   info.ref_count = 1;
-  std::memcpy(info.block, parent_voxel->mesh_block, sizeof(info.block));
+  setParentVertex(*parent_voxel, info);
+}
+
+void GvdIntegrator::setParentVertex(const GvdVoxel& parent_voxel, GvdVertexInfo& info) {
+  info.vertex = parent_voxel.block_vertex_index;
+  std::memcpy(info.block, parent_voxel.mesh_block, sizeof(info.block));
 
-  BlockIndex block_index = Eigen::Map<BlockIndex>(parent_voxel->mesh_block);
+  BlockIndex block_index = Eigen::Map<const BlockIndex>(parent_voxel.mesh_block);
   const auto& mesh_block = mesh_layer_->getMeshByIndex(block_index);
   if (info.vertex < mesh_block.vertices.size()) {
     voxblox::Point vertex_pos = mesh_block.vertices.at(info.vertex);
@@ -151,72 +228,83 @@ void GvdIntegrator::markNewGvdParent(const GlobalIndex& parent) {
     info.pos[1] = vertex_pos(1);
     info.pos[2] = vertex_pos(2);
   }
-
-  gvd_parent_vertices_[parent] = info;
 }
 
-void GvdIntegrator::removeVoronoiFromGvdParentMap(const GlobalIndex& voxel_index) {
-  auto voxel_parents = gvd_parents_.find(voxel_index);
-  if (voxel_parents != gvd_parents_.end()) {
-    for (const auto& parent : voxel_parents->second) {
-      if (gvd_parent_vertices_.count(parent)) {
-        // decrement the ref count (we garbage collect later to avoid losing parents
-        // due to thrashing)
-        gvd_parent_vertices_[parent].ref_count--;
-      }
+void GvdIntegrator::resolvePendingParents() {
+  for (const auto& parent : pending_parents_) {
+    GvdVertexInfo* info = gvd_basis_.getVertex(parent);
+    if (!info) {
+      continue;  // duplicate entry that was already dropped
     }
 
-    gvd_parents_.erase(voxel_parents);
+    const GvdVoxel* parent_voxel = gvd_layer_->getVoxelPtrByGlobalIndex(parent);
+    if (!parent_voxel || !parent_voxel->on_surface) {
+      // matches the serial update, which never allocates these parents
+      gvd_basis_.removeVertex(parent);
+      continue;
+    }
+
+    setParentVertex(*parent_voxel, *info);
   }
+
+  pending_parents_.clear();
+}
+
+void GvdIntegrator::removeVoronoiFromGvdParentMap(const GlobalIndex& voxel_index) {
+  gvd_basis_.removeBasis(voxel_index);
 }
 
 void GvdIntegrator::updateVertexMapping() {
-  auto iter = gvd_parent_vertices_.begin();
-  while (iter != gvd_parent_vertices_.end()) {
-    if (!iter->second.ref_count) {
-      iter = gvd_parent_vertices_.erase(iter);
-      continue;
+  auto update_vertex = [&](const GvdVoxel* voxel, GvdVertexInfo& info) {
+    if (!info.ref_count) {
+      return false;
     }
 
-    GvdVoxel* voxel = gvd_layer_->getVoxelPtrByGlobalIndex(iter->first);
     if (!voxel) {
-      ++iter;
-      continue;
+      return true;
     }
 
     if (!voxel->on_surface) {
-      iter = gvd_parent_vertices_.erase(iter);
-      continue;
+      return false;
     }
 
-    iter->second.vertex = voxel->block_vertex_index;
+    info.vertex = voxel->block_vertex_index;
 
-    const BlockIndex block_index = Eigen::Map<BlockIndex>(voxel->mesh_block);
-    Eigen::Map<BlockIndex>(iter->second.block) = block_index;
+    const BlockIndex block_index = Eigen::Map<const BlockIndex>(voxel->mesh_block);
+    Eigen::Map<BlockIndex>(info.block) = block_index;
 
     const auto& mesh_block = mesh_layer_->getMeshByIndex(block_index);
     if (voxel->block_vertex_index >= mesh_block.vertices.size()) {
       LOG(ERROR) << "Invalid vertex: " << voxel->block_vertex_index
                  << " >= " << mesh_block.vertices.size();
-      iter = gvd_parent_vertices_.erase(iter);
-      continue;
+      return false;
     }
 
-    voxblox::Point vertex_pos = mesh_block.vertices.at(iter->second.vertex);
-    iter->second.pos[0] = vertex_pos(0);
-    iter->second.pos[1] = vertex_pos(1);
-    iter->second.pos[2] = vertex_pos(2);
+    voxblox::Point vertex_pos = mesh_block.vertices.at(info.vertex);
+    info.pos[0] = vertex_pos(0);
+    info.pos[1] = vertex_pos(1);
+    info.pos[2] = vertex_pos(2);
+    return true;
+  };
+
+  gvd_basis_.filterVertices(*gvd_layer_, update_vertex);
+}
 
-    ++iter;
-  }
+UpdateStatistics& GvdIntegrator::stats() {
+  return worker_stats ? *worker_stats : update_stats_;
 }
 
 void GvdIntegrator::updateGvdVoxel(const GlobalIndex& voxel_index,
                                    GvdVoxel& voxel,
                                    GvdVoxel& other) {
+  std::unique_lock<std::mutex> lock(gvd_mutex_, std::defer_lock);
+  if (wavefront_) {
+    lock.lock();
+  }
+
   if (!isVoronoi(voxel)) {
-    update_stats_.number_voronoi_found++;
-    const GlobalIndex parent = Eigen::Map<const GlobalIndex>(voxel.parent);
+    stats().number_voronoi_found++;
+    const GlobalIndex parent = getParentIndex(voxel);
     markNewGvdParent(parent);
   }
 
@@ -234,6 +322,11 @@ void GvdIntegrator::updateGvdVoxel(const GlobalIndex& voxel_index,
 
 void GvdIntegrator::clearGvdVoxel(const GlobalIndex& index, GvdVoxel& voxel) {
   if (voxel.num_extra_basis) {
+    std::unique_lock<std::mutex> lock(gvd_mutex_, std::defer_lock);
+    if (wavefront_) {
+      lock.lock();
+    }
+
     // TODO(nathan) rethink how clearing voxels from graph extractor works
     graph_extractor_->clearGvdIndex(index);
     removeVoronoiFromGvdParentMap(index);
@@ -242,26 +335,6 @@ void GvdIntegrator::clearGvdVoxel(const GlobalIndex& index, GvdVoxel& voxel) {
   resetVoronoi(voxel);
 }
 
-void GvdIntegrator::updateVoronoiQueue(GvdVoxel& voxel,
-                                       const GlobalIndex& voxel_idx,
-                                       GvdVoxel& neighbor,
-                                       const GlobalIndex& neighbor_idx) {
-  VoronoiCondition result =
-      checkVoronoi(config_.voronoi_config, voxel, voxel_idx, neighbor, neighbor_idx);
-
-  if (!result.current_is_voronoi && !result.neighbor_is_voronoi) {
-    return;
-  }
-
-  if (result.current_is_voronoi) {
-    updateGvdVoxel(voxel_idx, voxel, neighbor);
-  }
-
-  if (result.neighbor_is_voronoi) {
-    updateGvdVoxel(neighbor_idx, neighbor, voxel);
-  }
-}
-
 BlockIndexList GvdIntegrator::removeDistantBlocks(const voxblox::Point& center,
                                                   double max_distance) {
   BlockIndexList blocks;
@@ -286,19 +359,46 @@ BlockIndexList GvdIntegrator::removeDistantBlocks(const voxblox::Point& center,
               block->computeVoxelIndexFromLinearIndex(v),
               gvd_layer_->voxels_per_side());
       graph_extractor_->removeDistantIndex(global_index);
+    }
+
+    gvd_basis_.removeBlock(idx);
 
-      removeVoronoiFromGvdParentMap(global_index);
+    if (tsdf_archive_ && tsdf_layer_->hasBlock(idx)) {
+      tsdf_archive_->archiveBlock(idx, tsdf_layer_->getBlockByIndex(idx));
     }
 
     // we explicitly tsdf and gvd blocks here to avoid potential weirdness
     tsdf_layer_->removeBlock(idx);
     gvd_layer_->removeBlock(idx);
+    mesh_layer_->removeMesh(idx);
+    mesh_integrator_->getMeshChanges().removeBlock(idx);
     archived.push_back(idx);
   }
 
   return archived;
 }
 
+void GvdIntegrator::copyUpdatedTsdfBlocks(Layer<TsdfVoxel>& live_layer) {
+  BlockIndexList blocks;
+  live_layer.getAllUpdatedBlocks(voxblox::Update::kEsdf, &blocks);
+  for (const auto& idx : blocks) {
+    auto& live_block = live_layer.getBlockByIndex(idx);
+    if (tsdf_archive_) {
+      tsdf_archive_->restoreBlock(idx, live_block);
+    }
+
+    auto block = tsdf_layer_->allocateBlockPtrByIndex(idx);
+    for (size_t i = 0; i < live_block.num_voxels(); ++i) {
+      block->getVoxelByLinearIndex(i) = live_block.getVoxelByLinearIndex(i);
+    }
+
+    block->has_data() = live_block.has_data();
+    block->updated() |= live_block.updated();
+    live_block.updated().reset(voxblox::Update::kEsdf);
+    live_block.updated().reset(voxblox::Update::kMesh);
+  }
+}
+
 void GvdIntegrator::updateFromTsdfLayer(bool clear_updated_flag,
                                         bool clear_surface_flag,
                                         bool use_all_blocks) {
@@ -317,8 +417,15 @@ void GvdIntegrator::updateFromTsdfLayer(bool clear_updated_flag,
 
   voxblox::timing::Timer allocate_timer("gvd/allocate_blocks");
   for (const auto& idx : blocks) {
+    if (tsdf_archive_ && !gvd_layer_->hasBlock(idx)) {
+      // the block was re-allocated after being archived: page the old contents back
+      // (a no-op for snapshots, which restore into the live layer while copying)
+      tsdf_archive_->restoreBlock(idx, tsdf_layer_->getBlockByIndex(idx));
+    }
+
     // make sure the blocks match the tsdf
     Block<GvdVoxel>::Ptr gvd_block = gvd_layer_->allocateBlockPtrByIndex(idx);
+
     if (clear_surface_flag) {
       for (size_t idx = 0u; idx < gvd_block->num_voxels(); ++idx) {
         // we need to reset these so that marching cubes can assign them correctly
@@ -341,30 +448,50 @@ void GvdIntegrator::updateFromTsdfLayer(bool clear_updated_flag,
 
   VLOG(3) << "[GVD update]: propagating TSDF";
   voxblox::timing::Timer propagate_timer("gvd/propagate_tsdf");
-  for (const BlockIndex& idx : blocks) {
-    processTsdfBlock(tsdf_layer_->getBlockByIndex(idx), idx);
+  if (wavefront_) {
+    wavefront_->syncBlocks(*gvd_layer_);
+    processTsdfBlocksParallel(blocks);
+  } else {
+    for (const BlockIndex& idx : blocks) {
+      processTsdfBlock(tsdf_layer_->getBlockByIndex(idx), idx);
+    }
   }
   propagate_timer.Stop();
   VLOG(3) << "[GVD update]: finished propagating TSDF";
 
   VLOG(3) << "[GVD update]: raising invalid voxels";
   voxblox::timing::Timer raise_timer("gvd/raise_esdf");
-  processRaiseSet();
+  if (wavefront_) {
+    processRaiseSetParallel();
+  } else {
+    processRaiseSet();
+  }
   raise_timer.Stop();
 
   VLOG(3) << "[GVD update]: lowering all voxels";
   voxblox::timing::Timer update_timer("gvd/update_esdf");
-  processLowerSet();
+  setFixedParents(blocks);
+  if (wavefront_) {
+    processLowerSetParallel();
+  } else {
+    processLowerSet();
+  }
   update_timer.Stop();
   VLOG(3) << "[GVD update]: finished lowering all voxels";
 
+  voxblox::timing::Timer voronoi_timer("gvd/update_voronoi");
+  updateVoronoi();
+  if (wavefront_) {
+    resolvePendingParents();
+  }
+  voronoi_timer.Stop();
+
   if (config_.extract_graph) {
     VLOG(3) << "[GVD update]: starting graph extraction";
     voxblox::timing::Timer extraction_timer("gvd/extract_graph");
     updateVertexMapping();
     graph_extractor_->extract(*gvd_layer_);
-    graph_extractor_->assignMeshVertices(
-        *gvd_layer_, gvd_parents_, gvd_parent_vertices_);
+    graph_extractor_->assignMeshVertices(*gvd_layer_, gvd_basis_);
     extraction_timer.Stop();
     VLOG(3) << "[GVD update]: finished graph extraction";
   }
@@ -501,139 +628,139 @@ void GvdIntegrator::processTsdfBlock(const Block<TsdfVoxel>& tsdf_block,
 }
 
 void GvdIntegrator::processRaiseSet() {
-  voxblox::GlobalIndexVector neighbors;
-  GvdNeighborhood::IndexMatrix neighbor_indices;
   VLOG(10) << "***************************************************";
   VLOG(10) << "* Raising voxels                                  *";
   VLOG(10) << "***************************************************";
 
   while (!raise_.empty()) {
     const GlobalIndex index = popFromRaise();
-    // TODO(nathan) reference?
-    GvdVoxel* voxel = gvd_layer_->getVoxelPtrByGlobalIndex(index);
-    CHECK_NOTNULL(voxel);
-
-    VLOG(10) << "==================";
-    VLOG(10) << "before: " << *voxel << " @ " << index.transpose();
-    VLOG(10) << "---";
-
-    GvdNeighborhood::getFromGlobalIndex(index, &neighbor_indices);
+    processRaiseVoxel(index);
+    touched_voxels_.push_back(index);
+  }
+}
 
-    for (unsigned int idx = 0u; idx < neighbor_indices.cols(); ++idx) {
-      const GlobalIndex& neighbor_index = neighbor_indices.col(idx);
+void GvdIntegrator::processRaiseVoxel(const GlobalIndex& index) {
+  GvdNeighborAccessor neighbors(*gvd_layer_);
+  // TODO(nathan) reference?
+  GvdVoxel* voxel = neighbors.setIndex(index);
+  CHECK_NOTNULL(voxel);
 
-      GvdVoxel* neighbor = gvd_layer_->getVoxelPtrByGlobalIndex(neighbor_index);
-      if (neighbor == nullptr) {
-        continue;
-      }
+  VLOG(10) << "==================";
+  VLOG(10) << "before: " << *voxel << " @ " << index.transpose();
+  VLOG(10) << "---";
 
-      // TODO(nathan) neighbor->has_parent != neighbor->on_surface should be an
-      // invariant
-      if (!neighbor->observed || neighbor->fixed || !neighbor->has_parent) {
-        continue;
-      }
+  for (unsigned int idx = 0u; idx < GvdNeighborhood::kOffsets.cols(); ++idx) {
+    GvdVoxel* neighbor = neighbors.getNeighbor(idx);
+    if (neighbor == nullptr) {
+      continue;
+    }
 
-      update_stats_.number_raise_updates++;
+    // TODO(nathan) neighbor->has_parent != neighbor->on_surface should be an
+    // invariant
+    if (!neighbor->observed || neighbor->fixed || !neighbor->has_parent) {
+      continue;
+    }
 
-      bool descended_from_current;
-      Eigen::Map<const GlobalIndex> neighbor_parent(neighbor->parent);
-      if (voxel->has_parent) {
-        descended_from_current =
-            neighbor_parent == Eigen::Map<const GlobalIndex>(voxel->parent);
-      } else {
-        descended_from_current = neighbor_parent == index;
-      }
+    stats().number_raise_updates++;
 
-      VLOG(10) << "n: " << idx << " -> " << *neighbor << " from current? "
-               << (descended_from_current ? "yes" : "no");
-      if (descended_from_current) {
-        pushToQueue(neighbor_index, *neighbor, PushType::RAISE);
-        continue;
-      }
+    bool descended_from_current;
+    const GlobalIndex neighbor_parent = getParentIndex(*neighbor);
+    if (voxel->has_parent) {
+      descended_from_current = neighbor_parent == getParentIndex(*voxel);
+    } else {
+      descended_from_current = neighbor_parent == index;
+    }
 
-      // TODO(nathan) Algorithm 2: 32 of Lau et al. 2013
-      if (!neighbor->in_queue) {
-        pushToQueue(neighbor_index, *neighbor, PushType::LOWER);
-      }
+    VLOG(10) << "n: " << idx << " -> " << *neighbor << " from current? "
+             << (descended_from_current ? "yes" : "no");
+    if (descended_from_current) {
+      pushToQueue(neighbors.getNeighborIndex(idx), *neighbor, PushType::RAISE);
+      continue;
     }
 
-    raiseVoxel(*voxel, index);
-    VLOG(10) << "---";
-    VLOG(10) << "after: " << *voxel << " @ " << index.transpose();
+    // TODO(nathan) Algorithm 2: 32 of Lau et al. 2013
+    if (!neighbor->in_queue) {
+      pushToQueue(neighbors.getNeighborIndex(idx), *neighbor, PushType::LOWER);
+    }
   }
+
+  raiseVoxel(*voxel);
+  VLOG(10) << "---";
+  VLOG(10) << "after: " << *voxel << " @ " << index.transpose();
 }
 
-void GvdIntegrator::raiseVoxel(GvdVoxel& voxel, const GlobalIndex& voxel_index) {
-  // no need to remove from parent list of voronoi voxel: lower wavefront will ensure
-  // that the parent map is consistent
+void GvdIntegrator::raiseVoxel(GvdVoxel& voxel) {
+  // no need to remove from parent list of voronoi voxel: updateVoronoi rebuilds the
+  // parent map (and GVD membership) once the wavefront settles
   voxel.is_voronoi_parent = false;
 
-  clearGvdVoxel(voxel_index, voxel);
-
   // TODO(nathan) determining sign of distance here is optimistic
   setDefaultDistance(voxel, voxel.distance);
   resetGvdParent(voxel);
 }
 
-bool GvdIntegrator::processNeighbor(GvdVoxel& voxel,
-                                    const GlobalIndex& voxel_idx,
-                                    FloatingPoint distance,
-                                    const GlobalIndex& neighbor_idx,
+bool GvdIntegrator::processNeighbor(const GvdNeighborAccessor& neighbors,
+                                    unsigned int n,
+                                    GvdVoxel& voxel,
                                     GvdVoxel& neighbor) {
+  const GlobalIndex& voxel_idx = neighbors.getIndex();
   DistancePotential candidate;
   if (config_.parent_derived_distance) {
-    const voxblox::Point neighbor_pos =
-        getVoxelPosition<float>(*gvd_layer_, neighbor_idx);
+    const voxblox::Point neighbor_pos = neighbors.getNeighborPosition(n);
     voxblox::Point parent_pos;
+    GlobalIndex parent_idx;
     if (voxel.has_parent) {
-      parent_pos = Eigen::Map<const voxblox::Point>(voxel.parent_pos);
+      parent_pos = getParentPosition(voxel, voxel_size_);
+      parent_idx = getParentIndex(voxel);
     } else {
-      parent_pos = getVoxelPosition<float>(*gvd_layer_, voxel_idx);
+      parent_pos = neighbors.getPosition();
+      parent_idx = voxel_idx;
     }
 
     // TODO(nathan): neighbor should have correct sign, but not sure
     candidate.distance =
         std::copysign((neighbor_pos - parent_pos).norm(), neighbor.distance);
-    candidate.is_lower = std::abs(candidate.distance) < std::abs(neighbor.distance);
+    if (neighbor.has_parent && !neighbor.fixed) {
+      // the neighbor distance is derived from its parent as well
+      candidate.is_lower = isCloserParent(
+          neighbors.getNeighborIndex(n), parent_idx, getParentIndex(neighbor));
+    } else {
+      candidate.is_lower = std::abs(candidate.distance) < std::abs(neighbor.distance);
+    }
   } else {
+    const FloatingPoint distance =
+        NeighborhoodLookupTables::kDistances[n] * voxel_size_;
     candidate = getLowerDistance(
         voxel.distance, neighbor.distance, distance, config_.min_diff_m);
   }
 
   if (!neighbor.fixed && !candidate.is_lower && !neighbor.has_parent) {
-    update_stats_.number_force_lowered++;
+    stats().number_force_lowered++;
     candidate.is_lower = true;
   }
 
-  if (!candidate.is_lower) {
-    updateVoronoiQueue(voxel, voxel_idx, neighbor, neighbor_idx);
-    return false;
-  }
-
   if (neighbor.fixed || !candidate.is_lower) {
     return false;
   }
 
   neighbor.distance = candidate.distance;
-  const voxblox::Point voxel_pos = getVoxelPosition<float>(*gvd_layer_, voxel_idx);
-  setSdfParent(neighbor, voxel, voxel_idx, voxel_pos);
+  setSdfParent(neighbor, voxel, voxel_idx, neighbors.getPosition());
 
   if (config_.multi_queue || !neighbor.in_queue) {
-    pushToQueue(neighbor_idx, neighbor, PushType::LOWER);
+    pushToQueue(neighbors.getNeighborIndex(n), neighbor, PushType::LOWER);
   }
 
   return true;
 }
 
-void GvdIntegrator::setFixedParent(const GvdNeighborhood::IndexMatrix& neighbor_indices,
+void GvdIntegrator::setFixedParent(const GvdNeighborAccessor& neighbors,
                                    GvdVoxel& voxel) {
   FloatingPoint best_distance = 0.0;  // overwritten by first valid neighbor
   GvdVoxel* best_neighbor = nullptr;
-  GlobalIndex best_neighbor_index;
+  unsigned int best_n = 0;
 
-  for (unsigned int n = 0u; n < neighbor_indices.cols(); ++n) {
-    const GlobalIndex& neighbor_index = neighbor_indices.col(n);
-    GvdVoxel* neighbor = gvd_layer_->getVoxelPtrByGlobalIndex(neighbor_index);
+  for (unsigned int n = 0u; n < GvdNeighborhood::kOffsets.cols(); ++n) {
+    GvdVoxel* neighbor = neighbors.getNeighbor(n);
     if (!neighbor) {
       continue;
     }
@@ -654,69 +781,312 @@ void GvdIntegrator::setFixedParent(const GvdNeighborhood::IndexMatrix& neighbor_
         neighbor->distance + std::copysign(distance, voxel.distance);
     if (!best_neighbor || neighbor_distance < best_distance) {
       best_neighbor = neighbor;
-      best_neighbor_index = neighbor_index;
+      best_n = n;
       best_distance = neighbor_distance;
     }
   }
 
   if (!best_neighbor) {
-    update_stats_.number_fixed_no_parent++;
+    stats().number_fixed_no_parent++;
     VLOG(5) << "[GVD Update]: Unable to set parent for non-surface fixed layer voxel: "
             << voxel;
     // setting these voxels as surfaces probably distorts the gvd...
     // setGvdSurfaceVoxel(voxel);
   } else {
-    const voxblox::Point neighbor_pos =
-        getVoxelPosition<float>(*gvd_layer_, best_neighbor_index);
-    setSdfParent(voxel, *best_neighbor, best_neighbor_index, neighbor_pos);
+    setSdfParent(voxel,
+                 *best_neighbor,
+                 neighbors.getNeighborIndex(best_n),
+                 neighbors.getNeighborPosition(best_n));
+  }
+}
+
+void GvdIntegrator::setFixedParents(const BlockIndexList& blocks) {
+  // fixed voxels take their parent from fixed neighbors closer to the surface, so
+  // those get assigned first (which doesn't depend on the wavefront order)
+  voxblox::AlignedVector<std::pair<FloatingPoint, GlobalIndex>> to_assign;
+  for (const auto& block_index : blocks) {
+    const auto block = gvd_layer_->getBlockPtrByIndex(block_index);
+    if (!block) {
+      continue;
+    }
+
+    for (size_t idx = 0u; idx < block->num_voxels(); ++idx) {
+      const GvdVoxel& voxel = block->getVoxelByLinearIndex(idx);
+      if (!voxel.fixed || voxel.has_parent || voxel.on_surface ||
+          !voxelHasDistance(voxel)) {
+        continue;
+      }
+
+      to_assign.emplace_back(std::abs(voxel.distance),
+                             voxblox::getGlobalVoxelIndexFromBlockAndVoxelIndex(
+                                 block_index,
+                                 block->computeVoxelIndexFromLinearIndex(idx),
+                                 gvd_layer_->voxels_per_side()));
+    }
+  }
+
+  std::sort(to_assign.begin(), to_assign.end(), [](const auto& lhs, const auto& rhs) {
+    if (lhs.first != rhs.first) {
+      return lhs.first < rhs.first;
+    }
+
+    return indexLess(lhs.second, rhs.second);
+  });
+
+  GvdNeighborAccessor neighbors(*gvd_layer_);
+  for (const auto& distance_index_pair : to_assign) {
+    GvdVoxel& voxel = *CHECK_NOTNULL(neighbors.setIndex(distance_index_pair.second));
+    setFixedParent(neighbors, voxel);
+  }
+}
+
+void GvdIntegrator::updateVoronoi() {
+  if (wavefront_) {
+    wavefront_->popTouched(touched_voxels_);
+  }
+
+  // membership depends on the parents of the neighbors as well, so every neighbor of
+  // a touched voxel gets checked. Voxels are visited in index order so that the
+  // basis and the graph extractor see the same sequence for any number of threads
+  GlobalIndexSet to_check;
+  for (const auto& index : touched_voxels_) {
+    to_check.insert(index);
+    for (unsigned int n = 0u; n < GvdNeighborhood::kOffsets.cols(); ++n) {
+      to_check.insert(index + GvdNeighborhood::kOffsets.col(n));
+    }
+  }
+
+  touched_voxels_.clear();
+
+  voxblox::AlignedVector<GlobalIndex> indices(to_check.begin(), to_check.end());
+  std::sort(indices.begin(), indices.end(), &indexLess);
+
+  // a voxel is voronoi with respect to a neighbor if either side of the check says
+  // so (the wavefront used to check each pair from whichever voxel it lowered)
+  std::vector<uint32_t> voronoi_neighbors(indices.size(), 0u);
+  auto check_voxel = [&](size_t i) {
+    GvdNeighborAccessor neighbors(*gvd_layer_);
+    const GvdVoxel* voxel = neighbors.setIndex(indices[i]);
+    if (!canBeVoronoi(voxel)) {
+      return;
+    }
+
+    for (unsigned int n = 0u; n < GvdNeighborhood::kOffsets.cols(); ++n) {
+      const GvdVoxel* neighbor = neighbors.getNeighbor(n);
+      if (!canBeVoronoi(neighbor)) {
+        continue;
+      }
+
+      const GlobalIndex neighbor_idx = neighbors.getNeighborIndex(n);
+      const auto forward = checkVoronoi(
+          config_.voronoi_config, *voxel, indices[i], *neighbor, neighbor_idx);
+      const auto backward = checkVoronoi(
+          config_.voronoi_config, *neighbor, neighbor_idx, *voxel, indices[i]);
+      if (forward.current_is_voronoi || backward.neighbor_is_voronoi) {
+        voronoi_neighbors[i] |= (1u << n);
+      }
+    }
+  };
+
+  // the checks only read the settled wavefront, so they can run on any thread
+  if (wavefront_) {
+    thread_pool_->parallelFor(indices.size(), check_voxel, 256);
+  } else {
+    for (size_t i = 0; i < indices.size(); ++i) {
+      check_voxel(i);
+    }
+  }
+
+  GvdNeighborAccessor neighbors(*gvd_layer_);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    const GlobalIndex& index = indices[i];
+    GvdVoxel* voxel = neighbors.setIndex(index);
+    if (!voxel) {
+      continue;
+    }
+
+    // voxels whose basis is unchanged are left alone so that the graph extractor
+    // only sees voxels that actually changed
+    GvdBasis basis;
+    for (unsigned int n = 0u; n < GvdNeighborhood::kOffsets.cols(); ++n) {
+      if (voronoi_neighbors[i] & (1u << n)) {
+        const GvdVoxel& neighbor = *neighbors.getNeighbor(n);
+        addUniqueParent(
+            config_.voronoi_config, index, getParentIndex(neighbor), basis);
+      }
+    }
+
+    const GvdBasis* prev_basis = gvd_basis_.getBasis(index);
+    if (!basis.num_parents && !voxel->num_extra_basis) {
+      continue;
+    }
+
+    if (prev_basis && basis.num_parents == voxel->num_extra_basis &&
+        basis.num_parents == prev_basis->num_parents &&
+        getParentIndex(*voxel) == prev_basis->getVoxelParent() &&
+        std::equal(&basis.parents[0][0],
+                   &basis.parents[0][0] + 3 * basis.num_parents,
+                   &prev_basis->parents[0][0])) {
+      continue;
+    }
+
+    clearGvdVoxel(index, *voxel);
+    for (unsigned int n = 0u; n < GvdNeighborhood::kOffsets.cols(); ++n) {
+      if (voronoi_neighbors[i] & (1u << n)) {
+        updateGvdVoxel(index, *voxel, *neighbors.getNeighbor(n));
+      }
+    }
+
+    GvdBasis* new_basis = gvd_basis_.getBasis(index);
+    if (new_basis) {
+      new_basis->setVoxelParent(getParentIndex(*voxel));
+    }
   }
 }
 
 void GvdIntegrator::processLowerSet() {
-  GvdNeighborhood::IndexMatrix neighbor_indices;
   VLOG(10) << "***************************************************";
   VLOG(10) << "* Lowering voxels                                 *";
   VLOG(10) << "***************************************************";
   while (!lower_.empty()) {
     const GlobalIndex index = popFromLower();
-    GvdVoxel& voxel = *CHECK_NOTNULL(gvd_layer_->getVoxelPtrByGlobalIndex(index));
-    clearGvdVoxel(index, voxel);
+    processLowerVoxel(index);
+    touched_voxels_.push_back(index);
+  }
+}
+
+void GvdIntegrator::processLowerVoxel(const GlobalIndex& index) {
+  GvdNeighborAccessor neighbors(*gvd_layer_);
+  GvdVoxel& voxel = *CHECK_NOTNULL(neighbors.setIndex(index));
 
-    // TODO(nathan) Lau et al have some check for this
-    voxel.in_queue = false;
-    VLOG(10) << "-----------------------";
-    VLOG(10) << "processing " << voxel << " @ " << index.transpose();
+  // TODO(nathan) Lau et al have some check for this
+  voxel.in_queue = false;
+  VLOG(10) << "-----------------------";
+  VLOG(10) << "processing " << voxel << " @ " << index.transpose();
 
-    if (!voxelHasDistance(voxel)) {
-      VLOG(10) << "skipped";
-      update_stats_.number_lower_skipped++;
+  if (!voxelHasDistance(voxel)) {
+    VLOG(10) << "skipped";
+    stats().number_lower_skipped++;
+    return;
+  }
+
+  stats().number_lower_updated++;
+
+  for (unsigned int n = 0u; n < GvdNeighborhood::kOffsets.cols(); ++n) {
+    GvdVoxel* neighbor = neighbors.getNeighbor(n);
+    if (!neighbor) {
       continue;
     }
 
-    update_stats_.number_lower_updated++;
-    GvdNeighborhood::getFromGlobalIndex(index, &neighbor_indices);
+    if (!neighbor->observed) {
+      continue;
+    }
+
+    processNeighbor(neighbors, n, voxel, *neighbor);
+  }
+}
+
+void GvdIntegrator::runWavefrontPass(
+    const BlockWavefront::BlockList& blocks,
+    const std::function<void(WavefrontBlock&)>& callback) {
+  if (blocks.empty()) {
+    return;
+  }
+
+  const size_t num_workers = std::min(config_.num_threads, blocks.size());
+  std::vector<UpdateStatistics> pass_stats(num_workers);
+  voxblox::MixedThreadSafeIndex index_getter(blocks.size());
+
+  auto worker = [&](size_t worker_id) {
+    pass_stats[worker_id].clear();
+    worker_stats = &pass_stats[worker_id];
 
-    if (voxel.fixed && !voxel.has_parent && !voxel.on_surface) {
-      // we delay assigning parents for voxels in the fixed layer until this point
-      // as it should be an invariant that all potential parents have been seen by
-      // processLowerSet
-      setFixedParent(neighbor_indices, voxel);
-      VLOG(10) << "set new parent: " << voxel << " @ " << index.transpose();
+    size_t list_idx;
+    while (index_getter.getNextIndex(&list_idx)) {
+      callback(*blocks[list_idx]);
     }
 
-    for (unsigned int n = 0u; n < neighbor_indices.cols(); ++n) {
-      const GlobalIndex& neighbor_index = neighbor_indices.col(n);
-      GvdVoxel* neighbor = gvd_layer_->getVoxelPtrByGlobalIndex(neighbor_index);
-      if (!neighbor) {
-        continue;
-      }
+    worker_stats = nullptr;
+  };
 
-      if (!neighbor->observed) {
-        continue;
+  thread_pool_->parallelFor(num_workers, worker);
+
+  for (const auto& stats : pass_stats) {
+    update_stats_.merge(stats);
+  }
+}
+
+void GvdIntegrator::processTsdfBlocksParallel(const BlockIndexList& blocks) {
+  BlockWavefront::BlockList to_process;
+  for (const auto& idx : blocks) {
+    WavefrontBlock* block = wavefront_->getBlock(idx);
+    CHECK(block != nullptr) << "missing wavefront block " << idx.transpose();
+    to_process.push_back(block);
+  }
+
+  // TSDF propagation only pushes voxels from the block being processed
+  runWavefrontPass(to_process, [&](WavefrontBlock& block) {
+    std::lock_guard<std::mutex> lock(block.mutex);
+    processTsdfBlock(tsdf_layer_->getBlockByIndex(block.index), block.index);
+  });
+}
+
+void GvdIntegrator::processRaiseSetParallel() {
+  BlockWavefront::BlockList blocks = wavefront_->getRaiseBlocks();
+  while (!blocks.empty()) {
+    runWavefrontPass(blocks, [&](WavefrontBlock& block) {
+      while (true) {
+        GlobalIndex index;
+        {  // scope for popping from the block queue
+          std::lock_guard<std::mutex> block_lock(block.mutex);
+          if (block.raise.empty()) {
+            return;
+          }
+
+          index = block.raise.front();
+          block.raise.pop();
+        }
+
+        WavefrontLock lock;
+        wavefront_->getTouchedBlocks(index, lock);
+        lock.lock();
+        processRaiseVoxel(index);
+        block.touched.push_back(index);
       }
+    });
+
+    // raised voxels on block boundaries hand off work to neighboring blocks
+    blocks = wavefront_->getRaiseBlocks();
+  }
+}
 
-      FloatingPoint distance = NeighborhoodLookupTables::kDistances[n] * voxel_size_;
-      processNeighbor(voxel, index, distance, neighbor_index, *neighbor);
+void GvdIntegrator::processLowerSetParallel() {
+  // voxels are lowered one bucket at a time (i.e., delta-stepping) to keep the
+  // processing order close to the single bucket queue used by processLowerSet
+  for (size_t bucket = 0; bucket < wavefront_->numBuckets(); ++bucket) {
+    BlockWavefront::BlockList blocks = wavefront_->getLowerBlocks(bucket);
+    while (!blocks.empty()) {
+      runWavefrontPass(blocks, [&](WavefrontBlock& block) {
+        while (true) {
+          GlobalIndex index;
+          {  // scope for popping from the block queue
+            std::lock_guard<std::mutex> block_lock(block.mutex);
+            if (!block.hasLower(bucket)) {
+              return;
+            }
+
+            index = block.popLower();
+          }
+
+          WavefrontLock lock;
+          wavefront_->getTouchedBlocks(index, lock);
+          lock.lock();
+          processLowerVoxel(index);
+          block.touched.push_back(index);
+        }
+      });
+
+      blocks = wavefront_->getLowerBlocks(bucket);
     }
   }
 }
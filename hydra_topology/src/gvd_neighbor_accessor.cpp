@@ -0,0 +1,102 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/gvd_neighbor_accessor.h"
+
+namespace hydra {
+namespace topology {
+
+GvdNeighborAccessor::GvdNeighborAccessor(Layer<GvdVoxel>& layer)
+    : layer_(layer),
+      voxels_per_side_(layer.voxels_per_side()),
+      block_(nullptr),
+      linear_index_(0),
+      interior_(false) {
+  for (int n = 0; n < GvdNeighborhood::kOffsets.cols(); ++n) {
+    const auto& offset = GvdNeighborhood::kOffsets.col(n);
+    linear_offsets_[n] =
+        offset.x() + voxels_per_side_ * (offset.y() + voxels_per_side_ * offset.z());
+  }
+}
+
+GvdVoxel* GvdNeighborAccessor::setIndex(const GlobalIndex& index) {
+  index_ = index;
+  blocks_.fill(nullptr);
+
+  BlockIndex block_index;
+  voxblox::getBlockAndVoxelIndexFromGlobalVoxelIndex(
+      index, voxels_per_side_, &block_index, &voxel_index_);
+
+  block_ = layer_.getBlockPtrByIndex(block_index).get();
+  if (!block_) {
+    interior_ = false;
+    return nullptr;
+  }
+
+  blocks_[13] = block_;
+  linear_index_ = block_->computeLinearIndexFromVoxelIndex(voxel_index_);
+  position_ = block_->computeCoordinatesFromVoxelIndex(voxel_index_);
+
+  BlockIndex offset_min;
+  BlockIndex offset_max;
+  for (int i = 0; i < 3; ++i) {
+    offset_min(i) = (voxel_index_(i) == 0) ? -1 : 0;
+    offset_max(i) = (voxel_index_(i) == voxels_per_side_ - 1) ? 1 : 0;
+  }
+
+  interior_ = offset_min.isZero() && offset_max.isZero();
+  if (interior_) {
+    return &block_->getVoxelByLinearIndex(linear_index_);
+  }
+
+  BlockIndex offset;
+  for (offset.x() = offset_min.x(); offset.x() <= offset_max.x(); ++offset.x()) {
+    for (offset.y() = offset_min.y(); offset.y() <= offset_max.y(); ++offset.y()) {
+      for (offset.z() = offset_min.z(); offset.z() <= offset_max.z(); ++offset.z()) {
+        if (offset.isZero()) {
+          continue;
+        }
+
+        const size_t cache_index =
+            (offset.x() + 1) + 3 * (offset.y() + 1) + 9 * (offset.z() + 1);
+        blocks_[cache_index] = layer_.getBlockPtrByIndex(block_index + offset).get();
+      }
+    }
+  }
+
+  return &block_->getVoxelByLinearIndex(linear_index_);
+}
+
+}  // namespace topology
+}  // namespace hydra
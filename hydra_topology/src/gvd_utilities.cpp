@@ -79,8 +79,8 @@ VoronoiCondition checkVoronoi(const VoronoiCheckConfig& cfg,
     return result;
   }
 
-  Eigen::Map<const GlobalIndex> neighbor_parent(neighbor.parent);
-  Eigen::Map<const GlobalIndex> current_parent(current.parent);
+  const GlobalIndex neighbor_parent = getParentIndex(neighbor);
+  const GlobalIndex current_parent = getParentIndex(current);
 
   if (!isParentUnique(cfg, current_idx, current_parent, neighbor_parent)) {
     return result;
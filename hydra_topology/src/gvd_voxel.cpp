@@ -46,7 +46,7 @@ std::ostream& operator<<(std::ostream& out, const GvdVoxel& voxel) {
   out << (voxel.is_voronoi_parent ? 'y' : 'n');
   out << ", distance=" << voxel.distance << " -> ";
   if (voxel.has_parent) {
-    out << Eigen::Map<const GlobalIndex>(voxel.parent).transpose();
+    out << getParentIndex(voxel).transpose();
   } else {
     out << "unknown";
   }
@@ -56,10 +56,6 @@ std::ostream& operator<<(std::ostream& out, const GvdVoxel& voxel) {
   } else {
     out << "n";
   }
-  if (voxel.is_voronoi_parent) {
-    out << ", nearest_voronoi="
-        << Eigen::Map<const GlobalIndex>(voxel.nearest_voronoi).transpose();
-  }
   out << ">";
   return out;
 }
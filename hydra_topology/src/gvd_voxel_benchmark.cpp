@@ -0,0 +1,220 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/gvd_voxel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using hydra::topology::GvdVoxel;
+using hydra::topology::setParentIndex;
+using Clock = std::chrono::steady_clock;
+
+// GvdVoxel layout before the flags were packed (kept for comparison only)
+struct LegacyGvdVoxel {
+  float distance;
+  bool observed = false;
+  bool fixed = false;
+  bool in_queue = false;
+
+  bool has_parent = false;
+  voxblox::GlobalIndex::Scalar parent[3];
+  voxblox::Point::Scalar parent_pos[3];
+
+  uint8_t num_extra_basis = 0;
+
+  bool on_surface = false;
+  size_t block_vertex_index = 123456789;
+  int32_t mesh_block[3];
+
+  bool is_voronoi_parent = false;
+  voxblox::GlobalIndex::Scalar nearest_voronoi[3];
+  voxblox::GlobalIndex::Scalar nearest_voronoi_distance;
+};
+
+inline void setParent(LegacyGvdVoxel& voxel, const voxblox::GlobalIndex& index) {
+  voxel.parent[0] = index.x();
+  voxel.parent[1] = index.y();
+  voxel.parent[2] = index.z();
+}
+
+inline void setParent(GvdVoxel& voxel, const voxblox::GlobalIndex& index) {
+  setParentIndex(voxel, index);
+}
+
+constexpr int kVoxelsPerSide = 16;
+constexpr int kVoxelsPerBlock = kVoxelsPerSide * kVoxelsPerSide * kVoxelsPerSide;
+
+struct BenchmarkResult {
+  double sweep_ms = 0.0;
+  double relax_ms = 0.0;
+  size_t num_updated = 0;
+};
+
+template <typename Voxel>
+std::vector<std::vector<Voxel>> makeBlocks(size_t num_blocks) {
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> distances(-1.0f, 2.0f);
+
+  std::vector<std::vector<Voxel>> blocks(num_blocks);
+  for (auto& block : blocks) {
+    block.resize(kVoxelsPerBlock);
+    for (auto& voxel : block) {
+      voxel.distance = distances(rng);
+      voxel.observed = true;
+      voxel.fixed = std::abs(voxel.distance) < 0.2f;
+      voxel.on_surface = voxel.fixed;
+    }
+  }
+  return blocks;
+}
+
+template <typename Func>
+double timeMs(const Func& func) {
+  const auto start = Clock::now();
+  func();
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// linear pass over every voxel (the access pattern of TSDF propagation)
+template <typename Voxel>
+size_t sweepBlocks(std::vector<std::vector<Voxel>>& blocks) {
+  size_t num_observed = 0;
+  for (auto& block : blocks) {
+    for (auto& voxel : block) {
+      if (!voxel.observed || voxel.fixed) {
+        continue;
+      }
+
+      ++num_observed;
+      voxel.in_queue = voxel.distance < 1.0f;
+    }
+  }
+  return num_observed;
+}
+
+// 26-connected relaxation inside each block (the access pattern of the wavefront)
+template <typename Voxel>
+size_t relaxBlocks(std::vector<std::vector<Voxel>>& blocks, float voxel_size) {
+  size_t num_updated = 0;
+  auto linear = [](int x, int y, int z) {
+    return x + kVoxelsPerSide * (y + kVoxelsPerSide * z);
+  };
+
+  for (auto& block : blocks) {
+    for (int z = 1; z < kVoxelsPerSide - 1; ++z) {
+      for (int y = 1; y < kVoxelsPerSide - 1; ++y) {
+        for (int x = 1; x < kVoxelsPerSide - 1; ++x) {
+          const Voxel& voxel = block[linear(x, y, z)];
+          if (!voxel.observed) {
+            continue;
+          }
+
+          for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+              for (int dx = -1; dx <= 1; ++dx) {
+                Voxel& neighbor = block[linear(x + dx, y + dy, z + dz)];
+                if (!neighbor.observed || neighbor.fixed) {
+                  continue;
+                }
+
+                const int steps = dx * dx + dy * dy + dz * dz;
+                const float step = voxel_size * std::sqrt(static_cast<float>(steps));
+                const float candidate = std::abs(voxel.distance) + step;
+                if (candidate >= std::abs(neighbor.distance)) {
+                  continue;
+                }
+
+                neighbor.distance = std::copysign(candidate, neighbor.distance);
+                neighbor.has_parent = true;
+                setParent(neighbor, voxblox::GlobalIndex(x, y, z));
+                ++num_updated;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  return num_updated;
+}
+
+template <typename Voxel>
+BenchmarkResult benchmarkLayout(size_t num_blocks, int num_trials) {
+  BenchmarkResult result;
+  for (int trial = 0; trial < num_trials; ++trial) {
+    auto blocks = makeBlocks<Voxel>(num_blocks);
+    result.sweep_ms += timeMs([&]() { sweepBlocks(blocks); });
+    result.relax_ms +=
+        timeMs([&]() { result.num_updated = relaxBlocks(blocks, 0.1f); });
+  }
+
+  result.sweep_ms /= num_trials;
+  result.relax_ms /= num_trials;
+  return result;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 3) {
+    std::cerr << "usage: gvd_voxel_benchmark [NUM_BLOCKS=256] [NUM_TRIALS=5]"
+              << std::endl;
+    return 1;
+  }
+
+  const size_t num_blocks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+  const int num_trials = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+  const auto legacy = benchmarkLayout<LegacyGvdVoxel>(num_blocks, num_trials);
+  const auto packed = benchmarkLayout<GvdVoxel>(num_blocks, num_trials);
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "layout,voxel_bytes,layer_mb,sweep_ms,relax_ms,num_updated" << std::endl;
+  auto print = [&](const std::string& name, size_t bytes, const BenchmarkResult& r) {
+    const double layer_mb = bytes * kVoxelsPerBlock * num_blocks / (1024.0 * 1024.0);
+    std::cout << name << "," << bytes << "," << layer_mb << "," << r.sweep_ms << ","
+              << r.relax_ms << "," << r.num_updated << std::endl;
+  };
+  print("legacy", sizeof(LegacyGvdVoxel), legacy);
+  print("packed", sizeof(GvdVoxel), packed);
+
+  // both layouts have to do the same work for the timings to be comparable
+  return legacy.num_updated == packed.num_updated ? 0 : 2;
+}
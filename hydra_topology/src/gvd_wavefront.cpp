@@ -0,0 +1,256 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/gvd_wavefront.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace hydra {
+namespace topology {
+
+WavefrontBlock::WavefrontBlock(const BlockIndex& index, size_t num_buckets)
+    : index(index), lower(num_buckets), num_lower(0), min_bucket(num_buckets) {}
+
+void WavefrontBlock::pushLower(const GlobalIndex& index, size_t bucket) {
+  lower[bucket].push(index);
+  num_lower++;
+  min_bucket = std::min(min_bucket, bucket);
+}
+
+bool WavefrontBlock::hasLower(size_t max_bucket) const {
+  return num_lower > 0 && min_bucket <= max_bucket;
+}
+
+GlobalIndex WavefrontBlock::popLower() {
+  DCHECK(num_lower > 0);
+  GlobalIndex index = lower[min_bucket].front();
+  lower[min_bucket].pop();
+  num_lower--;
+
+  // keep min_bucket pointing at a non-empty bucket so hasLower stays exact
+  if (!num_lower) {
+    min_bucket = lower.size();
+  } else {
+    while (lower[min_bucket].empty()) {
+      min_bucket++;
+    }
+  }
+
+  return index;
+}
+
+void WavefrontBlock::clear() {
+  raise = AlignedQueue<GlobalIndex>();
+  for (auto& bucket : lower) {
+    bucket = AlignedQueue<GlobalIndex>();
+  }
+
+  num_lower = 0;
+  min_bucket = lower.size();
+  touched.clear();
+}
+
+WavefrontLock::~WavefrontLock() { unlock(); }
+
+void WavefrontLock::add(WavefrontBlock* block) {
+  DCHECK(!locked_);
+  if (!block) {
+    return;
+  }
+
+  blocks_[num_blocks_] = block;
+  num_blocks_++;
+}
+
+void WavefrontLock::lock() {
+  // blocks are always locked in address order so that threads working on adjacent
+  // blocks can't deadlock
+  std::sort(blocks_.begin(), blocks_.begin() + num_blocks_);
+  for (size_t i = 0; i < num_blocks_; ++i) {
+    blocks_[i]->mutex.lock();
+  }
+
+  locked_ = true;
+}
+
+void WavefrontLock::unlock() {
+  if (!locked_) {
+    return;
+  }
+
+  for (size_t i = 0; i < num_blocks_; ++i) {
+    blocks_[i]->mutex.unlock();
+  }
+
+  locked_ = false;
+}
+
+bool WavefrontLock::contains(const WavefrontBlock* block) const {
+  return std::find(blocks_.begin(), blocks_.begin() + num_blocks_, block) !=
+         blocks_.begin() + num_blocks_;
+}
+
+BlockWavefront::BlockWavefront(int voxels_per_side,
+                               int num_buckets,
+                               FloatingPoint max_distance)
+    : voxels_per_side_(voxels_per_side),
+      num_buckets_(num_buckets),
+      max_distance_(max_distance) {
+  CHECK_GT(num_buckets, 1);
+  CHECK_GT(max_distance, 0.0f);
+}
+
+void BlockWavefront::syncBlocks(const Layer<GvdVoxel>& layer) {
+  auto iter = blocks_.begin();
+  while (iter != blocks_.end()) {
+    if (!layer.hasBlock(iter->first)) {
+      iter = blocks_.erase(iter);
+      continue;
+    }
+
+    ++iter;
+  }
+
+  BlockIndexList blocks;
+  layer.getAllAllocatedBlocks(&blocks);
+  for (const auto& index : blocks) {
+    if (blocks_.count(index)) {
+      continue;
+    }
+
+    blocks_.emplace(index, WavefrontBlock::Ptr(new WavefrontBlock(index, num_buckets_)));
+  }
+}
+
+WavefrontBlock* BlockWavefront::getBlock(const BlockIndex& index) const {
+  auto iter = blocks_.find(index);
+  return iter == blocks_.end() ? nullptr : iter->second.get();
+}
+
+WavefrontBlock* BlockWavefront::getBlockForVoxel(const GlobalIndex& index) const {
+  BlockIndex block_index;
+  VoxelIndex voxel_index;
+  voxblox::getBlockAndVoxelIndexFromGlobalVoxelIndex(
+      index, voxels_per_side_, &block_index, &voxel_index);
+  return getBlock(block_index);
+}
+
+void BlockWavefront::getTouchedBlocks(const GlobalIndex& index,
+                                      WavefrontLock& lock) const {
+  BlockIndex block_index;
+  VoxelIndex voxel_index;
+  voxblox::getBlockAndVoxelIndexFromGlobalVoxelIndex(
+      index, voxels_per_side_, &block_index, &voxel_index);
+
+  // only voxels on a block face have neighbors in other blocks
+  BlockIndex offset_min;
+  BlockIndex offset_max;
+  for (int i = 0; i < 3; ++i) {
+    offset_min(i) = (voxel_index(i) == 0) ? -1 : 0;
+    offset_max(i) = (voxel_index(i) == voxels_per_side_ - 1) ? 1 : 0;
+  }
+
+  BlockIndex offset;
+  for (offset.x() = offset_min.x(); offset.x() <= offset_max.x(); ++offset.x()) {
+    for (offset.y() = offset_min.y(); offset.y() <= offset_max.y(); ++offset.y()) {
+      for (offset.z() = offset_min.z(); offset.z() <= offset_max.z(); ++offset.z()) {
+        lock.add(getBlock(block_index + offset));
+      }
+    }
+  }
+}
+
+size_t BlockWavefront::getBucket(FloatingPoint distance) const {
+  // matches the bucket assignment of voxblox::BucketQueue
+  const double bucket_interval = max_distance_ / (num_buckets_ - 1);
+  const size_t bucket = std::floor(std::abs(distance) / bucket_interval);
+  return std::min(bucket, num_buckets_ - 1);
+}
+
+void BlockWavefront::pushLower(const GlobalIndex& index, FloatingPoint distance) {
+  WavefrontBlock* block = getBlockForVoxel(index);
+  CHECK(block != nullptr) << "voxel " << index.transpose() << " has no block";
+  block->pushLower(index, getBucket(distance));
+}
+
+void BlockWavefront::pushRaise(const GlobalIndex& index) {
+  WavefrontBlock* block = getBlockForVoxel(index);
+  CHECK(block != nullptr) << "voxel " << index.transpose() << " has no block";
+  block->raise.push(index);
+}
+
+BlockWavefront::BlockList BlockWavefront::getLowerBlocks(size_t max_bucket) const {
+  BlockList blocks;
+  for (const auto& id_block_pair : blocks_) {
+    if (id_block_pair.second->hasLower(max_bucket)) {
+      blocks.push_back(id_block_pair.second.get());
+    }
+  }
+
+  return blocks;
+}
+
+BlockWavefront::BlockList BlockWavefront::getRaiseBlocks() const {
+  BlockList blocks;
+  for (const auto& id_block_pair : blocks_) {
+    if (!id_block_pair.second->raise.empty()) {
+      blocks.push_back(id_block_pair.second.get());
+    }
+  }
+
+  return blocks;
+}
+
+BlockWavefront::BlockList BlockWavefront::getAllBlocks() const {
+  BlockList blocks;
+  for (const auto& id_block_pair : blocks_) {
+    blocks.push_back(id_block_pair.second.get());
+  }
+
+  return blocks;
+}
+
+void BlockWavefront::popTouched(voxblox::AlignedVector<GlobalIndex>& touched) {
+  for (auto& id_block_pair : blocks_) {
+    auto& block_touched = id_block_pair.second->touched;
+    touched.insert(touched.end(), block_touched.begin(), block_touched.end());
+    block_touched.clear();
+  }
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,71 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/mesh_change_tracker.h"
+
+namespace hydra {
+namespace topology {
+
+void MeshChangeTracker::markUpdated(const BlockIndexList& blocks) {
+  ++generation_;
+  for (const auto& index : blocks) {
+    blocks_[index] = generation_;
+  }
+}
+
+void MeshChangeTracker::removeBlock(const BlockIndex& index) { blocks_.erase(index); }
+
+BlockIndexList MeshChangeTracker::getUpdatedSince(uint64_t generation) const {
+  BlockIndexList updated;
+  for (const auto& index_generation_pair : blocks_) {
+    if (index_generation_pair.second > generation) {
+      updated.push_back(index_generation_pair.first);
+    }
+  }
+
+  return updated;
+}
+
+BlockIndexList MeshChangeTracker::getAllBlocks() const {
+  BlockIndexList blocks;
+  blocks.reserve(blocks_.size());
+  for (const auto& index_generation_pair : blocks_) {
+    blocks.push_back(index_generation_pair.first);
+  }
+
+  return blocks;
+}
+
+}  // namespace topology
+}  // namespace hydra
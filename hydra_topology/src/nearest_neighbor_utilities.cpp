@@ -37,22 +37,29 @@
 
 #include <nanoflann.hpp>
 
+#include <algorithm>
+
 namespace hydra {
 namespace topology {
 
 using nanoflann::KDTreeSingleIndexAdaptor;
-using nanoflann::KDTreeSingleIndexDynamicAdaptor;
 using nanoflann::L2_Simple_Adaptor;
 using GlobalIndexVector = voxblox::AlignedVector<GlobalIndex>;
 
 struct GraphKdTreeAdaptor {
   GraphKdTreeAdaptor(const SceneGraphLayer& layer, const std::vector<NodeId>& nodes)
-      : layer(layer), nodes(nodes) {}
+      : nodes(nodes), positions(3, nodes.size()) {
+    // positions are copied once so that index building and searching don't need a
+    // graph lookup for every coordinate access
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      positions.col(i) = layer.getPosition(nodes[i]);
+    }
+  }
 
   inline size_t kdtree_get_point_count() const { return nodes.size(); }
 
   inline double kdtree_get_pt(const size_t idx, const size_t dim) const {
-    return layer.getPosition(nodes[idx])(dim);
+    return positions(dim, idx);
   }
 
   template <class T>
@@ -60,10 +67,61 @@ struct GraphKdTreeAdaptor {
     return false;
   }
 
-  const SceneGraphLayer& layer;
   std::vector<NodeId> nodes;
+  Eigen::Matrix3Xd positions;
+};
+
+namespace {
+
+struct NodeResult {
+  NodeId node;
+  size_t index;
+  double distance;
 };
 
+template <typename Finder>
+void findManyNodes(const Finder& finder,
+                   const Eigen::Matrix3Xd& positions,
+                   size_t num_to_find,
+                   bool skip_first,
+                   const NearestNodeFinder::BatchCallback& callback,
+                   ThreadPool* thread_pool) {
+  const size_t num_queries = positions.cols();
+  if (!thread_pool || thread_pool->numThreads() <= 1) {
+    for (size_t i = 0; i < num_queries; ++i) {
+      finder.find(positions.col(i),
+                  num_to_find,
+                  skip_first,
+                  [&](NodeId node, size_t index, double distance) {
+                    callback(i, node, index, distance);
+                  });
+    }
+    return;
+  }
+
+  std::vector<std::vector<NodeResult>> results(num_queries);
+  // a single query is too cheap to be worth a task of its own
+  thread_pool->parallelFor(
+      num_queries,
+      [&](size_t i) {
+        finder.find(positions.col(i),
+                    num_to_find,
+                    skip_first,
+                    [&](NodeId node, size_t index, double distance) {
+                      results[i].push_back({node, index, distance});
+                    });
+      },
+      32);
+
+  for (size_t i = 0; i < num_queries; ++i) {
+    for (const auto& result : results[i]) {
+      callback(i, result.node, result.index, result.distance);
+    }
+  }
+}
+
+}  // namespace
+
 struct NearestNodeFinder::Detail {
   using Dist = L2_Simple_Adaptor<double, GraphKdTreeAdaptor>;
   using KDTree = KDTreeSingleIndexAdaptor<Dist, GraphKdTreeAdaptor, 3, size_t>;
@@ -95,19 +153,248 @@ NearestNodeFinder::~NearestNodeFinder() {}
 void NearestNodeFinder::find(const Eigen::Vector3d& position,
                              size_t num_to_find,
                              bool skip_first,
-                             const NearestNodeFinder::Callback& callback) {
+                             const NearestNodeFinder::Callback& callback) const {
   std::vector<size_t> nn_indices(num_to_find);
   std::vector<double> distances(num_to_find);
 
   size_t num_found = internals_->kdtree->knnSearch(
       position.data(), num_to_find, nn_indices.data(), distances.data());
 
-  size_t i = skip_first ? 1 : 0;
-  for (i = 0; i < num_found; ++i) {
+  for (size_t i = skip_first ? 1 : 0; i < num_found; ++i) {
     callback(internals_->adaptor.nodes[nn_indices[i]], nn_indices[i], distances[i]);
   }
 }
 
+void NearestNodeFinder::findMany(const Eigen::Matrix3Xd& positions,
+                                 size_t num_to_find,
+                                 bool skip_first,
+                                 const BatchCallback& callback,
+                                 ThreadPool* thread_pool) const {
+  findManyNodes(*this, positions, num_to_find, skip_first, callback, thread_pool);
+}
+
+struct IncrementalNodeFinder::Detail {
+  struct Entry {
+    NodeId node;
+    Eigen::Vector3d position;
+  };
+
+  using Cell = std::vector<Entry>;
+  using CellMap = voxblox::LongIndexHashMapType<Cell>::type;
+  using NodeCellMap = std::unordered_map<NodeId, GlobalIndex>;
+  using Result = std::pair<double, NodeId>;
+
+  explicit Detail(double cell_size) : cell_size(cell_size) {
+    CHECK_GT(cell_size, 0.0) << "invalid cell size";
+  }
+
+  inline GlobalIndex getCell(const Eigen::Vector3d& position) const {
+    return (position / cell_size).array().floor().cast<GlobalIndex::Scalar>();
+  }
+
+  void eraseFromCell(NodeId node, const GlobalIndex& cell_index) {
+    auto iter = cells.find(cell_index);
+    CHECK(iter != cells.end());
+    auto& cell = iter->second;
+    for (size_t i = 0; i < cell.size(); ++i) {
+      if (cell[i].node != node) {
+        continue;
+      }
+
+      cell[i] = cell.back();
+      cell.pop_back();
+      break;
+    }
+
+    if (cell.empty()) {
+      cells.erase(iter);
+    }
+  }
+
+  void expandBounds(const GlobalIndex& cell_index) {
+    if (node_cells.size() == 1) {
+      min_cell = cell_index;
+      max_cell = cell_index;
+      return;
+    }
+
+    min_cell = min_cell.cwiseMin(cell_index);
+    max_cell = max_cell.cwiseMax(cell_index);
+  }
+
+  inline void checkCell(const Cell& cell,
+                        const Eigen::Vector3d& position,
+                        size_t num_to_find,
+                        std::vector<Result>& best) const {
+    // best is a max-heap of the closest nodes so far, ordered by distance and id to
+    // keep results deterministic between equidistant nodes
+    for (const auto& entry : cell) {
+      const Result result{(entry.position - position).squaredNorm(), entry.node};
+      if (best.size() < num_to_find) {
+        best.push_back(result);
+        std::push_heap(best.begin(), best.end());
+      } else if (result < best.front()) {
+        std::pop_heap(best.begin(), best.end());
+        best.back() = result;
+        std::push_heap(best.begin(), best.end());
+      }
+    }
+  }
+
+  void checkShell(const GlobalIndex& center,
+                  int64_t radius,
+                  const Eigen::Vector3d& position,
+                  size_t num_to_find,
+                  std::vector<Result>& best) const {
+    for (int64_t dx = -radius; dx <= radius; ++dx) {
+      for (int64_t dy = -radius; dy <= radius; ++dy) {
+        const bool on_face = std::abs(dx) == radius || std::abs(dy) == radius;
+        // interior columns only intersect the shell at the top and bottom
+        const int64_t dz_step = (on_face || radius == 0) ? 1 : 2 * radius;
+        for (int64_t dz = -radius; dz <= radius; dz += dz_step) {
+          const auto iter = cells.find(center + GlobalIndex(dx, dy, dz));
+          if (iter != cells.end()) {
+            checkCell(iter->second, position, num_to_find, best);
+          }
+        }
+      }
+    }
+  }
+
+  const double cell_size;
+  CellMap cells;
+  NodeCellMap node_cells;
+  //! bounds on the occupied cells (only ever grown until the index is empty)
+  GlobalIndex min_cell;
+  GlobalIndex max_cell;
+};
+
+IncrementalNodeFinder::IncrementalNodeFinder(double cell_size)
+    : internals_(new Detail(cell_size)) {}
+
+IncrementalNodeFinder::~IncrementalNodeFinder() {}
+
+void IncrementalNodeFinder::insert(NodeId node, const Eigen::Vector3d& position) {
+  const GlobalIndex cell_index = internals_->getCell(position);
+
+  auto iter = internals_->node_cells.find(node);
+  if (iter != internals_->node_cells.end()) {
+    if (iter->second == cell_index) {
+      for (auto& entry : internals_->cells.at(cell_index)) {
+        if (entry.node == node) {
+          entry.position = position;
+          return;
+        }
+      }
+    }
+
+    internals_->eraseFromCell(node, iter->second);
+    iter->second = cell_index;
+  } else {
+    internals_->node_cells.emplace(node, cell_index);
+  }
+
+  internals_->cells[cell_index].push_back({node, position});
+  internals_->expandBounds(cell_index);
+}
+
+bool IncrementalNodeFinder::erase(NodeId node) {
+  auto iter = internals_->node_cells.find(node);
+  if (iter == internals_->node_cells.end()) {
+    return false;
+  }
+
+  internals_->eraseFromCell(node, iter->second);
+  internals_->node_cells.erase(iter);
+  return true;
+}
+
+void IncrementalNodeFinder::update(const SceneGraphLayer& layer,
+                                   const std::unordered_set<NodeId>& nodes) {
+  std::vector<NodeId> to_remove;
+  for (const auto& id_cell_pair : internals_->node_cells) {
+    if (!nodes.count(id_cell_pair.first)) {
+      to_remove.push_back(id_cell_pair.first);
+    }
+  }
+
+  for (const auto node : to_remove) {
+    erase(node);
+  }
+
+  for (const auto node : nodes) {
+    insert(node, layer.getPosition(node));
+  }
+}
+
+bool IncrementalNodeFinder::contains(NodeId node) const {
+  return internals_->node_cells.count(node);
+}
+
+size_t IncrementalNodeFinder::size() const { return internals_->node_cells.size(); }
+
+void IncrementalNodeFinder::clear() {
+  internals_->cells.clear();
+  internals_->node_cells.clear();
+}
+
+void IncrementalNodeFinder::find(const Eigen::Vector3d& position,
+                                 size_t num_to_find,
+                                 bool skip_first,
+                                 const Callback& callback) const {
+  if (num_to_find == 0 || internals_->node_cells.empty()) {
+    return;
+  }
+
+  const Detail& detail = *internals_;
+  const GlobalIndex center = detail.getCell(position);
+  // shells past the occupied bounds can't contain any nodes
+  const int64_t max_radius = std::max<int64_t>(
+      0, std::max((center - detail.min_cell).maxCoeff(),
+                  (detail.max_cell - center).maxCoeff()));
+
+  std::vector<Detail::Result> best;
+  best.reserve(num_to_find);
+  for (int64_t radius = 0; radius <= max_radius; ++radius) {
+    const int64_t inner = std::max<int64_t>(0, 2 * radius - 1);
+    const int64_t outer = 2 * radius + 1;
+    const size_t shell_size = outer * outer * outer - inner * inner * inner;
+    if (shell_size > detail.cells.size()) {
+      // sparse index: cheaper to check the remaining occupied cells directly
+      for (const auto& index_cell_pair : detail.cells) {
+        const int64_t cell_radius =
+            (index_cell_pair.first - center).cwiseAbs().maxCoeff();
+        if (cell_radius >= radius) {
+          detail.checkCell(index_cell_pair.second, position, num_to_find, best);
+        }
+      }
+      break;
+    }
+
+    detail.checkShell(center, radius, position, num_to_find, best);
+
+    // every node in the next shell is at least radius cells away
+    const double min_next_distance = radius * detail.cell_size;
+    if (best.size() == num_to_find &&
+        best.front().first <= min_next_distance * min_next_distance) {
+      break;
+    }
+  }
+
+  std::sort_heap(best.begin(), best.end());
+  for (size_t i = skip_first ? 1 : 0; i < best.size(); ++i) {
+    callback(best[i].second, i, best[i].first);
+  }
+}
+
+void IncrementalNodeFinder::findMany(const Eigen::Matrix3Xd& positions,
+                                     size_t num_to_find,
+                                     bool skip_first,
+                                     const BatchCallback& callback,
+                                     ThreadPool* thread_pool) const {
+  findManyNodes(*this, positions, num_to_find, skip_first, callback, thread_pool);
+}
+
 struct VoxelKdTreeAdaptor {
   explicit VoxelKdTreeAdaptor(const GlobalIndexVector& indices) : indices(indices) {}
 
@@ -159,104 +446,18 @@ void NearestVoxelFinder::find(const GlobalIndex& index,
   }
 }
 
-// TODO(nathan) not working: bug in nanoflann w.r.t accessing removed indices
-// during index building
-struct GraphDynamicKdTreeAdaptor {
-  GraphDynamicKdTreeAdaptor(const SceneGraphLayer& layer) : layer(layer), count(0) {}
-
-  struct AddInfo {
-    size_t start;
-    size_t num_added = 0;
-  };
-
-  struct RemoveInfo {
-    size_t index = 0;
-    bool valid = false;
-  };
-
-  AddInfo addNodes(const std::unordered_set<NodeId>& new_nodes) {
-    AddInfo info;
-    info.start = count;
-
-    for (const auto& node : new_nodes) {
-      if (curr_nodes.count(node)) {
-        continue;
-      }
-
-      idx_node_map[count] = node;
-      node_idx_map[node] = count;
-      curr_nodes.insert(node);
-
-      info.num_added++;
-      count++;
-    }
-    LOG(WARNING) << "Added " << info.start << " through " << count - 1;
-
-    return info;
-  }
-
-  RemoveInfo removeNode(NodeId node) {
-    RemoveInfo info;
-    if (!curr_nodes.count(node)) {
-      return info;
-    }
-
-    info.index = node_idx_map.at(node);
-    LOG(WARNING) << "Removing " << info.index;
-    node_idx_map.erase(node);
-    idx_node_map.erase(info.index);
-    curr_nodes.erase(node);
-    info.valid = true;
-    return info;
-  }
-
-  inline size_t kdtree_get_point_count() const { return curr_nodes.size(); }
-
-  inline double kdtree_get_pt(const size_t idx, const size_t dim) const {
-    if (!idx_node_map.count(idx)) {
-      std::stringstream ss;
-      auto iter = idx_node_map.begin();
-      ss << "[";
-      while (iter != idx_node_map.end()) {
-        ss << iter->first;
-        ++iter;
-        if (iter != idx_node_map.end()) {
-          ss << ", ";
-        }
-      }
-      ss << "]";
-
-      LOG(FATAL) << "idx: " << idx << " doesn't exist. current count: " << count
-                 << " indices: " << ss.str();
-    }
-    return layer.getPosition(idx_node_map.at(idx))(dim);
-  }
-
-  template <class T>
-  bool kdtree_get_bbox(T&) const {
-    return false;
-  }
-
-  const SceneGraphLayer& layer;
-  size_t count;
-  std::map<size_t, NodeId> idx_node_map;
-  std::map<NodeId, size_t> node_idx_map;
-  std::unordered_set<NodeId> curr_nodes;
-};
-
 FurthestIndexResult findFurthestIndexFromLine(const GlobalIndexVector& indices,
                                               const GlobalIndex& start,
                                               const GlobalIndex& end,
                                               size_t number_source_edges) {
   FurthestIndexResult result;
 
-  GlobalIndexVector line = makeBresenhamLine(start, end);
-  if (line.empty()) {
-    return result;
+  if ((end - start).cwiseAbs().maxCoeff() <= 1) {
+    return result;  // no interior line voxels
   }
 
   NearestVoxelFinder nearest_voxel_finder(indices);
-  for (const auto& line_idx : line) {
+  walkBresenhamLine(start, end, [&](const GlobalIndex& line_idx) {
     nearest_voxel_finder.find(
         line_idx, 1, [&](const GlobalIndex& index, size_t nn_index, int64_t distance) {
           if (distance > result.distance || !result.valid) {
@@ -266,7 +467,8 @@ FurthestIndexResult findFurthestIndexFromLine(const GlobalIndexVector& indices,
             result.index = index;
           }
         });
-  }
+    return true;
+  });
 
   return result;
 }
@@ -0,0 +1,118 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/output_pipeline.h"
+
+#include <algorithm>
+
+namespace hydra {
+namespace topology {
+
+OutputPipeline::OutputPipeline(size_t max_pending)
+    : max_pending_(std::max<size_t>(max_pending, 1)),
+      running_(false),
+      should_exit_(false) {
+  worker_ = std::thread(&OutputPipeline::workerLoop, this);
+}
+
+OutputPipeline::~OutputPipeline() {
+  {  // scope for lock
+    std::unique_lock<std::mutex> lock(mutex_);
+    should_exit_ = true;
+  }
+
+  batch_cv_.notify_all();
+  worker_.join();
+}
+
+void OutputPipeline::add(Task task) { current_.push_back(std::move(task)); }
+
+void OutputPipeline::submit() {
+  Batch batch;
+  batch.tasks = std::move(current_);
+  current_.clear();
+
+  {  // scope for lock
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] { return numInFlight() < max_pending_; });
+    batch.submitted = Clock::now();
+    batches_.push_back(std::move(batch));
+    stats_.max_queue_depth = std::max(stats_.max_queue_depth, numInFlight());
+  }
+
+  batch_cv_.notify_one();
+}
+
+void OutputPipeline::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [&] { return numInFlight() == 0; });
+}
+
+OutputPipeline::Stats OutputPipeline::getStats() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.queue_depth = numInFlight();
+  return stats;
+}
+
+void OutputPipeline::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    batch_cv_.wait(lock, [&] { return should_exit_ || !batches_.empty(); });
+    if (batches_.empty()) {
+      return;
+    }
+
+    Batch batch = std::move(batches_.front());
+    batches_.pop_front();
+    running_ = true;
+    lock.unlock();
+
+    const auto start = Clock::now();
+    for (const auto& task : batch.tasks) {
+      task();
+    }
+    const auto end = Clock::now();
+
+    lock.lock();
+    running_ = false;
+    ++stats_.num_batches;
+    stats_.last_wait_s = std::chrono::duration<double>(start - batch.submitted).count();
+    stats_.last_run_s = std::chrono::duration<double>(end - start).count();
+    done_cv_.notify_all();
+  }
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,194 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/thread_pool.h"
+
+#include <algorithm>
+
+namespace hydra {
+namespace topology {
+
+ThreadPool::ThreadPool(size_t num_threads) : num_waiting_(0), should_exit_(false) {
+  for (size_t i = 1; i < num_threads; ++i) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {  // scope for lock
+    std::unique_lock<std::mutex> lock(mutex_);
+    should_exit_ = true;
+  }
+
+  task_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::push(TaskGroup& group, Task task) {
+  bool has_waiting;
+  {  // scope for lock
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++group.num_pending_;
+    tasks_.push_back({std::move(task), &group});
+    has_waiting = num_waiting_ > 0;
+  }
+
+  task_cv_.notify_one();
+  if (has_waiting) {
+    // waiting threads help with new tasks if all workers are busy
+    done_cv_.notify_all();
+  }
+}
+
+void ThreadPool::runTask(std::unique_lock<std::mutex>& lock,
+                         std::deque<QueuedTask>::iterator iter) {
+  QueuedTask next = std::move(*iter);
+  tasks_.erase(iter);
+
+  lock.unlock();
+  std::exception_ptr error;
+  try {
+    next.task();
+  } catch (...) {
+    // the group still has to finish so that wait() can report the error
+    error = std::current_exception();
+  }
+  lock.lock();
+
+  TaskGroup& group = *next.group;
+  if (error && !group.error_) {
+    group.error_ = error;
+  }
+
+  --group.num_pending_;
+  if (!group.num_pending_ && num_waiting_) {
+    done_cv_.notify_all();
+  }
+}
+
+void ThreadPool::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    task_cv_.wait(lock, [&] { return should_exit_ || !tasks_.empty(); });
+    if (tasks_.empty()) {
+      return;
+    }
+
+    runTask(lock, tasks_.begin());
+  }
+}
+
+std::deque<ThreadPool::QueuedTask>::iterator ThreadPool::findTask(
+    const TaskGroup& group) {
+  return std::find_if(tasks_.begin(), tasks_.end(), [&](const QueuedTask& task) {
+    return task.group == &group;
+  });
+}
+
+void ThreadPool::wait(TaskGroup& group) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // only tasks of the group are run here: an unrelated task might block on
+  // something the caller is responsible for
+  auto iter = findTask(group);
+  while (group.num_pending_) {
+    if (iter != tasks_.end()) {
+      runTask(lock, iter);
+      iter = findTask(group);
+      continue;
+    }
+
+    // the remaining tasks of the group are running on other threads
+    ++num_waiting_;
+    done_cv_.wait(lock, [&] {
+      iter = findTask(group);
+      return !group.num_pending_ || iter != tasks_.end();
+    });
+    --num_waiting_;
+  }
+
+  if (group.error_) {
+    std::exception_ptr error = group.error_;
+    group.error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::parallelFor(size_t num_tasks,
+                             const std::function<void(size_t)>& callback,
+                             size_t min_chunk_size) {
+  // every index runs even if an earlier one throws (matching separate tasks)
+  const auto run_chunk = [&callback](size_t start, size_t end) {
+    std::exception_ptr error;
+    for (size_t i = start; i < end; ++i) {
+      try {
+        callback(i);
+      } catch (...) {
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  };
+
+  min_chunk_size = std::max<size_t>(min_chunk_size, 1);
+  const size_t max_chunks = (num_tasks + min_chunk_size - 1) / min_chunk_size;
+  const size_t num_chunks = std::min(numThreads(), max_chunks);
+  if (num_chunks <= 1) {
+    run_chunk(0, num_tasks);
+    return;
+  }
+
+  // the first (num_tasks % num_chunks) chunks get one extra index
+  const size_t chunk_size = num_tasks / num_chunks;
+  const size_t remainder = num_tasks % num_chunks;
+
+  TaskGroup group;
+  size_t start = 0;
+  for (size_t c = 0; c < num_chunks; ++c) {
+    const size_t end = start + chunk_size + (c < remainder ? 1 : 0);
+    push(group, [&run_chunk, start, end] { run_chunk(start, end); });
+    start = end;
+  }
+
+  wait(group);
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -40,7 +40,9 @@ namespace topology {
 using visualization_msgs::Marker;
 using visualization_msgs::MarkerArray;
 
-TopologyServerVisualizer::TopologyServerVisualizer(const std::string& ns) : nh_(ns) {
+TopologyServerVisualizer::TopologyServerVisualizer(const ros::NodeHandle& nh,
+                                                   OutputPipeline* pipeline)
+    : nh_(nh), pipeline_(pipeline) {
   gvd_viz_pub_ = nh_.advertise<Marker>("gvd_viz", 1, true);
   gvd_edge_viz_pub_ = nh_.advertise<Marker>("gvd_edge_viz", 1, true);
   graph_viz_pub_ = nh_.advertise<MarkerArray>("graph_viz", 1, true);
@@ -112,7 +114,7 @@ void TopologyServerVisualizer::visualizeGraph(const SceneGraphLayer& graph) {
   }
 
   publishGraphLabels(graph);
-  graph_viz_pub_.publish(markers);
+  publish(graph_viz_pub_, std::move(markers));
 }
 
 void TopologyServerVisualizer::visualizeGvd(const Layer<GvdVoxel>& gvd) const {
@@ -138,7 +140,7 @@ void TopologyServerVisualizer::visualizeGvd(const Layer<GvdVoxel>& gvd) const {
 
   msg.header.stamp = ros::Time::now();
   msg.ns = "gvd_visualizer";
-  gvd_viz_pub_.publish(msg);
+  publish(gvd_viz_pub_, std::move(msg));
 }
 
 void TopologyServerVisualizer::visualizeBlocks(const Layer<GvdVoxel>& gvd,
@@ -153,7 +155,7 @@ void TopologyServerVisualizer::visualizeBlocks(const Layer<GvdVoxel>& gvd,
   msg.header.frame_id = config_.world_frame;
   msg.header.stamp = ros::Time::now();
   msg.ns = "topology_server_blocks";
-  block_viz_pub_.publish(msg);
+  publish(block_viz_pub_, std::move(msg));
 }
 
 void TopologyServerVisualizer::visualizeGvdEdges(const GraphExtractor& graph,
@@ -161,7 +163,7 @@ void TopologyServerVisualizer::visualizeGvdEdges(const GraphExtractor& graph,
   auto msg = makeGvdEdgeMarker(gvd, graph.getGvdEdgeInfo(), graph.getNodeRootMap());
   msg.header.frame_id = config_.world_frame;
   msg.header.stamp = ros::Time::now();
-  gvd_edge_viz_pub_.publish(msg);
+  publish(gvd_edge_viz_pub_, std::move(msg));
 }
 
 void TopologyServerVisualizer::publishGraphLabels(const SceneGraphLayer& graph) {
@@ -204,8 +206,8 @@ void TopologyServerVisualizer::publishGraphLabels(const SceneGraphLayer& graph)
     delete_markers.markers.push_back(delete_label);
   }
 
-  label_viz_pub_.publish(delete_markers);
-  label_viz_pub_.publish(labels);
+  publish(label_viz_pub_, std::move(delete_markers));
+  publish(label_viz_pub_, std::move(labels));
 }
 
 void TopologyServerVisualizer::graphConfigCb(LayerConfig& config, uint32_t) {
@@ -224,14 +226,14 @@ void TopologyServerVisualizer::gvdConfigCb(GvdVisualizerConfig& config, uint32_t
 
 void TopologyServerVisualizer::setupConfigServers() {
   startRqtServer(
-      "~/gvd_visualizer", gvd_config_server_, &TopologyServerVisualizer::gvdConfigCb);
+      "gvd_visualizer", gvd_config_server_, &TopologyServerVisualizer::gvdConfigCb);
 
-  startRqtServer("~/graph_visualizer",
+  startRqtServer("graph_visualizer",
                  graph_config_server_,
                  &TopologyServerVisualizer::graphConfigCb);
 
   startRqtServer(
-      "~/visualizer_colormap", colormap_server_, &TopologyServerVisualizer::colormapCb);
+      "visualizer_colormap", colormap_server_, &TopologyServerVisualizer::colormapCb);
 }
 
 }  // namespace topology
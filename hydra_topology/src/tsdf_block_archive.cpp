@@ -0,0 +1,201 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/tsdf_block_archive.h"
+
+#include <glog/logging.h>
+#include <voxblox/utils/voxel_utils.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <type_traits>
+
+namespace hydra {
+namespace topology {
+
+static_assert(std::is_trivially_copyable<TsdfVoxel>::value,
+              "archived voxels are copied as raw bytes");
+
+TsdfBlockArchive::TsdfBlockArchive(const std::string& path,
+                                   size_t voxels_per_side,
+                                   size_t max_resident_blocks)
+    : path_(path),
+      num_voxels_(voxels_per_side * voxels_per_side * voxels_per_side),
+      max_resident_(max_resident_blocks),
+      fd_(-1),
+      data_(nullptr),
+      capacity_(0) {
+  CHECK_GT(max_resident_, 0u);
+
+  // slots are page-aligned so they can be paged out individually
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t block_bytes = num_voxels_ * sizeof(TsdfVoxel);
+  slot_bytes_ = ((block_bytes + page_size - 1) / page_size) * page_size;
+
+  fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  CHECK_GE(fd_, 0) << "failed to open block archive " << path_ << ": "
+                   << std::strerror(errno);
+
+  resize(max_resident_);
+}
+
+TsdfBlockArchive::~TsdfBlockArchive() {
+  if (data_) {
+    munmap(data_, capacity_ * slot_bytes_);
+  }
+
+  close(fd_);
+  // the slot index only lives in memory, so the file is useless once we're gone
+  unlink(path_.c_str());
+}
+
+void TsdfBlockArchive::archiveBlock(const BlockIndex& index,
+                                    const Block<TsdfVoxel>& block) {
+  CHECK_EQ(block.num_voxels(), num_voxels_);
+  auto iter = slots_.find(index);
+  if (iter == slots_.end()) {
+    iter = slots_.emplace(index, allocateSlot()).first;
+  }
+
+  touchSlot(iter->second);
+  std::memcpy(getSlot(iter->second),
+              &block.getVoxelByLinearIndex(0),
+              num_voxels_ * sizeof(TsdfVoxel));
+}
+
+bool TsdfBlockArchive::hasBlock(const BlockIndex& index) const {
+  return slots_.count(index);
+}
+
+bool TsdfBlockArchive::restoreBlock(const BlockIndex& index, Block<TsdfVoxel>& block) {
+  CHECK_EQ(block.num_voxels(), num_voxels_);
+  auto iter = slots_.find(index);
+  if (iter == slots_.end()) {
+    return false;
+  }
+
+  const TsdfVoxel* archived = getSlot(iter->second);
+  for (size_t i = 0; i < num_voxels_; ++i) {
+    // keeps whatever was observed since the block was archived
+    voxblox::mergeVoxelAIntoVoxelB(archived[i], &block.getVoxelByLinearIndex(i));
+  }
+
+  releaseSlot(iter->second);
+  slots_.erase(iter);
+  return true;
+}
+
+TsdfVoxel* TsdfBlockArchive::getSlot(size_t slot) const {
+  return reinterpret_cast<TsdfVoxel*>(data_ + slot * slot_bytes_);
+}
+
+size_t TsdfBlockArchive::allocateSlot() {
+  if (!free_slots_.empty()) {
+    const size_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    return slot;
+  }
+
+  const size_t slot = slots_.size();
+  if (slot >= capacity_) {
+    resize(2 * capacity_);
+  }
+
+  return slot;
+}
+
+void TsdfBlockArchive::touchSlot(size_t slot) {
+  auto iter = lru_lookup_.find(slot);
+  if (iter != lru_lookup_.end()) {
+    lru_.splice(lru_.begin(), lru_, iter->second);
+    return;
+  }
+
+  lru_.push_front(slot);
+  lru_lookup_[slot] = lru_.begin();
+  if (lru_.size() <= max_resident_) {
+    return;
+  }
+
+  const size_t oldest = lru_.back();
+  lru_.pop_back();
+  lru_lookup_.erase(oldest);
+  evictSlot(oldest);
+}
+
+void TsdfBlockArchive::releaseSlot(size_t slot) {
+  auto iter = lru_lookup_.find(slot);
+  if (iter != lru_lookup_.end()) {
+    lru_.erase(iter->second);
+    lru_lookup_.erase(iter);
+  }
+
+  // contents are dead, so there's nothing to flush
+  madvise(data_ + slot * slot_bytes_, slot_bytes_, MADV_DONTNEED);
+  free_slots_.push_back(slot);
+}
+
+void TsdfBlockArchive::evictSlot(size_t slot) {
+  char* start = data_ + slot * slot_bytes_;
+  // dropping the pages from a shared mapping leaves the (dirty) data in the page
+  // cache, so the kernel writes it back on its own schedule and a quick restore
+  // doesn't have to hit the disk. MS_ASYNC only starts the write-back early
+  msync(start, slot_bytes_, MS_ASYNC);
+  madvise(start, slot_bytes_, MADV_DONTNEED);
+}
+
+void TsdfBlockArchive::resize(size_t num_slots) {
+  if (data_) {
+    // unmapping keeps the contents in the page cache, so there's nothing to flush
+    munmap(data_, capacity_ * slot_bytes_);
+  }
+
+  const size_t num_bytes = num_slots * slot_bytes_;
+  CHECK_EQ(ftruncate(fd_, num_bytes), 0)
+      << "failed to grow block archive " << path_ << ": " << std::strerror(errno);
+
+  void* mapped = mmap(nullptr, num_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  CHECK(mapped != MAP_FAILED) << "failed to map block archive " << path_ << ": "
+                              << std::strerror(errno);
+
+  data_ = static_cast<char*>(mapped);
+  capacity_ = num_slots;
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,114 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_topology/tsdf_downsampler.h"
+
+#include <glog/logging.h>
+
+#include <cmath>
+
+namespace hydra {
+namespace topology {
+
+void downsampleTsdfBlocks(const Layer<TsdfVoxel>& fine,
+                          const BlockIndexList& fine_blocks,
+                          Layer<TsdfVoxel>& coarse) {
+  const int vps = fine.voxels_per_side();
+  const int factor = std::round(coarse.voxel_size() / fine.voxel_size());
+  CHECK_EQ(vps, static_cast<int>(coarse.voxels_per_side()));
+  CHECK_GT(factor, 0);
+  CHECK_EQ(vps % factor, 0) << "downsampling factor must divide voxels per side";
+
+  const GlobalIndex::Scalar coarse_per_block = vps / factor;
+  const float num_fine = factor * factor * factor;
+
+  for (const auto& block_index : fine_blocks) {
+    const auto fine_block = fine.getBlockPtrByIndex(block_index);
+    if (!fine_block) {
+      continue;
+    }
+
+    // voxels per side is a multiple of the factor, so every coarse voxel covered by
+    // the fine block falls into the same coarse block
+    const GlobalIndex coarse_origin =
+        block_index.cast<GlobalIndex::Scalar>() * coarse_per_block;
+    BlockIndex coarse_block_index;
+    VoxelIndex coarse_origin_index;
+    voxblox::getBlockAndVoxelIndexFromGlobalVoxelIndex(
+        coarse_origin, vps, &coarse_block_index, &coarse_origin_index);
+
+    auto coarse_block = coarse.allocateBlockPtrByIndex(coarse_block_index);
+    coarse_block->set_updated(true);
+
+    VoxelIndex offset;
+    for (offset.x() = 0; offset.x() < coarse_per_block; ++offset.x()) {
+      for (offset.y() = 0; offset.y() < coarse_per_block; ++offset.y()) {
+        for (offset.z() = 0; offset.z() < coarse_per_block; ++offset.z()) {
+          float total_weight = 0.0f;
+          float weighted_distance = 0.0f;
+
+          VoxelIndex fine_index;
+          for (int dx = 0; dx < factor; ++dx) {
+            for (int dy = 0; dy < factor; ++dy) {
+              for (int dz = 0; dz < factor; ++dz) {
+                fine_index << offset.x() * factor + dx, offset.y() * factor + dy,
+                    offset.z() * factor + dz;
+                const TsdfVoxel& voxel = fine_block->getVoxelByVoxelIndex(fine_index);
+                if (voxel.weight <= 0.0f) {
+                  continue;
+                }
+
+                total_weight += voxel.weight;
+                weighted_distance += voxel.weight * voxel.distance;
+              }
+            }
+          }
+
+          TsdfVoxel& coarse_voxel =
+              coarse_block->getVoxelByVoxelIndex(coarse_origin_index + offset);
+          if (total_weight <= 0.0f) {
+            coarse_voxel.weight = 0.0f;
+            continue;
+          }
+
+          coarse_voxel.distance = weighted_distance / total_weight;
+          coarse_voxel.weight = total_weight / num_fine;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -48,10 +48,10 @@ static constexpr FloatingPoint kMinSdfDifference = 1e-6;
 void interpolateEdges(const PointMatrix& vertex_coords,
                       const SdfMatrix& vertex_sdf,
                       EdgeIndexMatrix& edge_coords,
-                      std::vector<uint8_t>& edge_status,
-                      const std::vector<GvdVoxel*>& gvd_voxels) {
+                      EdgeStatus& edge_status,
+                      const CubeGvdVoxels& gvd_voxels) {
   // we use the first two bits to denote status
-  edge_status = std::vector<uint8_t>(12, 0);
+  edge_status.fill(0);
   for (size_t i = 0; i < 12; ++i) {
     const int* pairs = voxblox::MarchingCubes::kEdgeIndexPairs[i];
     const int edge0 = pairs[0];
@@ -94,6 +94,27 @@ void interpolateEdges(const PointMatrix& vertex_coords,
   }
 }
 
+void calculateRowConfigs(const SdfColumns& sdf,
+                         const ValidColumns& valid,
+                         Eigen::ArrayXi& configs) {
+  const Eigen::Index num_cubes = sdf.rows() - 1;
+  if (num_cubes <= 0) {
+    configs.resize(0);
+    return;
+  }
+
+  // bits of the four voxels in each z-plane (lower plane is bits 0-3, upper is 4-7)
+  const Eigen::Array<int, 1, 4> column_bits(0x01, 0x02, 0x04, 0x08);
+  const Eigen::ArrayXi plane_bits =
+      ((sdf <= 0.0f).cast<int>().rowwise() * column_bits).rowwise().sum();
+  const Eigen::ArrayXi plane_valid = (valid.rowwise() * column_bits).rowwise().sum();
+
+  configs = plane_bits.head(num_cubes) + 16 * plane_bits.tail(num_cubes);
+  const Eigen::ArrayXi cube_valid =
+      plane_valid.head(num_cubes) + 16 * plane_valid.tail(num_cubes);
+  configs = (cube_valid == 0xFF).select(configs, -1);
+}
+
 VoxelAwareMarchingCubes::VoxelAwareMarchingCubes() : voxblox::MarchingCubes() {}
 
 inline int calculateVertexConfig(const SdfMatrix& vertex_sdf) {
@@ -114,9 +135,9 @@ inline int calculateVertexConfig(const SdfMatrix& vertex_sdf) {
 inline void updateVoxels(const BlockIndex& block,
                          int edge_coord,
                          VertexIndex new_vertex_index,
-                         const std::vector<uint8_t>& status,
-                         const std::vector<GvdVoxel*>& gvd_voxels,
-                         const std::vector<bool>& voxels_in_block) {
+                         const EdgeStatus& status,
+                         const CubeGvdVoxels& gvd_voxels,
+                         const CubeVoxelMask& voxels_in_block) {
   const int* pairs = voxblox::MarchingCubes::kEdgeIndexPairs[edge_coord];
   const uint8_t curr_status = status[edge_coord];
 
@@ -141,8 +162,8 @@ void VoxelAwareMarchingCubes::meshCube(const BlockIndex& block,
                                        const SdfMatrix& vertex_sdf,
                                        VertexIndex* next_index,
                                        Mesh* mesh,
-                                       const std::vector<GvdVoxel*>& gvd_voxels,
-                                       const std::vector<bool>& voxels_in_block) {
+                                       const CubeGvdVoxels& gvd_voxels,
+                                       const CubeVoxelMask& voxels_in_block) {
   // TODO(nathan) references
   DCHECK(next_index != nullptr);
   DCHECK(mesh != nullptr);
@@ -153,7 +174,7 @@ void VoxelAwareMarchingCubes::meshCube(const BlockIndex& block,
   }
 
   EdgeIndexMatrix edge_vertex_coordinates;
-  std::vector<uint8_t> edge_status;
+  EdgeStatus edge_status;
   interpolateEdges(
       vertex_coords, vertex_sdf, edge_vertex_coordinates, edge_status, gvd_voxels);
 
@@ -40,15 +40,15 @@
 #include "hydra_topology/voxel_aware_marching_cubes.h"
 
 #include <glog/logging.h>
-
 #include <voxblox/utils/meshing_utils.h>
 
+#include <atomic>
+
 namespace hydra {
 namespace topology {
 
 using voxblox::IndexElement;
 using voxblox::MeshIntegratorConfig;
-using voxblox::MixedThreadSafeIndex;
 using voxblox::Point;
 namespace vutils = voxblox::utils;
 
@@ -57,34 +57,63 @@ using TsdfBlock = Block<TsdfVoxel>;
 using GvdLayer = Layer<GvdVoxel>;
 using GvdBlock = Block<GvdVoxel>;
 
-VoxelAwareMeshIntegrator::VoxelAwareMeshIntegrator(const MeshIntegratorConfig& config,
-                                                   TsdfLayer* sdf_layer,
-                                                   GvdLayer* gvd_layer,
-                                                   MeshLayer* mesh_layer)
-    : MeshIntegrator<TsdfVoxel>(config, sdf_layer, mesh_layer), gvd_layer_(gvd_layer) {
+VoxelAwareMeshIntegrator::VoxelAwareMeshIntegrator(
+    const MeshIntegratorConfig& config,
+    TsdfLayer* sdf_layer,
+    GvdLayer* gvd_layer,
+    MeshLayer* mesh_layer,
+    const std::shared_ptr<ThreadPool>& thread_pool)
+    : MeshIntegrator<TsdfVoxel>(config, sdf_layer, mesh_layer),
+      gvd_layer_(gvd_layer),
+      thread_pool_(thread_pool) {
   DCHECK(gvd_layer != nullptr);
   cube_coord_offsets_ = cube_index_offsets_.cast<FloatingPoint>() * voxel_size_;
+  if (!thread_pool_) {
+    thread_pool_ = std::make_shared<ThreadPool>(config_.integrator_threads);
+  }
 }
 
-void VoxelAwareMeshIntegrator::launchThreads(const BlockIndexList& blocks,
-                                             bool interior_pass) {
-  std::unique_ptr<ThreadSafeIndex> index_getter(
-      new MixedThreadSafeIndex(blocks.size()));
+void VoxelAwareMeshIntegrator::processBlocks(const BlockIndexList& blocks) {
+  voxblox::AnyIndexHashMapType<size_t>::type block_lookup;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    block_lookup[blocks[i]] = i;
+  }
 
-  std::list<std::thread> threads;
-  for (size_t i = 0; i < config_.integrator_threads; ++i) {
-    if (interior_pass) {
-      threads.emplace_back(
-          &VoxelAwareMeshIntegrator::processInterior, this, blocks, index_getter.get());
-    } else {
-      threads.emplace_back(
-          &VoxelAwareMeshIntegrator::processExterior, this, blocks, index_getter.get());
+  // the exterior of a block touches the voxels of the blocks at the other cube
+  // corners, so it has to wait for the interior of each of those blocks
+  std::vector<std::vector<size_t>> dependents(blocks.size());
+  std::unique_ptr<std::atomic<size_t>[]> num_pending(
+      new std::atomic<size_t>[blocks.size()]);
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    size_t pending = 0;
+    for (int c = 0; c < cube_index_offsets_.cols(); ++c) {
+      const BlockIndex neighbor = blocks[i] + cube_index_offsets_.col(c);
+      auto iter = block_lookup.find(neighbor);
+      if (iter == block_lookup.end()) {
+        continue;
+      }
+
+      dependents[iter->second].push_back(i);
+      ++pending;
     }
+
+    num_pending[i] = pending;
   }
 
-  for (std::thread& thread : threads) {
-    thread.join();
+  ThreadPool::TaskGroup group;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    thread_pool_->push(group, [&, i] {
+      updateBlockInterior(blocks[i]);
+      for (const size_t dependent : dependents[i]) {
+        if (--num_pending[dependent] == 0) {
+          thread_pool_->push(group,
+                             [&, dependent] { updateBlockExterior(blocks[dependent]); });
+        }
+      }
+    });
   }
+
+  thread_pool_->wait(group);
 }
 
 void VoxelAwareMeshIntegrator::generateMesh(bool only_mesh_updated_blocks,
@@ -103,8 +132,8 @@ void VoxelAwareMeshIntegrator::generateMesh(bool only_mesh_updated_blocks,
     mesh_layer_->allocateMeshPtrByIndex(block_index);
   }
 
-  launchThreads(blocks, true);
-  launchThreads(blocks, false);
+  processBlocks(blocks);
+  mesh_changes_.markUpdated(blocks);
 
   if (clear_updated_flag) {
     for (const auto& block_idx : blocks) {
@@ -114,26 +143,6 @@ void VoxelAwareMeshIntegrator::generateMesh(bool only_mesh_updated_blocks,
   }
 }
 
-void VoxelAwareMeshIntegrator::processInterior(const BlockIndexList& blocks,
-                                               ThreadSafeIndex* index_getter) {
-  DCHECK(index_getter != nullptr);
-
-  size_t list_idx;
-  while (index_getter->getNextIndex(&list_idx)) {
-    updateBlockInterior(blocks[list_idx]);
-  }
-}
-
-void VoxelAwareMeshIntegrator::processExterior(const BlockIndexList& blocks,
-                                               ThreadSafeIndex* index_getter) {
-  DCHECK(index_getter != nullptr);
-
-  size_t list_idx;
-  while (index_getter->getNextIndex(&list_idx)) {
-    updateBlockExterior(blocks[list_idx]);
-  }
-}
-
 void VoxelAwareMeshIntegrator::updateBlockInterior(const BlockIndex& block_index) {
   auto mesh = mesh_layer_->getMeshPtrByIndex(block_index);
   mesh->clear();
@@ -143,10 +152,34 @@ void VoxelAwareMeshIntegrator::updateBlockInterior(const BlockIndex& block_index
   IndexElement vps = block->voxels_per_side();
   VertexIndex next_mesh_index = 0;
 
+  SdfColumns column_sdf(vps, 4);
+  ValidColumns column_valid(vps, 4);
+  Eigen::ArrayXi configs;
+
   VoxelIndex voxel_index;
   for (voxel_index.x() = 0; voxel_index.x() < vps - 1; ++voxel_index.x()) {
     for (voxel_index.y() = 0; voxel_index.y() < vps - 1; ++voxel_index.y()) {
+      // classify the whole row of cubes at once so that only cubes with a surface
+      // crossing pay for gathering corners
+      for (int c = 0; c < 4; ++c) {
+        VoxelIndex column_index = voxel_index + cube_index_offsets_.col(c);
+        for (column_index.z() = 0; column_index.z() < vps; ++column_index.z()) {
+          const TsdfVoxel& voxel = block->getVoxelByVoxelIndex(column_index);
+          FloatingPoint sdf = 0.0f;
+          column_valid(column_index.z(), c) =
+              vutils::getSdfIfValid(voxel, config_.min_weight, &sdf);
+          column_sdf(column_index.z(), c) = sdf;
+        }
+      }
+
+      calculateRowConfigs(column_sdf, column_valid, configs);
+
       for (voxel_index.z() = 0; voxel_index.z() < vps - 1; ++voxel_index.z()) {
+        const int config = configs(voxel_index.z());
+        if (config <= 0 || config == 0xFF) {
+          continue;  // unobserved corners or no triangles to generate
+        }
+
         Point coords = block->computeCoordinatesFromVoxelIndex(voxel_index);
         extractMeshInsideBlock(
             *block, voxel_index, coords, &next_mesh_index, mesh.get());
@@ -214,7 +247,8 @@ void VoxelAwareMeshIntegrator::extractMeshInsideBlock(const TsdfBlock& block,
 
   PointMatrix corner_coords;
   SdfMatrix corner_sdf;
-  std::vector<GvdVoxel*> gvd_voxels(8, nullptr);
+  CubeGvdVoxels gvd_voxels;
+  gvd_voxels.fill(nullptr);
   bool all_neighbors_observed = true;
 
   for (int i = 0; i < 8; ++i) {
@@ -231,7 +265,8 @@ void VoxelAwareMeshIntegrator::extractMeshInsideBlock(const TsdfBlock& block,
   }
 
   if (all_neighbors_observed) {
-    std::vector<bool> voxels_in_block(8, true);
+    CubeVoxelMask voxels_in_block;
+    voxels_in_block.fill(true);
     VoxelAwareMarchingCubes::meshCube(block_index,
                                       corner_coords,
                                       corner_sdf,
@@ -256,11 +291,12 @@ void VoxelAwareMeshIntegrator::extractMeshOnBorder(const TsdfBlock& block,
 
   PointMatrix corner_coords;
   SdfMatrix corner_sdf;
-  std::vector<GvdVoxel*> gvd_voxels(8, nullptr);
+  CubeGvdVoxels gvd_voxels;
+  gvd_voxels.fill(nullptr);
 
   bool all_neighbors_observed = true;
 
-  std::vector<bool> voxels_in_block(8);
+  CubeVoxelMask voxels_in_block;
   for (int i = 0; i < 8; ++i) {
     VoxelIndex corner_index = index + cube_index_offsets_.col(i);
 
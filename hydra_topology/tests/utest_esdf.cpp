@@ -38,9 +38,12 @@
 #include <gtest/gtest.h>
 
 #include <hydra_topology/gvd_integrator.h>
+#include <hydra_topology/tsdf_downsampler.h>
 #include <voxblox/integrator/esdf_integrator.h>
 #include <voxblox/utils/evaluation_utils.h>
 
+#include <cmath>
+
 namespace hydra {
 namespace topology {
 
@@ -120,5 +123,125 @@ TEST_F(EsdfTestFixture, TestEsdfSame) {
   EXPECT_LT(gvd_results.rmse, voxblox_results.rmse);
 }
 
+TEST_F(EsdfTestFixture, TestParallelSame) {
+  const float voxel_size = 0.25f;
+  const int voxels_per_side = 16;
+
+  TsdfIntegratorBase::Config tsdf_config;
+  Layer<TsdfVoxel>::Ptr tsdf_layer(new Layer<TsdfVoxel>(voxel_size, voxels_per_side));
+  FastTsdfIntegrator tsdf_integrator(tsdf_config, tsdf_layer.get());
+
+  GvdIntegratorConfig gvd_config;
+  gvd_config.min_distance_m = tsdf_config.default_truncation_distance;
+  gvd_config.max_distance_m = 10.0;
+  gvd_config.extract_graph = true;
+
+  Layer<GvdVoxel>::Ptr serial_layer(new Layer<GvdVoxel>(voxel_size, voxels_per_side));
+  MeshLayer::Ptr serial_mesh(new MeshLayer(voxel_size * voxels_per_side));
+  GvdIntegrator serial_integrator(
+      gvd_config, tsdf_layer.get(), serial_layer, serial_mesh);
+
+  gvd_config.num_threads = 4;
+  Layer<GvdVoxel>::Ptr parallel_layer(new Layer<GvdVoxel>(voxel_size, voxels_per_side));
+  MeshLayer::Ptr parallel_mesh(new MeshLayer(voxel_size * voxels_per_side));
+  GvdIntegrator parallel_integrator(
+      gvd_config, tsdf_layer.get(), parallel_layer, parallel_mesh);
+
+  // ties are broken on the parent index and GVD membership is computed after the
+  // wavefront settles, so the result can't depend on the number of threads
+  auto voxels_match = [](const GvdVoxel& lhs, const GvdVoxel& rhs) {
+    return lhs.distance == rhs.distance && lhs.fixed == rhs.fixed &&
+           lhs.on_surface == rhs.on_surface && lhs.has_parent == rhs.has_parent &&
+           (!lhs.has_parent || getParentIndex(lhs) == getParentIndex(rhs)) &&
+           lhs.num_extra_basis == rhs.num_extra_basis &&
+           lhs.is_voronoi_parent == rhs.is_voronoi_parent;
+  };
+
+  for (size_t i = 0; i < num_poses; ++i) {
+    updateTsdfIntegrator(tsdf_integrator, i);
+
+    // we need to keep the updated flags for the second integrator
+    serial_integrator.updateFromTsdfLayer(false);
+    parallel_integrator.updateFromTsdfLayer(true);
+
+    LayerComparisonResult result =
+        compareLayers(*serial_layer, *parallel_layer, voxels_match);
+    VLOG(3) << "Serial vs. parallel " << result;
+    EXPECT_TRUE(result.valid);
+    EXPECT_EQ(0u, result.num_different);
+    EXPECT_EQ(0u, result.num_missing_lhs);
+    EXPECT_EQ(0u, result.num_missing_rhs);
+    EXPECT_EQ(0u, result.num_lhs_seen_rhs_unseen);
+    EXPECT_EQ(0u, result.num_rhs_seen_lhs_unseen);
+    EXPECT_EQ(0.0, result.max_error);
+
+    EXPECT_EQ(serial_integrator.getGraph().numNodes(),
+              parallel_integrator.getGraph().numNodes());
+    EXPECT_EQ(serial_integrator.getGraph().numEdges(),
+              parallel_integrator.getGraph().numEdges());
+
+    EXPECT_EQ(serial_layer->getNumberOfAllocatedBlocks(),
+              parallel_layer->getNumberOfAllocatedBlocks());
+
+    // the parallel wavefront only resolves GVD parent vertices after the lower
+    // pass, so every mesh connection of the extracted graph has to be valid
+    const SceneGraphLayer& graph = parallel_integrator.getGraph();
+    for (const auto& id_node_pair : graph.nodes()) {
+      const auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
+      for (const auto& connection : attrs.voxblox_mesh_connections) {
+        const BlockIndex block_index = Eigen::Map<const BlockIndex>(connection.block);
+        ASSERT_TRUE(parallel_mesh->hasMesh(block_index));
+        EXPECT_LT(connection.vertex,
+                  parallel_mesh->getMeshByIndex(block_index).vertices.size());
+      }
+    }
+  }
+
+  EXPECT_GT(serial_integrator.getGraph().numNodes(), 0u);
+}
+
+TEST_F(EsdfTestFixture, TestCoarseConfigHasPlaces) {
+  const float voxel_size = 0.25f;
+  const int voxels_per_side = 16;
+  const size_t factor = 2;
+
+  TsdfIntegratorBase::Config tsdf_config;
+  Layer<TsdfVoxel>::Ptr tsdf_layer(new Layer<TsdfVoxel>(voxel_size, voxels_per_side));
+  FastTsdfIntegrator tsdf_integrator(tsdf_config, tsdf_layer.get());
+
+  GvdIntegratorConfig gvd_config;
+  gvd_config.min_distance_m = tsdf_config.default_truncation_distance;
+  gvd_config.max_distance_m = 10.0;
+  gvd_config.extract_graph = true;
+
+  // downsampled distances never exceed the fine truncation distance, so a fixed
+  // layer wider than that would swallow every coarse voxel
+  const GvdIntegratorConfig coarse_config = getCoarseGvdConfig(gvd_config, factor);
+  EXPECT_EQ(gvd_config.min_distance_m, coarse_config.min_distance_m);
+  EXPECT_EQ(factor * gvd_config.max_distance_m, coarse_config.max_distance_m);
+
+  Layer<TsdfVoxel> coarse_tsdf(factor * voxel_size, voxels_per_side);
+  Layer<GvdVoxel>::Ptr coarse_layer(
+      new Layer<GvdVoxel>(factor * voxel_size, voxels_per_side));
+  MeshLayer::Ptr coarse_mesh(new MeshLayer(coarse_tsdf.block_size()));
+  GvdIntegrator coarse_integrator(
+      coarse_config, &coarse_tsdf, coarse_layer, coarse_mesh);
+
+  for (size_t i = 0; i < num_poses; ++i) {
+    updateTsdfIntegrator(tsdf_integrator, i);
+
+    BlockIndexList blocks;
+    tsdf_layer->getAllUpdatedBlocks(Update::kEsdf, &blocks);
+    downsampleTsdfBlocks(*tsdf_layer, blocks, coarse_tsdf);
+    for (const auto& idx : blocks) {
+      tsdf_layer->getBlockByIndex(idx).updated().reset(Update::kEsdf);
+    }
+
+    coarse_integrator.updateFromTsdfLayer(true);
+  }
+
+  EXPECT_GT(coarse_integrator.getGraph().numNodes(), 0u);
+}
+
 }  // namespace topology
 }  // namespace hydra
@@ -0,0 +1,154 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/flat_containers.h>
+#include <hydra_topology/voxblox_types.h>
+
+#include <chrono>
+#include <random>
+#include <unordered_map>
+
+namespace hydra {
+namespace topology {
+
+using IndexMap = FlatHashMap<GlobalIndex, size_t, voxblox::LongIndexHash>;
+
+TEST(FlatContainers, MapMatchesStdMap) {
+  std::mt19937 gen(12345);
+  std::uniform_int_distribution<int> coord(-10, 10);
+  std::uniform_int_distribution<int> op(0, 2);
+
+  IndexMap flat;
+  voxblox::LongIndexHashMapType<size_t>::type expected;
+  for (size_t i = 0; i < 20000; ++i) {
+    const GlobalIndex index(coord(gen), coord(gen), coord(gen));
+    switch (op(gen)) {
+      case 0:
+        flat[index] = i;
+        expected[index] = i;
+        break;
+      case 1:
+        EXPECT_EQ(expected.erase(index), flat.erase(index));
+        break;
+      default:
+        ASSERT_EQ(expected.count(index), flat.count(index));
+        if (expected.count(index)) {
+          EXPECT_EQ(expected.at(index), flat.at(index));
+        }
+        break;
+    }
+    ASSERT_EQ(expected.size(), flat.size());
+  }
+
+  size_t num_seen = 0;
+  for (const auto& index_value_pair : flat) {
+    ASSERT_EQ(1u, expected.count(index_value_pair.first));
+    EXPECT_EQ(expected.at(index_value_pair.first), index_value_pair.second);
+    ++num_seen;
+  }
+  EXPECT_EQ(expected.size(), num_seen);
+}
+
+TEST(FlatContainers, EmplaceDoesNotOverwrite) {
+  FlatHashMap<size_t, int> map;
+  EXPECT_TRUE(map.emplace(5, 1).second);
+  EXPECT_FALSE(map.emplace(5, 2).second);
+  EXPECT_EQ(1, map.at(5));
+  EXPECT_THROW(map.at(6), std::out_of_range);
+
+  map.erase(map.find(5));
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.end(), map.find(5));
+}
+
+TEST(FlatContainers, SortedVectorSetOrdered) {
+  SortedVectorSet<size_t> set;
+  EXPECT_TRUE(set.insert(5).second);
+  EXPECT_TRUE(set.insert(1).second);
+  EXPECT_TRUE(set.insert(3).second);
+  EXPECT_FALSE(set.insert(3).second);
+
+  std::vector<size_t> expected{1, 3, 5};
+  EXPECT_EQ(expected, std::vector<size_t>(set.begin(), set.end()));
+
+  EXPECT_EQ(1u, set.erase(3));
+  EXPECT_EQ(0u, set.erase(3));
+  EXPECT_EQ(0u, set.count(3));
+  EXPECT_EQ(2u, set.size());
+}
+
+template <typename Map>
+double timeIndexWorkload(const voxblox::AlignedVector<GlobalIndex>& indices) {
+  const auto start = std::chrono::steady_clock::now();
+  Map map;
+  size_t total = 0;
+  for (size_t iter = 0; iter < 10; ++iter) {
+    // mirrors the extractor: flood-fill inserts, neighbor lookups, then clearing
+    for (size_t i = 0; i < indices.size(); ++i) {
+      map[indices[i]] = i;
+    }
+    for (const auto& index : indices) {
+      total += map.count(index + GlobalIndex(1, 0, 0));
+    }
+    for (size_t i = 0; i < indices.size(); i += 2) {
+      map.erase(indices[i]);
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+  EXPECT_LT(0u, total);
+  return std::chrono::duration<double>(end - start).count();
+}
+
+// run with --gtest_also_run_disabled_tests to compare against the voxblox maps
+TEST(FlatContainers, DISABLED_IndexMapBenchmark) {
+  voxblox::AlignedVector<GlobalIndex> indices;
+  for (int x = 0; x < 60; ++x) {
+    for (int y = 0; y < 60; ++y) {
+      for (int z = 0; z < 60; ++z) {
+        indices.emplace_back(x, y, z);
+      }
+    }
+  }
+
+  const double std_time =
+      timeIndexWorkload<voxblox::LongIndexHashMapType<size_t>::type>(indices);
+  const double flat_time = timeIndexWorkload<IndexMap>(indices);
+  std::cout << "std: " << std_time << " [s], flat: " << flat_time
+            << " [s], speedup: " << std_time / flat_time << std::endl;
+}
+
+}  // namespace topology
+}  // namespace hydra
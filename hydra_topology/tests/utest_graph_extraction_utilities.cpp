@@ -39,6 +39,8 @@
 #include <hydra_topology/graph_extraction_utilities.h>
 #include <hydra_topology/voxblox_types.h>
 
+#include <random>
+
 namespace hydra {
 namespace topology {
 
@@ -206,6 +208,48 @@ TEST_F(SingleBlockExtractionTestFixture, NeighborhoodExtraction) {
   }
 }
 
+TEST(GraphExtractionUtilities, BlockNeighborhoodFlagsMatchLookup) {
+  const int vps = 4;
+  Layer<GvdVoxel> layer(0.1, vps);
+
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> basis_dist(0, 3);
+  voxblox::BlockIndexList allocated;
+  for (int x = -1; x <= 1; ++x) {
+    for (int y = -1; y <= 0; ++y) {
+      for (int z = 0; z <= 1; ++z) {
+        if ((x + y + z) % 3 == 0) {
+          continue;  // leave some neighbors unallocated
+        }
+
+        allocated.push_back(BlockIndex(x, y, z));
+        auto block = layer.allocateBlockPtrByIndex(allocated.back());
+        for (size_t i = 0; i < block->num_voxels(); ++i) {
+          block->getVoxelByLinearIndex(i).num_extra_basis = basis_dist(rng);
+        }
+      }
+    }
+  }
+
+  BlockNeighborhoodFlags slab(vps);
+  for (const auto& block_index : allocated) {
+    slab.fill(layer, block_index, 2);
+    for (int x = 0; x < vps; ++x) {
+      for (int y = 0; y < vps; ++y) {
+        for (int z = 0; z < vps; ++z) {
+          const VoxelIndex voxel_index(x, y, z);
+          const GlobalIndex index =
+              voxblox::getGlobalVoxelIndexFromBlockAndVoxelIndex(
+                  block_index, voxel_index, vps);
+          EXPECT_EQ(extractNeighborhoodFlags(layer, index, 2),
+                    slab.getFlags(voxel_index))
+              << "index: " << index.transpose();
+        }
+      }
+    }
+  }
+}
+
 #define CHECK_TEMPLATE_SOUNDNESS(finder, template_name)                    \
   EXPECT_EQ(2u, finder.template_name.fg_mask.count()) << #template_name;   \
   for (const auto& unused_mask : finder.template_name.unused_mask_array) { \
@@ -295,6 +339,48 @@ TEST(GraphExtractionUtilities, CornerDetectionTemplateCorrect) {
 
 #undef TEST_CORNER_ROTATION
 
+TEST(GraphExtractionUtilities, CornerMatchEquivalentToTemplates) {
+  CornerFinder finder;
+  const std::array<const GvdCornerTemplate*, 6> templates{&finder.negative_x_template,
+                                                          &finder.positive_x_template,
+                                                          &finder.negative_y_template,
+                                                          &finder.positive_y_template,
+                                                          &finder.negative_z_template,
+                                                          &finder.positive_z_template};
+
+  std::mt19937 rng(12345);
+  std::uniform_int_distribution<uint32_t> state_dist(0, 0x7FF'FFFF);
+  std::uniform_int_distribution<size_t> template_dist(0, 5);
+  std::uniform_int_distribution<size_t> rotation_dist(0, 3);
+  std::bernoulli_distribution flip_dist(0.02);
+
+  size_t num_matches = 0;
+  for (size_t i = 0; i < 100000; ++i) {
+    // random don't-care flags around a template (with the occasional flipped bit)
+    // so that both matching and non-matching states are exercised
+    const auto& corner = *templates[template_dist(rng)];
+    const auto& unused = corner.unused_mask_array[rotation_dist(rng)];
+    std::bitset<27> state(state_dist(rng));
+    state = (state & unused) | (corner.fg_mask & ~unused);
+    for (size_t b = 0; b < 27; ++b) {
+      if (flip_dist(rng)) {
+        state.flip(b);
+      }
+    }
+
+    bool expected = false;
+    for (const auto other : templates) {
+      expected |= matchesCorner(*other, state);
+    }
+
+    EXPECT_EQ(expected, finder.match(state)) << "state: " << state;
+    num_matches += expected ? 1 : 0;
+  }
+
+  EXPECT_GT(num_matches, 0u);
+  EXPECT_LT(num_matches, 100000u);
+}
+
 TEST(GraphExtractionUtilities, TestBresenhamLine) {
   {  // x primary axis
     GlobalIndex start(1, 2, 3);
@@ -387,5 +473,103 @@ TEST(GraphExtractionUtilities, TestBresenhamLineEmpty) {
   }
 }
 
+TEST(GraphExtractionUtilities, LayerLineMatchesVoxelLookup) {
+  const int vps = 4;
+  Layer<GvdVoxel> layer(0.1, vps);
+  for (int x = -2; x <= 1; ++x) {
+    for (int y = -2; y <= 1; ++y) {
+      if (x == 0 && y == -1) {
+        continue;  // leave a hole for the line to cross
+      }
+
+      auto block = layer.allocateBlockPtrByIndex(BlockIndex(x, y, 0));
+      for (size_t i = 0; i < block->num_voxels(); ++i) {
+        block->getVoxelByLinearIndex(i).distance = static_cast<float>(i);
+      }
+    }
+  }
+
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int64_t> coord_dist(-9, 8);
+  std::uniform_int_distribution<int64_t> z_dist(0, 3);
+  for (size_t iter = 0; iter < 200; ++iter) {
+    const GlobalIndex start(coord_dist(rng), coord_dist(rng), z_dist(rng));
+    const GlobalIndex end(coord_dist(rng), coord_dist(rng), z_dist(rng));
+    const auto expected = makeBresenhamLine(start, end);
+
+    size_t num_visited = 0;
+    auto visitor = [&](const GlobalIndex& index, const GvdVoxel* voxel) {
+      EXPECT_LT(num_visited, expected.size());
+      if (num_visited < expected.size()) {
+        EXPECT_EQ(expected[num_visited], index);
+      }
+
+      EXPECT_EQ(layer.getVoxelPtrByGlobalIndex(index), voxel)
+          << "index: " << index.transpose();
+      ++num_visited;
+      return true;
+    };
+
+    walkLayerLine(layer, start, end, visitor);
+    EXPECT_EQ(expected.size(), num_visited);
+  }
+}
+
+TEST(GraphExtractionUtilities, LineClearanceCorrect) {
+  Layer<GvdVoxel> layer(0.1, 8);
+  auto block = layer.allocateBlockPtrByIndex(BlockIndex(0, 0, 0));
+  for (size_t i = 0; i < block->num_voxels(); ++i) {
+    auto& voxel = block->getVoxelByLinearIndex(i);
+    voxel.observed = true;
+    voxel.distance = 1.0;
+  }
+
+  block->getVoxelByVoxelIndex(VoxelIndex(3, 0, 0)).distance = 0.5;
+
+  {  // clear line with the min distance along it
+    const auto result =
+        checkLineClearance(layer, GlobalIndex(0, 0, 0), GlobalIndex(6, 0, 0), 0.2);
+    EXPECT_TRUE(result.clear);
+    EXPECT_EQ(5u, result.num_voxels);
+    EXPECT_NEAR(0.5, result.min_distance, 1.0e-6);
+  }
+
+  {  // too close to an obstacle (stops at the first failing voxel)
+    const auto result =
+        checkLineClearance(layer, GlobalIndex(0, 0, 0), GlobalIndex(6, 0, 0), 0.6);
+    EXPECT_FALSE(result.clear);
+    EXPECT_EQ(3u, result.num_voxels);
+  }
+
+  {  // leaves the allocated block
+    const auto result =
+        checkLineClearance(layer, GlobalIndex(4, 0, 0), GlobalIndex(12, 0, 0), 0.2);
+    EXPECT_FALSE(result.clear);
+  }
+
+  {  // no interior voxels
+    const auto result =
+        checkLineClearance(layer, GlobalIndex(0, 0, 0), GlobalIndex(1, 0, 0), 0.2);
+    EXPECT_TRUE(result.clear);
+    EXPECT_EQ(0u, result.num_voxels);
+  }
+
+  block->getVoxelByVoxelIndex(VoxelIndex(0, 2, 0)).observed = false;
+  voxblox::AlignedVector<LineSegment> segments{
+      {GlobalIndex(0, 0, 0), GlobalIndex(6, 0, 0)},
+      {GlobalIndex(0, 0, 0), GlobalIndex(0, 6, 0)},
+      {GlobalIndex(0, 0, 0), GlobalIndex(0, 0, 6)}};
+
+  ThreadPool pool(2);
+  for (ThreadPool* thread_pool : {static_cast<ThreadPool*>(nullptr), &pool}) {
+    std::vector<LineClearance> results;
+    checkLineClearances(layer, segments, 0.2, results, thread_pool);
+    ASSERT_EQ(3u, results.size());
+    EXPECT_TRUE(results[0].clear);
+    EXPECT_FALSE(results[1].clear);  // unobserved voxel
+    EXPECT_TRUE(results[2].clear);
+  }
+}
+
 }  // namespace topology
 }  // namespace hydra
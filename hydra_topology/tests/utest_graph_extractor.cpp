@@ -38,6 +38,8 @@
 
 #include <hydra_topology/graph_extractor.h>
 
+#include <chrono>
+
 namespace hydra {
 namespace topology {
 
@@ -45,8 +47,9 @@ using NodeSet = std::unordered_set<NodeId>;
 
 class TestGraphExtractor : public GraphExtractor {
  public:
-  explicit TestGraphExtractor(const GraphExtractorConfig& config)
-      : GraphExtractor(config) {}
+  explicit TestGraphExtractor(const GraphExtractorConfig& config,
+                              const std::shared_ptr<ThreadPool>& pool = nullptr)
+      : GraphExtractor(config, pool) {}
 
   ~TestGraphExtractor() = default;
 
@@ -244,6 +247,30 @@ TEST_F(GraphExtractorTestFixture, SimpleExtractionCorrect) {
   EXPECT_EQ(2u, graph.edges().size());
 }
 
+TEST_F(GraphExtractorTestFixture, DirtyNodesTracked) {
+  TestGraphExtractor extractor(config);
+  setupTestEnvironment(extractor);
+
+  // every node is new after the first extraction
+  const SceneGraphLayer& graph = extractor.getGraph();
+  EXPECT_EQ(graph.nodes().size(), extractor.getDirtyNodes().size());
+  EXPECT_TRUE(extractor.getArchivedNodes().empty());
+
+  // nothing changes without new GVD voxels
+  extractor.clearDirtyNodes();
+  extractor.extract(*layer);
+  EXPECT_TRUE(extractor.getDirtyNodes().empty());
+
+  // archived nodes leave the active set but stay in the graph
+  extractor.removeDistantIndex(GlobalIndex(6, 4, 0));
+  EXPECT_EQ(1u, extractor.getArchivedNodes().count(NodeSymbol('p', 1)));
+  EXPECT_TRUE(graph.hasNode(NodeSymbol('p', 1)));
+  EXPECT_EQ(0u, extractor.getActiveNodes().count(NodeSymbol('p', 1)));
+
+  extractor.clearDirtyNodes();
+  EXPECT_TRUE(extractor.getArchivedNodes().empty());
+}
+
 TEST_F(GraphExtractorTestFixture, SimpleExtractionWithSplitting) {
   config.max_edge_split_iterations = 5;
 
@@ -262,6 +289,25 @@ TEST_F(GraphExtractorTestFixture, SimpleExtractionWithSplitting) {
   EXPECT_EQ(4u, graph.edges().size());
 }
 
+TEST_F(GraphExtractorTestFixture, ParallelSplittingMatchesSerial) {
+  config.max_edge_split_iterations = 5;
+
+  TestGraphExtractor serial(config);
+  setupTestEnvironment(serial);
+
+  TestGraphExtractor parallel(config, std::make_shared<ThreadPool>(4));
+  setupTestEnvironment(parallel);
+
+  const SceneGraphLayer& expected = serial.getGraph();
+  const SceneGraphLayer& result = parallel.getGraph();
+  ASSERT_EQ(expected.nodes().size(), result.nodes().size());
+  EXPECT_EQ(expected.edges().size(), result.edges().size());
+  for (const auto& id_index_pair : serial.node_id_root_map_) {
+    ASSERT_TRUE(parallel.node_id_root_map_.count(id_index_pair.first));
+    EXPECT_EQ(id_index_pair.second, parallel.node_id_root_map_.at(id_index_pair.first));
+  }
+}
+
 TEST_F(GraphExtractorTestFixture, SimpleExtractionWithNodeMerging) {
   config.max_edge_split_iterations = 5;
   config.merge_new_nodes = true;
@@ -285,6 +331,43 @@ TEST_F(GraphExtractorTestFixture, SimpleExtractionWithNodeMerging) {
   EXPECT_EQ(3u, graph.edges().size());
 }
 
+// run with --gtest_also_run_disabled_tests to time extraction on a larger lattice
+TEST_F(GraphExtractorTestFixture, DISABLED_LatticeExtractionBenchmark) {
+  config.max_edge_split_iterations = 5;
+  TestGraphExtractor extractor(config);
+
+  const size_t spacing = 10;
+  const size_t num_cells = 30;
+  for (size_t r = 0; r <= num_cells; ++r) {
+    for (size_t c = 0; c <= num_cells; ++c) {
+      if (r < num_cells) {
+        makeLine(extractor, r * spacing, c * spacing, (r + 1) * spacing, c * spacing);
+      }
+      if (c < num_cells) {
+        makeLine(extractor, r * spacing, c * spacing, r * spacing, (c + 1) * spacing);
+      }
+    }
+  }
+
+  for (size_t r = 0; r <= num_cells; ++r) {
+    for (size_t c = 0; c <= num_cells; ++c) {
+      extractor.pushGvdIndex(
+          makeVoxelAndIndex(0.0, 5, r * spacing, c * spacing, 0).index);
+    }
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  extractor.extract(*layer);
+  const auto end = std::chrono::steady_clock::now();
+
+  const SceneGraphLayer& graph = extractor.getGraph();
+  std::cout << "extracted " << graph.nodes().size() << " nodes and "
+            << graph.edges().size() << " edges in "
+            << std::chrono::duration<double>(end - start).count() << " [s]"
+            << std::endl;
+  EXPECT_LT(0u, graph.nodes().size());
+}
+
 TEST(GraphExtractor, GetNeighborhoodOverlapCorrect) {
   IsolatedSceneGraphLayer graph(1);
   graph.emplaceNode(0, std::make_unique<NodeAttributes>());
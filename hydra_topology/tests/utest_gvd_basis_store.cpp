@@ -0,0 +1,147 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/gvd_basis_store.h>
+
+namespace hydra {
+namespace topology {
+
+TEST(GvdBasisStore, BasisAllocation) {
+  GvdBasisStore store(4);
+  EXPECT_EQ(nullptr, store.getBasis(GlobalIndex(1, 2, 3)));
+
+  GvdBasis& basis = store.allocateBasis(GlobalIndex(1, 2, 3));
+  EXPECT_EQ(0u, basis.num_parents);
+  EXPECT_TRUE(basis.addParent(GlobalIndex(-5, 6, 7)));
+  EXPECT_EQ(&basis, store.getBasis(GlobalIndex(1, 2, 3)));
+  EXPECT_EQ(&basis, &store.allocateBasis(GlobalIndex(1, 2, 3)));
+  EXPECT_EQ(GlobalIndex(-5, 6, 7), basis.getParent(0));
+  EXPECT_EQ(1u, store.numBlocks());
+
+  // neighboring voxels in the same block don't share a basis
+  EXPECT_EQ(nullptr, store.getBasis(GlobalIndex(1, 2, 2)));
+
+  store.removeBasis(GlobalIndex(1, 2, 3));
+  EXPECT_EQ(nullptr, store.getBasis(GlobalIndex(1, 2, 3)));
+
+  // freed entries get reused and reset
+  GvdBasis& reused = store.allocateBasis(GlobalIndex(3, 3, 3));
+  EXPECT_EQ(&basis, &reused);
+  EXPECT_EQ(0u, reused.num_parents);
+}
+
+TEST(GvdBasisStore, BasisCapacity) {
+  GvdBasis basis;
+  for (size_t i = 0; i < GvdBasis::kMaxParents; ++i) {
+    EXPECT_TRUE(basis.addParent(GlobalIndex(i, 0, 0)));
+  }
+
+  EXPECT_FALSE(basis.addParent(GlobalIndex(0, 1, 0)));
+  EXPECT_EQ(GvdBasis::kMaxParents, basis.num_parents);
+}
+
+TEST(GvdBasisStore, VertexRefCounts) {
+  GvdBasisStore store(4);
+  GvdVertexInfo& info = store.allocateVertex(GlobalIndex(0, 0, 0));
+  info.vertex = 5;
+  info.ref_count = 2;
+  EXPECT_EQ(&info, store.getVertex(GlobalIndex(0, 0, 0)));
+
+  GvdBasis& basis = store.allocateBasis(GlobalIndex(-1, -1, -1));
+  basis.addParent(GlobalIndex(0, 0, 0));
+  basis.addParent(GlobalIndex(2, 0, 0));  // no vertex info for this parent
+  EXPECT_EQ(2u, store.numBlocks());
+
+  store.removeBasis(GlobalIndex(-1, -1, -1));
+  EXPECT_EQ(1u, info.ref_count);
+
+  Layer<GvdVoxel> layer(0.1, 4);
+  size_t num_visited = 0;
+  store.filterVertices(layer, [&](const GvdVoxel* voxel, GvdVertexInfo& vertex) {
+    EXPECT_EQ(nullptr, voxel);
+    EXPECT_EQ(5u, vertex.vertex);
+    ++num_visited;
+    vertex.ref_count = 0;
+    return false;
+  });
+  EXPECT_EQ(1u, num_visited);
+  EXPECT_EQ(nullptr, store.getVertex(GlobalIndex(0, 0, 0)));
+}
+
+TEST(GvdBasisStore, RemoveVertex) {
+  GvdBasisStore store(4);
+  store.allocateVertex(GlobalIndex(1, 1, 1)).ref_count = 3;
+  store.allocateVertex(GlobalIndex(2, 1, 1)).ref_count = 1;
+
+  store.removeVertex(GlobalIndex(1, 1, 1));
+  EXPECT_EQ(nullptr, store.getVertex(GlobalIndex(1, 1, 1)));
+  ASSERT_NE(nullptr, store.getVertex(GlobalIndex(2, 1, 1)));
+  EXPECT_EQ(1u, store.getVertex(GlobalIndex(2, 1, 1))->ref_count);
+
+  // the freed slot is reused for the next vertex
+  GvdVertexInfo& info = store.allocateVertex(GlobalIndex(3, 1, 1));
+  EXPECT_EQ(0u, info.ref_count);
+  EXPECT_EQ(&info, store.getVertex(GlobalIndex(3, 1, 1)));
+}
+
+TEST(GvdBasisStore, RemoveBlockArchivesVertices) {
+  GvdBasisStore store(4);
+  GvdVertexInfo& referenced = store.allocateVertex(GlobalIndex(1, 1, 1));
+  referenced.vertex = 3;
+  referenced.ref_count = 1;
+  GvdVertexInfo& unused = store.allocateVertex(GlobalIndex(2, 1, 1));
+  unused.ref_count = 0;
+
+  // basis in the same block that references a parent in another block
+  GvdVertexInfo& other = store.allocateVertex(GlobalIndex(5, 1, 1));
+  other.ref_count = 1;
+  store.allocateBasis(GlobalIndex(0, 0, 0)).addParent(GlobalIndex(5, 1, 1));
+
+  store.removeBlock(BlockIndex(0, 0, 0));
+  EXPECT_EQ(1u, store.numBlocks());
+  EXPECT_EQ(1u, store.numArchivedVertices());
+  EXPECT_EQ(nullptr, store.getBasis(GlobalIndex(0, 0, 0)));
+  EXPECT_EQ(nullptr, store.getVertex(GlobalIndex(2, 1, 1)));
+  EXPECT_EQ(0u, store.getVertex(GlobalIndex(5, 1, 1))->ref_count);
+
+  const GvdVertexInfo* archived = store.getVertex(GlobalIndex(1, 1, 1));
+  ASSERT_TRUE(archived != nullptr);
+  EXPECT_EQ(3u, archived->vertex);
+  EXPECT_EQ(1u, archived->ref_count);
+}
+
+}  // namespace topology
+}  // namespace hydra
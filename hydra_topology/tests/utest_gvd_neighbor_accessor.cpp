@@ -0,0 +1,114 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/gvd_neighbor_accessor.h>
+#include <hydra_topology/gvd_utilities.h>
+
+namespace hydra {
+namespace topology {
+
+void checkNeighborhood(Layer<GvdVoxel>& layer, const GlobalIndex& index) {
+  GvdNeighborAccessor neighbors(layer);
+  GvdVoxel* voxel = neighbors.setIndex(index);
+  ASSERT_EQ(layer.getVoxelPtrByGlobalIndex(index), voxel);
+  ASSERT_TRUE(voxel != nullptr);
+  EXPECT_EQ(getVoxelPosition<float>(layer, index), neighbors.getPosition());
+
+  GvdNeighborhood::IndexMatrix neighbor_indices;
+  GvdNeighborhood::getFromGlobalIndex(index, &neighbor_indices);
+  for (unsigned int n = 0u; n < neighbor_indices.cols(); ++n) {
+    const GlobalIndex& neighbor_index = neighbor_indices.col(n);
+    EXPECT_EQ(neighbor_index, neighbors.getNeighborIndex(n));
+
+    GvdVoxel* expected = layer.getVoxelPtrByGlobalIndex(neighbor_index);
+    EXPECT_EQ(expected, neighbors.getNeighbor(n))
+        << "neighbor " << n << " of " << index.transpose();
+    if (!expected) {
+      continue;
+    }
+
+    EXPECT_EQ(getVoxelPosition<float>(layer, neighbor_index),
+              neighbors.getNeighborPosition(n))
+        << "neighbor " << n << " of " << index.transpose();
+  }
+}
+
+TEST(GvdNeighborAccessor, InteriorMatchesLayer) {
+  Layer<GvdVoxel> layer(0.1, 4);
+  layer.allocateBlockPtrByIndex(BlockIndex(0, 0, 0));
+
+  GvdNeighborAccessor neighbors(layer);
+  neighbors.setIndex(GlobalIndex(1, 2, 1));
+  EXPECT_TRUE(neighbors.isInterior());
+  checkNeighborhood(layer, GlobalIndex(1, 2, 1));
+}
+
+TEST(GvdNeighborAccessor, BoundaryMatchesLayer) {
+  Layer<GvdVoxel> layer(0.1, 4);
+  for (int x = -1; x <= 1; ++x) {
+    for (int y = -1; y <= 1; ++y) {
+      for (int z = -1; z <= 1; ++z) {
+        layer.allocateBlockPtrByIndex(BlockIndex(x, y, z));
+      }
+    }
+  }
+
+  GvdNeighborAccessor neighbors(layer);
+  neighbors.setIndex(GlobalIndex(0, 2, 2));
+  EXPECT_FALSE(neighbors.isInterior());
+
+  checkNeighborhood(layer, GlobalIndex(0, 2, 2));  // face
+  checkNeighborhood(layer, GlobalIndex(3, 0, 2));  // edge
+  checkNeighborhood(layer, GlobalIndex(0, 0, 0));  // corner
+  checkNeighborhood(layer, GlobalIndex(3, 3, 3));  // corner
+  checkNeighborhood(layer, GlobalIndex(-1, 4, -4));
+}
+
+TEST(GvdNeighborAccessor, MissingBlocksReturnNull) {
+  Layer<GvdVoxel> layer(0.1, 4);
+  layer.allocateBlockPtrByIndex(BlockIndex(0, 0, 0));
+  layer.allocateBlockPtrByIndex(BlockIndex(1, 0, 0));
+
+  checkNeighborhood(layer, GlobalIndex(0, 0, 0));
+  checkNeighborhood(layer, GlobalIndex(3, 3, 3));
+  checkNeighborhood(layer, GlobalIndex(4, 1, 1));
+
+  GvdNeighborAccessor neighbors(layer);
+  EXPECT_TRUE(neighbors.setIndex(GlobalIndex(0, 0, -1)) == nullptr);
+}
+
+}  // namespace topology
+}  // namespace hydra
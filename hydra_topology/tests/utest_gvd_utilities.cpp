@@ -39,9 +39,6 @@
 namespace hydra {
 namespace topology {
 
-using ParentMap = Eigen::Map<const GlobalIndex>;
-using ParentPosMap = Eigen::Map<const voxblox::Point>;
-
 struct GvdVoxelWithIndex {
   GvdVoxel voxel;
   GlobalIndex index;
@@ -69,12 +66,8 @@ GvdVoxelWithIndex makeGvdVoxel(uint64_t x,
                                uint64_t pz) {
   GvdVoxelWithIndex to_return = makeGvdVoxel(x, y, z, distance);
   to_return.voxel.has_parent = true;
-  to_return.voxel.parent[0] = px;
-  to_return.voxel.parent[1] = py;
-  to_return.voxel.parent[2] = pz;
-  to_return.voxel.parent_pos[0] = px;
-  to_return.voxel.parent_pos[1] = py;
-  to_return.voxel.parent_pos[2] = pz;
+  setParentIndex(to_return.voxel, GlobalIndex(px, py, pz));
+  setParentPosition(to_return.voxel, voxblox::Point(px, py, pz));
   return to_return;
 }
 
@@ -121,8 +114,10 @@ TEST(GvdUtilities, setSdfParent) {
     voxblox::Point expected_pos;
     expected_pos << 5.0f, 6.0f, 7.0f;
     EXPECT_TRUE(current.has_parent);
-    EXPECT_EQ(expected, ParentMap(current.parent));
-    EXPECT_EQ(expected_pos, ParentPosMap(current.parent_pos));
+    EXPECT_EQ(expected, getParentIndex(current));
+#ifndef HYDRA_GVD_RECOMPUTE_PARENT_POS
+    EXPECT_EQ(expected_pos, getParentPosition(current, 1.0));
+#endif
   }
 
   {  // assign parent from neighbor
@@ -135,11 +130,28 @@ TEST(GvdUtilities, setSdfParent) {
 
     GlobalIndex expected(1, 2, 3);
     EXPECT_TRUE(current.has_parent);
-    EXPECT_EQ(expected, ParentMap(current.parent));
-    EXPECT_EQ(neighbor_pos, ParentPosMap(current.parent_pos));
+    EXPECT_EQ(expected, getParentIndex(current));
+#ifndef HYDRA_GVD_RECOMPUTE_PARENT_POS
+    EXPECT_EQ(neighbor_pos, getParentPosition(current, 1.0));
+#endif
   }
 }
 
+TEST(GvdUtilities, parentAccessors) {
+  GvdVoxel voxel;
+  EXPECT_LE(sizeof(GvdVoxel), 48u);
+
+  GlobalIndex expected(-12, 3, 50000);
+  setParentIndex(voxel, expected);
+  EXPECT_EQ(expected, getParentIndex(voxel));
+
+  setParentPosition(voxel, voxblox::Point(-1.15f, 0.35f, 5000.05f));
+  const voxblox::Point pos = getParentPosition(voxel, 0.1);
+  EXPECT_NEAR(-1.15f, pos.x(), 1.0e-3);
+  EXPECT_NEAR(0.35f, pos.y(), 1.0e-3);
+  EXPECT_NEAR(5000.05f, pos.z(), 1.0e-3);
+}
+
 TEST(GvdUtilities, ressetGvdParent) {
   GvdVoxelWithIndex current;
   // invariant of new voxels
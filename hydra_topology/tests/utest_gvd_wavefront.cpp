@@ -0,0 +1,165 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/gvd_wavefront.h>
+
+#include <future>
+
+namespace hydra {
+namespace topology {
+
+TEST(GvdWavefront, BucketsMatchBucketQueue) {
+  BlockWavefront wavefront(16, 20, 2.0);
+  EXPECT_EQ(0u, wavefront.getBucket(0.0));
+  EXPECT_EQ(0u, wavefront.getBucket(0.1));
+  EXPECT_EQ(0u, wavefront.getBucket(-0.1));
+  EXPECT_EQ(1u, wavefront.getBucket(0.11));
+  EXPECT_EQ(18u, wavefront.getBucket(1.95));
+  EXPECT_EQ(19u, wavefront.getBucket(5.0));
+}
+
+TEST(GvdWavefront, BlockQueuesLowestBucketFirst) {
+  WavefrontBlock block(BlockIndex::Zero(), 5);
+  EXPECT_FALSE(block.hasLower(4));
+
+  block.pushLower(GlobalIndex(0, 0, 3), 3);
+  block.pushLower(GlobalIndex(0, 0, 1), 1);
+  block.pushLower(GlobalIndex(0, 0, 2), 1);
+  EXPECT_FALSE(block.hasLower(0));
+  EXPECT_TRUE(block.hasLower(1));
+
+  EXPECT_EQ(GlobalIndex(0, 0, 1), block.popLower());
+  EXPECT_TRUE(block.hasLower(1));
+  EXPECT_EQ(GlobalIndex(0, 0, 2), block.popLower());
+  // only the bucket 3 voxel is left
+  EXPECT_FALSE(block.hasLower(2));
+  EXPECT_TRUE(block.hasLower(3));
+  EXPECT_EQ(GlobalIndex(0, 0, 3), block.popLower());
+  EXPECT_FALSE(block.hasLower(4));
+}
+
+TEST(GvdWavefront, VoxelsRoutedToContainingBlock) {
+  Layer<GvdVoxel> layer(0.1, 4);
+  layer.allocateBlockPtrByIndex(BlockIndex(0, 0, 0));
+  layer.allocateBlockPtrByIndex(BlockIndex(-1, 0, 0));
+
+  BlockWavefront wavefront(4, 10, 1.0);
+  wavefront.syncBlocks(layer);
+  EXPECT_EQ(2u, wavefront.getAllBlocks().size());
+
+  wavefront.pushLower(GlobalIndex(-1, 2, 2), 0.5);
+  wavefront.pushRaise(GlobalIndex(3, 2, 2));
+
+  auto lower_blocks = wavefront.getLowerBlocks(9);
+  ASSERT_EQ(1u, lower_blocks.size());
+  EXPECT_EQ(BlockIndex(-1, 0, 0), lower_blocks[0]->index);
+  EXPECT_TRUE(wavefront.getLowerBlocks(3).empty());
+
+  auto raise_blocks = wavefront.getRaiseBlocks();
+  ASSERT_EQ(1u, raise_blocks.size());
+  EXPECT_EQ(BlockIndex(0, 0, 0), raise_blocks[0]->index);
+
+  layer.removeBlock(BlockIndex(-1, 0, 0));
+  wavefront.syncBlocks(layer);
+  EXPECT_EQ(1u, wavefront.getAllBlocks().size());
+  EXPECT_EQ(nullptr, wavefront.getBlock(BlockIndex(-1, 0, 0)));
+}
+
+TEST(GvdWavefront, TouchedBlocksCoverNeighborhood) {
+  Layer<GvdVoxel> layer(0.1, 4);
+  BlockIndex index;
+  for (index.x() = -1; index.x() <= 1; ++index.x()) {
+    for (index.y() = -1; index.y() <= 1; ++index.y()) {
+      for (index.z() = -1; index.z() <= 1; ++index.z()) {
+        layer.allocateBlockPtrByIndex(index);
+      }
+    }
+  }
+
+  BlockWavefront wavefront(4, 10, 1.0);
+  wavefront.syncBlocks(layer);
+
+  {  // interior voxel only touches its own block
+    WavefrontLock lock;
+    wavefront.getTouchedBlocks(GlobalIndex(1, 2, 1), lock);
+    EXPECT_EQ(1u, lock.size());
+  }
+
+  {  // face voxel
+    WavefrontLock lock;
+    wavefront.getTouchedBlocks(GlobalIndex(0, 2, 1), lock);
+    EXPECT_EQ(2u, lock.size());
+  }
+
+  {  // edge voxel
+    WavefrontLock lock;
+    wavefront.getTouchedBlocks(GlobalIndex(3, 3, 1), lock);
+    EXPECT_EQ(4u, lock.size());
+  }
+
+  {  // corner voxel
+    WavefrontLock lock;
+    wavefront.getTouchedBlocks(GlobalIndex(0, 3, 0), lock);
+    EXPECT_EQ(8u, lock.size());
+    EXPECT_TRUE(lock.contains(wavefront.getBlock(BlockIndex(0, 0, 0))));
+    EXPECT_TRUE(lock.contains(wavefront.getBlock(BlockIndex(-1, 1, -1))));
+    EXPECT_FALSE(lock.contains(wavefront.getBlock(BlockIndex(1, 1, 1))));
+
+    lock.lock();
+    EXPECT_TRUE(lock.isLocked());
+    // probe the mutexes from another thread (this thread already owns them)
+    auto try_lock = [&](const BlockIndex& index) {
+      WavefrontBlock* block = wavefront.getBlock(index);
+      return std::async(std::launch::async, [block]() {
+               const bool acquired = block->mutex.try_lock();
+               if (acquired) {
+                 block->mutex.unlock();
+               }
+               return acquired;
+             }).get();
+    };
+    EXPECT_FALSE(try_lock(BlockIndex(0, 0, 0)));
+    EXPECT_FALSE(try_lock(BlockIndex(-1, 1, -1)));
+    EXPECT_TRUE(try_lock(BlockIndex(1, 1, 1)));
+
+    lock.unlock();
+    EXPECT_FALSE(lock.isLocked());
+    EXPECT_TRUE(try_lock(BlockIndex(0, 0, 0)));
+  }
+}
+
+}  // namespace topology
+}  // namespace hydra
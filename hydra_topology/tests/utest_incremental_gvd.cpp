@@ -38,6 +38,8 @@
 
 #include "hydra_topology_test/test_fixtures.h"
 
+#include <unistd.h>
+
 namespace hydra {
 namespace topology {
 
@@ -447,7 +449,7 @@ TEST_F(ParentTestFixture, ParentsCorrect) {
             expected_parent << x, y, 0;
           }
 
-          EXPECT_EQ(expected_parent, Eigen::Map<const GlobalIndex>(voxel.parent))
+          EXPECT_EQ(expected_parent, getParentIndex(voxel))
               << voxel << " @ (" << x << ", " << y << ", " << z << ")"
               << ",  expected parent: " << expected_parent.transpose();
         }
@@ -456,6 +458,65 @@ TEST_F(ParentTestFixture, ParentsCorrect) {
   }
 }
 
+TEST(GvdIntegrator, SnapshotKeepsRestoredBlocks) {
+  // mirrors the concurrent update path: the integrator only sees a snapshot of the
+  // live TSDF, and archived blocks have to survive later snapshots
+  Layer<TsdfVoxel> live_layer(0.1, 4);
+  Layer<TsdfVoxel> snapshot_layer(0.1, 4);
+  Layer<GvdVoxel>::Ptr gvd_layer(new Layer<GvdVoxel>(0.1, 4));
+  MeshLayer::Ptr mesh_layer(new MeshLayer(live_layer.block_size()));
+
+  GvdIntegratorConfig config;
+  config.archive_path = "/tmp/hydra_gvd_archive_" + std::to_string(getpid()) + ".bin";
+  GvdIntegrator gvd_integrator(config, &snapshot_layer, gvd_layer, mesh_layer);
+
+  const BlockIndex idx(0, 0, 0);
+  auto block = live_layer.allocateBlockPtrByIndex(idx);
+  for (size_t v = 0; v < block->num_voxels(); ++v) {
+    block->getVoxelByLinearIndex(v).distance = 0.3f;
+    block->getVoxelByLinearIndex(v).weight = 1.0f;
+  }
+  block->updated().set();
+
+  gvd_integrator.copyUpdatedTsdfBlocks(live_layer);
+  gvd_integrator.updateFromTsdfLayer(true);
+
+  // archive the block (the topology server prunes the live layer afterwards)
+  const BlockIndexList archived =
+      gvd_integrator.removeDistantBlocks(voxblox::Point(10.0, 10.0, 10.0), 1.0);
+  ASSERT_EQ(1u, archived.size());
+  EXPECT_FALSE(snapshot_layer.hasBlock(idx));
+  live_layer.removeBlock(idx);
+
+  // the revisit only observes the first voxel
+  block = live_layer.allocateBlockPtrByIndex(idx);
+  block->getVoxelByLinearIndex(0).distance = 0.1f;
+  block->getVoxelByLinearIndex(0).weight = 1.0f;
+  block->updated().set();
+
+  gvd_integrator.copyUpdatedTsdfBlocks(live_layer);
+  EXPECT_NEAR(0.2f, block->getVoxelByLinearIndex(0).distance, 1.0e-6f);
+  EXPECT_NEAR(2.0f, block->getVoxelByLinearIndex(0).weight, 1.0e-6f);
+  EXPECT_NEAR(1.0f, block->getVoxelByLinearIndex(1).weight, 1.0e-6f);
+  gvd_integrator.updateFromTsdfLayer(true);
+
+  // another observation of the first voxel only: the restored voxels have to stay
+  block->getVoxelByLinearIndex(0).weight = 3.0f;
+  block->updated().set();
+  gvd_integrator.copyUpdatedTsdfBlocks(live_layer);
+  gvd_integrator.updateFromTsdfLayer(true);
+
+  const auto& snapshot_block = snapshot_layer.getBlockByIndex(idx);
+  EXPECT_NEAR(3.0f, snapshot_block.getVoxelByLinearIndex(0).weight, 1.0e-6f);
+  for (size_t v = 1; v < snapshot_block.num_voxels(); ++v) {
+    const auto& voxel = snapshot_block.getVoxelByLinearIndex(v);
+    EXPECT_NEAR(0.3f, voxel.distance, 1.0e-6f) << "voxel " << v;
+    EXPECT_NEAR(1.0f, voxel.weight, 1.0e-6f) << "voxel " << v;
+  }
+
+  EXPECT_FALSE(live_layer.getBlockByIndex(idx).updated()[voxblox::Update::kEsdf]);
+}
+
 TEST(TestVoxelSize, DISABLED_ShowVoxelSize) {
   LOG(INFO) << "GVD voxel size: " << sizeof(GvdVoxel) << " bytes";
   SUCCEED();
@@ -34,6 +34,7 @@
  * -------------------------------------------------------------------------- */
 #include <gtest/gtest.h>
 #include <hydra_topology/voxel_aware_marching_cubes.h>
+#include <hydra_topology/voxel_aware_mesh_integrator.h>
 
 #include <set>
 
@@ -45,7 +46,8 @@ static constexpr float TEST_TOLERANCE = 1.0e-6f;
 TEST(VoxelAwareMarchingCubes, EdgeInterpolationBasic) {
   PointMatrix vertex_coordinates = PointMatrix::Zero();
   SdfMatrix sdf_values;
-  std::vector<GvdVoxel*> gvd_voxels(8, nullptr);
+  CubeGvdVoxels gvd_voxels;
+  gvd_voxels.fill(nullptr);
   // add zero-crossings at just the bottom right? corner
   sdf_values << -1.0, 1.0, 10.0, 2.0, 3.0, 10.0, 10.0, 10.0;
 
@@ -56,7 +58,7 @@ TEST(VoxelAwareMarchingCubes, EdgeInterpolationBasic) {
   vertex_coordinates.col(4) << 1.0, 1.0, 1.0;
 
   EdgeIndexMatrix edge_coords = EdgeIndexMatrix::Zero();
-  std::vector<uint8_t> edge_status;
+  EdgeStatus edge_status;
   interpolateEdges(
       vertex_coordinates, sdf_values, edge_coords, edge_status, gvd_voxels);
 
@@ -92,7 +94,8 @@ TEST(VoxelAwareMarchingCubes, EdgeInterpolationWithVoxels) {
   SdfMatrix sdf_values;
 
   GvdVoxel actual_voxels[8];
-  std::vector<GvdVoxel*> gvd_voxels(8, nullptr);
+  CubeGvdVoxels gvd_voxels;
+  gvd_voxels.fill(nullptr);
   for (size_t i = 0; i < gvd_voxels.size(); ++i) {
     gvd_voxels[i] = &(actual_voxels[i]);
     gvd_voxels[i]->distance = 10.0;
@@ -108,7 +111,7 @@ TEST(VoxelAwareMarchingCubes, EdgeInterpolationWithVoxels) {
   vertex_coordinates.col(4) << 1.0, 1.0, 1.0;
 
   EdgeIndexMatrix edge_coords = EdgeIndexMatrix::Zero();
-  std::vector<uint8_t> edge_status;
+  EdgeStatus edge_status;
   interpolateEdges(
       vertex_coordinates, sdf_values, edge_coords, edge_status, gvd_voxels);
 
@@ -151,7 +154,8 @@ TEST(VoxelAwareMarchingCubes, CubeMeshingNearestVertexIndexCorrect) {
   voxblox::VertexIndex next_index = 0;
 
   GvdVoxel actual_voxels[8];
-  std::vector<GvdVoxel*> gvd_voxels(8, nullptr);
+  CubeGvdVoxels gvd_voxels;
+  gvd_voxels.fill(nullptr);
   for (size_t i = 0; i < gvd_voxels.size(); ++i) {
     gvd_voxels[i] = &(actual_voxels[i]);
     gvd_voxels[i]->distance = 10.0;
@@ -166,7 +170,8 @@ TEST(VoxelAwareMarchingCubes, CubeMeshingNearestVertexIndexCorrect) {
   vertex_coordinates.col(3) << 1.0, 1.0, 1.0;
   vertex_coordinates.col(4) << 1.0, 1.0, 1.0;
 
-  std::vector<bool> voxels_in_block(8, true);
+  CubeVoxelMask voxels_in_block;
+  voxels_in_block.fill(true);
   BlockIndex block = BlockIndex::Zero();
   VoxelAwareMarchingCubes::meshCube(block,
                                     vertex_coordinates,
@@ -191,7 +196,8 @@ TEST(VoxelAwareMarchingCubes, CubeMeshingOutsideBlockCorrect) {
   voxblox::VertexIndex next_index = 0;
 
   GvdVoxel actual_voxels[8];
-  std::vector<GvdVoxel*> gvd_voxels(8, nullptr);
+  CubeGvdVoxels gvd_voxels;
+  gvd_voxels.fill(nullptr);
   for (size_t i = 0; i < gvd_voxels.size(); ++i) {
     gvd_voxels[i] = &(actual_voxels[i]);
     gvd_voxels[i]->distance = 10.0;
@@ -206,7 +212,8 @@ TEST(VoxelAwareMarchingCubes, CubeMeshingOutsideBlockCorrect) {
   vertex_coordinates.col(3) << 1.0, 1.0, 1.0;
   vertex_coordinates.col(4) << 1.0, 1.0, 1.0;
 
-  std::vector<bool> voxels_in_block(8, true);
+  CubeVoxelMask voxels_in_block;
+  voxels_in_block.fill(true);
   voxels_in_block[1] = false;
   BlockIndex block = BlockIndex::Zero();
   VoxelAwareMarchingCubes::meshCube(block,
@@ -223,5 +230,108 @@ TEST(VoxelAwareMarchingCubes, CubeMeshingOutsideBlockCorrect) {
   EXPECT_EQ(2u, actual_voxels[0].block_vertex_index);
 }
 
+TEST(VoxelAwareMarchingCubes, RowConfigsMatchCubes) {
+  const int num_voxels = 5;
+  SdfColumns sdf(num_voxels, 4);
+  ValidColumns valid = ValidColumns::Ones(num_voxels, 4);
+  for (int z = 0; z < num_voxels; ++z) {
+    for (int c = 0; c < 4; ++c) {
+      // mix of positive, negative and exactly zero values
+      sdf(z, c) = static_cast<FloatingPoint>((3 * z + 5 * c) % 7 - 3);
+    }
+  }
+  valid(3, 2) = 0;
+
+  Eigen::ArrayXi configs;
+  calculateRowConfigs(sdf, valid, configs);
+  ASSERT_EQ(num_voxels - 1, configs.size());
+
+  for (int z = 0; z < num_voxels - 1; ++z) {
+    if (z == 2 || z == 3) {
+      EXPECT_EQ(-1, configs(z)) << "z: " << z;
+      continue;
+    }
+
+    int expected = 0;
+    for (int c = 0; c < 8; ++c) {
+      expected |= (sdf(z + c / 4, c % 4) <= 0.0f) ? (1 << c) : 0;
+    }
+
+    EXPECT_EQ(expected, configs(z)) << "z: " << z;
+  }
+}
+
+TEST(VoxelAwareMeshIntegrator, BlockMatchesPerCubeMeshing) {
+  const FloatingPoint voxel_size = 0.1;
+  const int voxels_per_side = 8;
+  const BlockIndex block_index = BlockIndex::Zero();
+
+  Layer<TsdfVoxel> tsdf(voxel_size, voxels_per_side);
+  auto tsdf_block = tsdf.allocateBlockPtrByIndex(block_index);
+  const voxblox::Point center(0.37, 0.41, 0.33);
+  for (size_t i = 0; i < tsdf_block->num_voxels(); ++i) {
+    const VoxelIndex index = tsdf_block->computeVoxelIndexFromLinearIndex(i);
+    TsdfVoxel& voxel = tsdf_block->getVoxelByLinearIndex(i);
+    // sphere with a hole of unobserved voxels
+    const voxblox::Point pos = tsdf_block->computeCoordinatesFromVoxelIndex(index);
+    voxel.distance = (pos - center).norm() - 0.25;
+    voxel.weight = (index.x() == 5 && index.y() == 2) ? 0.0 : 1.0;
+  }
+
+  voxblox::MeshIntegratorConfig config;
+  config.use_color = false;
+
+  Layer<GvdVoxel> gvd(voxel_size, voxels_per_side);
+  gvd.allocateBlockPtrByIndex(block_index);
+  MeshLayer mesh_layer(voxel_size * voxels_per_side);
+  VoxelAwareMeshIntegrator integrator(config, &tsdf, &gvd, &mesh_layer);
+  integrator.generateMesh(false, false);
+
+  // mesh every cube of the block individually (like the integrator did before rows
+  // of cubes were classified at once)
+  Layer<GvdVoxel> expected_gvd(voxel_size, voxels_per_side);
+  expected_gvd.allocateBlockPtrByIndex(block_index);
+  MeshLayer expected_layer(voxel_size * voxels_per_side);
+  VoxelAwareMeshIntegrator reference(config, &tsdf, &expected_gvd, &expected_layer);
+  auto expected_mesh = expected_layer.allocateMeshPtrByIndex(block_index);
+  VertexIndex next_index = 0;
+  VoxelIndex cube;
+  for (cube.x() = 0; cube.x() < voxels_per_side - 1; ++cube.x()) {
+    for (cube.y() = 0; cube.y() < voxels_per_side - 1; ++cube.y()) {
+      for (cube.z() = 0; cube.z() < voxels_per_side - 1; ++cube.z()) {
+        const auto coords = tsdf_block->computeCoordinatesFromVoxelIndex(cube);
+        reference.extractMeshInsideBlock(
+            *tsdf_block, cube, coords, &next_index, expected_mesh.get());
+      }
+    }
+  }
+
+  ASSERT_TRUE(mesh_layer.hasMesh(block_index));
+  const Mesh& mesh = mesh_layer.getMeshByIndex(block_index);
+  ASSERT_GT(expected_mesh->vertices.size(), 0u);
+  ASSERT_EQ(expected_mesh->vertices.size(), mesh.vertices.size());
+  ASSERT_EQ(expected_mesh->indices.size(), mesh.indices.size());
+  ASSERT_EQ(expected_mesh->normals.size(), mesh.normals.size());
+  for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+    // identical, not just close
+    EXPECT_EQ(expected_mesh->vertices[i], mesh.vertices[i]) << "vertex " << i;
+    EXPECT_EQ(expected_mesh->normals[i], mesh.normals[i]) << "normal " << i;
+  }
+  for (size_t i = 0; i < mesh.indices.size(); ++i) {
+    EXPECT_EQ(expected_mesh->indices[i], mesh.indices[i]) << "index " << i;
+  }
+
+  const auto& gvd_block = gvd.getBlockByIndex(block_index);
+  const auto& expected_block = expected_gvd.getBlockByIndex(block_index);
+  for (size_t i = 0; i < gvd_block.num_voxels(); ++i) {
+    const GvdVoxel& voxel = gvd_block.getVoxelByLinearIndex(i);
+    const GvdVoxel& expected = expected_block.getVoxelByLinearIndex(i);
+    EXPECT_EQ(expected.on_surface, voxel.on_surface) << "voxel " << i;
+    if (expected.on_surface) {
+      EXPECT_EQ(expected.block_vertex_index, voxel.block_vertex_index) << "voxel " << i;
+    }
+  }
+}
+
 }  // namespace topology
 }  // namespace hydra
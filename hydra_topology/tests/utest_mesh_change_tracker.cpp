@@ -0,0 +1,73 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/mesh_change_tracker.h>
+
+#include <algorithm>
+
+namespace hydra {
+namespace topology {
+
+bool containsBlock(const BlockIndexList& blocks, const BlockIndex& index) {
+  return std::find(blocks.begin(), blocks.end(), index) != blocks.end();
+}
+
+TEST(MeshChangeTracker, TracksGenerations) {
+  MeshChangeTracker tracker;
+  EXPECT_EQ(0u, tracker.generation());
+  EXPECT_TRUE(tracker.getUpdatedSince(0).empty());
+
+  tracker.markUpdated({BlockIndex(0, 0, 0), BlockIndex(1, 0, 0)});
+  EXPECT_EQ(1u, tracker.generation());
+  EXPECT_EQ(2u, tracker.getUpdatedSince(0).size());
+  EXPECT_TRUE(tracker.getUpdatedSince(1).empty());
+
+  // only re-meshed blocks are newer than the last consumed generation
+  tracker.markUpdated({BlockIndex(1, 0, 0), BlockIndex(0, 1, 0)});
+  const BlockIndexList updated = tracker.getUpdatedSince(1);
+  EXPECT_EQ(2u, updated.size());
+  EXPECT_TRUE(containsBlock(updated, BlockIndex(1, 0, 0)));
+  EXPECT_TRUE(containsBlock(updated, BlockIndex(0, 1, 0)));
+  EXPECT_EQ(3u, tracker.getAllBlocks().size());
+
+  tracker.removeBlock(BlockIndex(1, 0, 0));
+  EXPECT_FALSE(tracker.hasBlock(BlockIndex(1, 0, 0)));
+  EXPECT_EQ(1u, tracker.getUpdatedSince(1).size());
+  EXPECT_EQ(2u, tracker.numBlocks());
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -36,6 +36,9 @@
 
 #include <gtest/gtest.h>
 
+#include <map>
+#include <random>
+
 namespace hydra {
 namespace topology {
 
@@ -43,5 +46,185 @@ TEST(NearestNeighborUtilities, TestBasic) {
   // TODO(nathan) actual test nearest node
 }
 
+using PositionMap = std::map<NodeId, Eigen::Vector3d>;
+using ResultVector = std::vector<std::pair<double, NodeId>>;
+
+ResultVector findBruteForce(const PositionMap& positions,
+                            const Eigen::Vector3d& query,
+                            size_t num_to_find) {
+  ResultVector results;
+  for (const auto& id_pos_pair : positions) {
+    results.emplace_back((id_pos_pair.second - query).squaredNorm(),
+                         id_pos_pair.first);
+  }
+
+  std::sort(results.begin(), results.end());
+  results.resize(std::min(num_to_find, results.size()));
+  return results;
+}
+
+ResultVector findIncremental(const IncrementalNodeFinder& finder,
+                             const Eigen::Vector3d& query,
+                             size_t num_to_find) {
+  ResultVector results;
+  finder.find(query, num_to_find, false, [&](NodeId node, size_t, double distance) {
+    results.emplace_back(distance, node);
+  });
+  return results;
+}
+
+TEST(NearestNeighborUtilities, IncrementalFinderBasic) {
+  IncrementalNodeFinder finder(1.0);
+  EXPECT_EQ(0u, finder.size());
+  EXPECT_TRUE(findIncremental(finder, Eigen::Vector3d::Zero(), 3).empty());
+
+  finder.insert(1, Eigen::Vector3d(0.1, 0.0, 0.0));
+  finder.insert(2, Eigen::Vector3d(5.0, 0.0, 0.0));
+  finder.insert(3, Eigen::Vector3d(-2.5, 0.0, 0.0));
+  EXPECT_EQ(3u, finder.size());
+  EXPECT_TRUE(finder.contains(2));
+
+  ResultVector expected{{0.01, 1}, {6.25, 3}, {25.0, 2}};
+  ResultVector result = findIncremental(finder, Eigen::Vector3d::Zero(), 5);
+  ASSERT_EQ(expected.size(), result.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(expected[i].first, result[i].first, 1.0e-9);
+    EXPECT_EQ(expected[i].second, result[i].second);
+  }
+
+  // moving a node across cells should update the result order
+  finder.insert(2, Eigen::Vector3d(0.0, 0.5, 0.0));
+  result = findIncremental(finder, Eigen::Vector3d::Zero(), 2);
+  ASSERT_EQ(2u, result.size());
+  EXPECT_EQ(1u, result[0].second);
+  EXPECT_EQ(2u, result[1].second);
+  EXPECT_EQ(3u, finder.size());
+
+  EXPECT_TRUE(finder.erase(1));
+  EXPECT_FALSE(finder.erase(1));
+  EXPECT_FALSE(finder.contains(1));
+  result = findIncremental(finder, Eigen::Vector3d::Zero(), 1);
+  ASSERT_EQ(1u, result.size());
+  EXPECT_EQ(2u, result[0].second);
+
+  // skipping the first result should drop the query node
+  std::vector<NodeId> skipped;
+  const Eigen::Vector3d query(0.0, 0.5, 0.0);
+  finder.find(query, 2, true, [&](NodeId node, size_t, double) {
+    skipped.push_back(node);
+  });
+  EXPECT_EQ(std::vector<NodeId>({3}), skipped);
+
+  finder.clear();
+  EXPECT_EQ(0u, finder.size());
+  EXPECT_TRUE(findIncremental(finder, Eigen::Vector3d::Zero(), 1).empty());
+}
+
+TEST(NearestNeighborUtilities, IncrementalFinderMatchesBruteForce) {
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<double> pos_dist(-20.0, 20.0);
+  std::uniform_int_distribution<NodeId> id_dist(0, 300);
+  std::uniform_int_distribution<int> op_dist(0, 3);
+
+  IncrementalNodeFinder finder(0.75);
+  PositionMap positions;
+  for (size_t iter = 0; iter < 2000; ++iter) {
+    const NodeId node = id_dist(rng);
+    const Eigen::Vector3d pos(pos_dist(rng), pos_dist(rng), pos_dist(rng) / 4.0);
+    if (op_dist(rng) == 0) {
+      EXPECT_EQ(positions.erase(node) > 0, finder.erase(node));
+    } else {
+      finder.insert(node, pos);
+      positions[node] = pos;
+    }
+
+    ASSERT_EQ(positions.size(), finder.size());
+    if (iter % 10 != 0) {
+      continue;
+    }
+
+    // queries both inside and well outside the occupied region
+    const Eigen::Vector3d query = 1.5 * Eigen::Vector3d(pos_dist(rng),
+                                                        pos_dist(rng),
+                                                        pos_dist(rng));
+    for (const size_t k : {1, 4, 10}) {
+      const auto expected = findBruteForce(positions, query, k);
+      const auto result = findIncremental(finder, query, k);
+      ASSERT_EQ(expected.size(), result.size());
+      for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_NEAR(expected[i].first, result[i].first, 1.0e-9);
+        EXPECT_EQ(expected[i].second, result[i].second);
+      }
+    }
+  }
+}
+
+TEST(NearestNeighborUtilities, IncrementalFinderUpdateFromLayer) {
+  IsolatedSceneGraphLayer layer(1);
+  for (size_t i = 0; i < 5; ++i) {
+    layer.emplaceNode(
+        i, std::make_unique<NodeAttributes>(Eigen::Vector3d(i, 0.0, 0.0)));
+  }
+
+  IncrementalNodeFinder finder;
+  finder.update(layer, {0, 1, 2});
+  EXPECT_EQ(3u, finder.size());
+
+  finder.update(layer, {2, 3, 4});
+  EXPECT_EQ(3u, finder.size());
+  EXPECT_FALSE(finder.contains(0));
+  EXPECT_TRUE(finder.contains(4));
+
+  const auto result = findIncremental(finder, Eigen::Vector3d::Zero(), 1);
+  ASSERT_EQ(1u, result.size());
+  EXPECT_EQ(2u, result[0].second);
+}
+
+TEST(NearestNeighborUtilities, FindManyMatchesFind) {
+  IsolatedSceneGraphLayer layer(1);
+  std::vector<NodeId> nodes;
+  std::mt19937 rng(5678);
+  std::uniform_real_distribution<double> pos_dist(-10.0, 10.0);
+  for (size_t i = 0; i < 200; ++i) {
+    const Eigen::Vector3d pos(pos_dist(rng), pos_dist(rng), pos_dist(rng));
+    layer.emplaceNode(i, std::make_unique<NodeAttributes>(pos));
+    nodes.push_back(i);
+  }
+
+  NearestNodeFinder kdtree_finder(layer, nodes);
+  IncrementalNodeFinder incremental_finder;
+  incremental_finder.update(layer, {nodes.begin(), nodes.end()});
+
+  Eigen::Matrix3Xd queries(3, 50);
+  for (int i = 0; i < queries.cols(); ++i) {
+    queries.col(i) << pos_dist(rng), pos_dist(rng), pos_dist(rng);
+  }
+
+  ThreadPool pool(4);
+  for (ThreadPool* thread_pool : {static_cast<ThreadPool*>(nullptr), &pool}) {
+    std::vector<std::vector<NodeId>> kdtree_results(queries.cols());
+    auto kdtree_callback = [&](size_t i, NodeId node, size_t, double) {
+      kdtree_results[i].push_back(node);
+    };
+    kdtree_finder.findMany(queries, 3, false, kdtree_callback, thread_pool);
+
+    std::vector<std::vector<NodeId>> incremental_results(queries.cols());
+    auto incremental_callback = [&](size_t i, NodeId node, size_t, double) {
+      incremental_results[i].push_back(node);
+    };
+    incremental_finder.findMany(queries, 3, false, incremental_callback, thread_pool);
+
+    for (int i = 0; i < queries.cols(); ++i) {
+      std::vector<NodeId> expected;
+      incremental_finder.find(
+          queries.col(i), 3, false, [&](NodeId node, size_t, double) {
+            expected.push_back(node);
+          });
+      EXPECT_EQ(expected, incremental_results[i]) << "query: " << i;
+      EXPECT_EQ(expected, kdtree_results[i]) << "query: " << i;
+    }
+  }
+}
+
 }  // namespace topology
 }  // namespace hydra
@@ -0,0 +1,101 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/output_pipeline.h>
+
+#include <atomic>
+
+namespace hydra {
+namespace topology {
+
+TEST(OutputPipeline, RunsBatchesInOrder) {
+  std::vector<size_t> order;
+  {  // scope for pipeline
+    OutputPipeline pipeline(2);
+    for (size_t i = 0; i < 10; ++i) {
+      pipeline.add([&order, i] { order.push_back(2 * i); });
+      pipeline.add([&order, i] { order.push_back(2 * i + 1); });
+      pipeline.submit();
+    }
+  }  // destructor runs every submitted batch
+
+  ASSERT_EQ(20u, order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    EXPECT_EQ(i, order[i]);
+  }
+}
+
+TEST(OutputPipeline, BoundsBatchesInFlight) {
+  OutputPipeline pipeline(2);
+  std::atomic<bool> release(false);
+  std::atomic<size_t> num_run(0);
+  const auto blocking_task = [&] {
+    while (!release) {
+      std::this_thread::yield();
+    }
+    num_run++;
+  };
+
+  pipeline.add(blocking_task);
+  pipeline.submit();
+  pipeline.add(blocking_task);
+  pipeline.submit();
+
+  // the third batch can't be queued until one of the first two finishes
+  std::atomic<bool> submitted(false);
+  std::thread submitter([&] {
+    pipeline.add([&] { num_run++; });
+    pipeline.submit();
+    submitted = true;
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(submitted);
+  EXPECT_EQ(2u, pipeline.getStats().queue_depth);
+
+  release = true;
+  submitter.join();
+  pipeline.flush();
+  EXPECT_EQ(3u, num_run);
+
+  const auto stats = pipeline.getStats();
+  EXPECT_EQ(3u, stats.num_batches);
+  EXPECT_EQ(0u, stats.queue_depth);
+  EXPECT_EQ(2u, stats.max_queue_depth);
+}
+
+}  // namespace topology
+}  // namespace hydra
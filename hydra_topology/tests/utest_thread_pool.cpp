@@ -0,0 +1,188 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/thread_pool.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <stdexcept>
+
+namespace hydra {
+namespace topology {
+
+TEST(ThreadPool, ParallelForVisitsAll) {
+  ThreadPool pool(4);
+  EXPECT_EQ(4u, pool.numThreads());
+
+  std::vector<size_t> counts(100, 0);
+  pool.parallelFor(counts.size(), [&](size_t i) { counts[i]++; });
+  for (const auto count : counts) {
+    EXPECT_EQ(1u, count);
+  }
+}
+
+TEST(ThreadPool, SerialPoolRunsOnCaller) {
+  ThreadPool pool(1);
+  EXPECT_EQ(1u, pool.numThreads());
+
+  const auto caller = std::this_thread::get_id();
+  size_t num_run = 0;
+  pool.parallelFor(10, [&](size_t) {
+    EXPECT_EQ(caller, std::this_thread::get_id());
+    num_run++;
+  });
+  EXPECT_EQ(10u, num_run);
+}
+
+TEST(ThreadPool, ParallelForUsesContiguousChunks) {
+  ThreadPool pool(4);
+
+  std::vector<std::thread::id> threads(100);
+  pool.parallelFor(threads.size(), [&](size_t i) {
+    threads[i] = std::this_thread::get_id();
+  });
+
+  // one task per chunk, so the thread can only change between the 4 chunks
+  size_t num_switches = 0;
+  for (size_t i = 1; i < threads.size(); ++i) {
+    num_switches += threads[i] != threads[i - 1] ? 1 : 0;
+  }
+  EXPECT_LE(num_switches, 3u);
+}
+
+TEST(ThreadPool, SmallRangeRunsOnCaller) {
+  ThreadPool pool(4);
+
+  const auto caller = std::this_thread::get_id();
+  size_t num_run = 0;
+  pool.parallelFor(
+      10,
+      [&](size_t) {
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        num_run++;
+      },
+      16);
+  EXPECT_EQ(10u, num_run);
+
+  // 40 indices make at most 2 chunks of 16 or more
+  std::vector<size_t> counts(40, 0);
+  pool.parallelFor(counts.size(), [&](size_t i) { counts[i]++; }, 16);
+  for (const auto count : counts) {
+    EXPECT_EQ(1u, count);
+  }
+}
+
+TEST(ThreadPool, WaitIncludesChildTasks) {
+  for (const size_t num_threads : {1u, 3u}) {
+    ThreadPool pool(num_threads);
+    ThreadPool::TaskGroup group;
+    std::atomic<size_t> num_children(0);
+    for (size_t i = 0; i < 20; ++i) {
+      pool.push(group, [&] {
+        for (size_t j = 0; j < 5; ++j) {
+          pool.push(group, [&] { num_children++; });
+        }
+      });
+    }
+
+    pool.wait(group);
+    EXPECT_EQ(100u, num_children);
+  }
+}
+
+TEST(ThreadPool, NestedParallelFor) {
+  for (const size_t num_threads : {1u, 2u, 4u}) {
+    ThreadPool pool(num_threads);
+    std::vector<std::atomic<size_t>> counts(8);
+    pool.parallelFor(counts.size(), [&](size_t i) {
+      // waits on the inner batch only (waiting on the whole pool would deadlock)
+      pool.parallelFor(10, [&](size_t) { counts[i]++; });
+    });
+
+    for (const auto& count : counts) {
+      EXPECT_EQ(10u, count);
+    }
+  }
+}
+
+TEST(ThreadPool, GroupsWaitIndependently) {
+  ThreadPool pool(2);
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool released = false;
+
+  ThreadPool::TaskGroup blocked;
+  pool.push(blocked, [&] {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return released; });
+  });
+
+  // the blocked task is still running, but this batch can finish
+  std::atomic<size_t> num_run(0);
+  pool.parallelFor(10, [&](size_t) { num_run++; });
+  EXPECT_EQ(10u, num_run);
+
+  {  // scope for lock
+    std::unique_lock<std::mutex> lock(mutex);
+    released = true;
+  }
+  cv.notify_all();
+  pool.wait(blocked);
+}
+
+TEST(ThreadPool, ThrowingTaskIsReported) {
+  for (const size_t num_threads : {1u, 3u}) {
+    ThreadPool pool(num_threads);
+    std::atomic<size_t> num_run(0);
+    EXPECT_THROW(pool.parallelFor(10,
+                                  [&](size_t i) {
+                                    num_run++;
+                                    if (i == 3) {
+                                      throw std::runtime_error("task failed");
+                                    }
+                                  }),
+                 std::runtime_error);
+    EXPECT_EQ(10u, num_run);
+
+    // the pool is still usable afterwards
+    num_run = 0;
+    pool.parallelFor(5, [&](size_t) { num_run++; });
+    EXPECT_EQ(5u, num_run);
+  }
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -0,0 +1,117 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/tsdf_block_archive.h>
+
+#include <unistd.h>
+
+namespace hydra {
+namespace topology {
+
+namespace {
+
+inline std::string getArchivePath() {
+  return "/tmp/hydra_tsdf_archive_" + std::to_string(getpid()) + ".bin";
+}
+
+}  // namespace
+
+TEST(TsdfBlockArchive, RoundTripsBlocks) {
+  Layer<TsdfVoxel> layer(0.1, 4);
+  TsdfBlockArchive archive(getArchivePath(), 4, 2);
+
+  for (int i = 0; i < 10; ++i) {
+    auto block = layer.allocateBlockPtrByIndex(BlockIndex(i, 0, 0));
+    for (size_t v = 0; v < block->num_voxels(); ++v) {
+      auto& voxel = block->getVoxelByLinearIndex(v);
+      voxel.distance = i + 0.01f * v;
+      voxel.weight = 1.0f;
+    }
+
+    archive.archiveBlock(BlockIndex(i, 0, 0), *block);
+  }
+
+  EXPECT_EQ(10u, archive.numBlocks());
+  // only the most recently archived blocks stay in memory
+  EXPECT_EQ(2u, archive.numResidentBlocks());
+
+  Layer<TsdfVoxel> restored(0.1, 4);
+  for (int i = 0; i < 10; ++i) {
+    auto block = restored.allocateBlockPtrByIndex(BlockIndex(i, 0, 0));
+    ASSERT_TRUE(archive.restoreBlock(BlockIndex(i, 0, 0), *block));
+    EXPECT_FALSE(archive.hasBlock(BlockIndex(i, 0, 0)));
+
+    for (size_t v = 0; v < block->num_voxels(); ++v) {
+      const auto& voxel = block->getVoxelByLinearIndex(v);
+      EXPECT_NEAR(i + 0.01f * v, voxel.distance, 1.0e-6f);
+      EXPECT_NEAR(1.0f, voxel.weight, 1.0e-6f);
+    }
+  }
+
+  EXPECT_EQ(0u, archive.numBlocks());
+  EXPECT_EQ(0u, archive.numResidentBlocks());
+
+  auto missing = restored.allocateBlockPtrByIndex(BlockIndex(20, 0, 0));
+  EXPECT_FALSE(archive.restoreBlock(BlockIndex(20, 0, 0), *missing));
+}
+
+TEST(TsdfBlockArchive, MergesWithNewObservations) {
+  Layer<TsdfVoxel> layer(0.1, 4);
+  TsdfBlockArchive archive(getArchivePath(), 4, 4);
+
+  auto block = layer.allocateBlockPtrByIndex(BlockIndex(0, 0, 0));
+  block->getVoxelByLinearIndex(0).distance = 0.4f;
+  block->getVoxelByLinearIndex(0).weight = 1.0f;
+  block->getVoxelByLinearIndex(1).distance = 0.2f;
+  block->getVoxelByLinearIndex(1).weight = 2.0f;
+  archive.archiveBlock(BlockIndex(0, 0, 0), *block);
+  layer.removeBlock(BlockIndex(0, 0, 0));
+
+  // a revisit only observes the first voxel
+  block = layer.allocateBlockPtrByIndex(BlockIndex(0, 0, 0));
+  block->getVoxelByLinearIndex(0).distance = 0.2f;
+  block->getVoxelByLinearIndex(0).weight = 1.0f;
+
+  ASSERT_TRUE(archive.restoreBlock(BlockIndex(0, 0, 0), *block));
+  EXPECT_NEAR(0.3f, block->getVoxelByLinearIndex(0).distance, 1.0e-6f);
+  EXPECT_NEAR(2.0f, block->getVoxelByLinearIndex(0).weight, 1.0e-6f);
+  EXPECT_NEAR(0.2f, block->getVoxelByLinearIndex(1).distance, 1.0e-6f);
+  EXPECT_NEAR(2.0f, block->getVoxelByLinearIndex(1).weight, 1.0e-6f);
+  EXPECT_EQ(0.0f, block->getVoxelByLinearIndex(2).weight);
+}
+
+}  // namespace topology
+}  // namespace hydra
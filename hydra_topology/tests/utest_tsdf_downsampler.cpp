@@ -0,0 +1,125 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <hydra_topology/tsdf_downsampler.h>
+
+namespace hydra {
+namespace topology {
+
+TEST(TsdfDownsampler, AveragesObservedVoxels) {
+  Layer<TsdfVoxel> fine(0.1, 4);
+  Layer<TsdfVoxel> coarse(0.2, 4);
+
+  auto block = fine.allocateBlockPtrByIndex(BlockIndex(0, 0, 0));
+  for (size_t i = 0; i < block->num_voxels(); ++i) {
+    auto& voxel = block->getVoxelByLinearIndex(i);
+    voxel.distance = 1.0f;
+    voxel.weight = 1.0f;
+  }
+
+  // first coarse voxel: two observed fine voxels with different weights
+  for (int x = 0; x < 2; ++x) {
+    for (int y = 0; y < 2; ++y) {
+      for (int z = 0; z < 2; ++z) {
+        block->getVoxelByVoxelIndex(VoxelIndex(x, y, z)).weight = 0.0f;
+      }
+    }
+  }
+  auto& first = block->getVoxelByVoxelIndex(VoxelIndex(0, 0, 0));
+  first.distance = 0.2f;
+  first.weight = 3.0f;
+  auto& second = block->getVoxelByVoxelIndex(VoxelIndex(1, 1, 1));
+  second.distance = 0.6f;
+  second.weight = 1.0f;
+
+  // second coarse voxel: nothing observed
+  for (int x = 2; x < 4; ++x) {
+    for (int y = 0; y < 2; ++y) {
+      for (int z = 0; z < 2; ++z) {
+        block->getVoxelByVoxelIndex(VoxelIndex(x, y, z)).weight = 0.0f;
+      }
+    }
+  }
+
+  downsampleTsdfBlocks(fine, {BlockIndex(0, 0, 0), BlockIndex(5, 5, 5)}, coarse);
+  EXPECT_EQ(1u, coarse.getNumberOfAllocatedBlocks());
+
+  auto coarse_block = coarse.getBlockPtrByIndex(BlockIndex(0, 0, 0));
+  ASSERT_TRUE(coarse_block != nullptr);
+  EXPECT_TRUE(coarse_block->updated().test(voxblox::Update::kEsdf));
+
+  const auto& result = coarse_block->getVoxelByVoxelIndex(VoxelIndex(0, 0, 0));
+  EXPECT_NEAR(0.3f, result.distance, 1.0e-6f);
+  EXPECT_NEAR(0.5f, result.weight, 1.0e-6f);
+
+  EXPECT_EQ(0.0f, coarse_block->getVoxelByVoxelIndex(VoxelIndex(1, 0, 0)).weight);
+
+  const auto& full = coarse_block->getVoxelByVoxelIndex(VoxelIndex(1, 1, 1));
+  EXPECT_NEAR(1.0f, full.distance, 1.0e-6f);
+  EXPECT_NEAR(1.0f, full.weight, 1.0e-6f);
+}
+
+TEST(TsdfDownsampler, MapsBlocksToCoarseVoxels) {
+  Layer<TsdfVoxel> fine(0.1, 4);
+  Layer<TsdfVoxel> coarse(0.2, 4);
+
+  BlockIndexList blocks{BlockIndex(1, 0, 0), BlockIndex(2, 0, 0), BlockIndex(-1, 0, 0)};
+  for (const auto& idx : blocks) {
+    auto block = fine.allocateBlockPtrByIndex(idx);
+    for (size_t i = 0; i < block->num_voxels(); ++i) {
+      auto& voxel = block->getVoxelByLinearIndex(i);
+      voxel.distance = idx.x();
+      voxel.weight = 1.0f;
+    }
+  }
+
+  downsampleTsdfBlocks(fine, blocks, coarse);
+  EXPECT_EQ(3u, coarse.getNumberOfAllocatedBlocks());
+
+  // each fine block covers half of a coarse block along each axis
+  auto check_voxel = [&](const BlockIndex& block_idx, const VoxelIndex& voxel_idx) {
+    auto block = coarse.getBlockPtrByIndex(block_idx);
+    EXPECT_TRUE(block != nullptr) << "missing block " << block_idx.transpose();
+    return block ? block->getVoxelByVoxelIndex(voxel_idx).distance : 0.0f;
+  };
+
+  EXPECT_EQ(1.0f, check_voxel(BlockIndex(0, 0, 0), VoxelIndex(2, 0, 0)));
+  EXPECT_EQ(2.0f, check_voxel(BlockIndex(1, 0, 0), VoxelIndex(0, 1, 1)));
+  EXPECT_EQ(-1.0f, check_voxel(BlockIndex(-1, 0, 0), VoxelIndex(3, 1, 0)));
+}
+
+}  // namespace topology
+}  // namespace hydra
@@ -34,6 +34,7 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <chrono>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
@@ -68,6 +69,20 @@ class ElapsedTimeRecorder {
 
   void stop(const std::string& timer_name);
 
+  //! record a duration measured elsewhere (e.g., a latency spanning several threads)
+  void record(const std::string& timer_name,
+              const uint64_t& timestamp,
+              std::chrono::nanoseconds elapsed);
+
+  /**
+   * @brief Fold a duration into running statistics without keeping the sample
+   *
+   * Meant for high-rate measurements (e.g., lock waits) whose raw samples would grow
+   * without bound. Summarized timers show up in getStats and logStats, but not in
+   * the raw logs.
+   */
+  void recordSummary(const std::string& timer_name, std::chrono::nanoseconds elapsed);
+
   void reset();
 
   std::optional<double> getLastElapsed(const std::string& timer_name) const;
@@ -89,6 +104,15 @@ class ElapsedTimeRecorder {
   using TimeStamps = std::list<uint64_t>;
   using TimeStamp = std::map<std::string, uint64_t>;
 
+  struct RunningStatistics {
+    double last_s = 0.0;
+    double sum_s = 0.0;
+    double sum_squared_s = 0.0;
+    double min_s = std::numeric_limits<double>::max();
+    double max_s = 0.0;
+    size_t num_measurements = 0;
+  };
+
   ElapsedTimeRecorder();
 
   static std::unique_ptr<ElapsedTimeRecorder> instance_;
@@ -97,6 +121,7 @@ class ElapsedTimeRecorder {
   TimeStamp start_stamps_;
   std::map<std::string, TimeList> elapsed_;
   std::map<std::string, TimeStamps> stamps_;
+  std::map<std::string, RunningStatistics> summaries_;
   std::unique_ptr<std::mutex> mutex_;
 };
 
@@ -41,6 +41,7 @@
 #include <fstream>
 #include <iostream>
 #include <numeric>
+#include <set>
 
 namespace hydra {
 namespace timing {
@@ -104,6 +105,27 @@ void ElapsedTimeRecorder::stop(const std::string& timer_name) {
   }
 }
 
+void ElapsedTimeRecorder::record(const std::string& timer_name,
+                                 const uint64_t& timestamp,
+                                 std::chrono::nanoseconds elapsed) {
+  std::unique_lock<std::mutex> lock(*mutex_);
+  elapsed_[timer_name].push_back(elapsed);
+  stamps_[timer_name].push_back(timestamp);
+}
+
+void ElapsedTimeRecorder::recordSummary(const std::string& timer_name,
+                                        std::chrono::nanoseconds elapsed) {
+  const std::chrono::duration<double> elapsed_s = elapsed;
+  std::unique_lock<std::mutex> lock(*mutex_);
+  RunningStatistics& stats = summaries_[timer_name];
+  stats.last_s = elapsed_s.count();
+  stats.sum_s += elapsed_s.count();
+  stats.sum_squared_s += elapsed_s.count() * elapsed_s.count();
+  stats.min_s = std::min(stats.min_s, elapsed_s.count());
+  stats.max_s = std::max(stats.max_s, elapsed_s.count());
+  ++stats.num_measurements;
+}
+
 void ElapsedTimeRecorder::reset() { instance_.reset(new ElapsedTimeRecorder()); }
 
 std::optional<double> ElapsedTimeRecorder::getLastElapsed(
@@ -114,6 +136,8 @@ std::optional<double> ElapsedTimeRecorder::getLastElapsed(
     std::unique_lock<std::mutex> lock(*mutex_);
     if (elapsed_.count(name)) {
       elapsed_ns = elapsed_.at(name).back();
+    } else if (summaries_.count(name)) {
+      return summaries_.at(name).last_s;
     }
   }  // end critical section
 
@@ -130,6 +154,21 @@ ElapsedStatistics ElapsedTimeRecorder::getStats(const std::string& name) const {
   {  // start critical section
     std::unique_lock<std::mutex> lock(*mutex_);
 
+    const auto summary = summaries_.find(name);
+    if (!elapsed_.count(name) && summary != summaries_.end()) {
+      const RunningStatistics& stats = summary->second;
+      const double N = stats.num_measurements;
+      const double mean = stats.sum_s / N;
+      // clamped, as the difference of sums can round below zero
+      const double variance = std::max(0.0, stats.sum_squared_s / N - mean * mean);
+      return {stats.last_s,
+              mean,
+              stats.min_s,
+              stats.max_s,
+              std::sqrt(variance),
+              stats.num_measurements};
+    }
+
     if (!elapsed_.count(name)) {
       return {0.0, 0.0, 0.0, 0.0, 0.0, 0};
     }
@@ -214,10 +253,21 @@ void ElapsedTimeRecorder::logStats(const std::string& output_folder) const {
 
   // file format
   output_file << "name,mean[s],min[s],max[s],std-dev[s]\n";
-  for (const auto& str_timer_pair : elapsed_) {
-    const ElapsedStatistics& stats = getStats(str_timer_pair.first);
-    output_file << str_timer_pair.first << "," << stats.mean_s << "," << stats.min_s
-                << "," << stats.max_s << "," << stats.stddev_s << "\n";
+  std::set<std::string> names;
+  {  // start critical section
+    std::unique_lock<std::mutex> lock(*mutex_);
+    for (const auto& str_timer_pair : elapsed_) {
+      names.insert(str_timer_pair.first);
+    }
+    for (const auto& str_summary_pair : summaries_) {
+      names.insert(str_summary_pair.first);
+    }
+  }  // end critical section
+
+  for (const auto& name : names) {
+    const ElapsedStatistics& stats = getStats(name);
+    output_file << name << "," << stats.mean_s << "," << stats.min_s << ","
+                << stats.max_s << "," << stats.stddev_s << "\n";
   }
   output_file.close();
 }
@@ -36,6 +36,7 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
 #include <thread>
 
 namespace hydra {
@@ -139,5 +140,25 @@ TEST_F(TimingUtilityTests, TestScopedTimers) {
   EXPECT_GT(*elapsed_2, *elapsed_4);
 }
 
+TEST_F(TimingUtilityTests, TestSummaryMeasurements) {
+  using namespace std::chrono_literals;
+
+  auto& recorder = ElapsedTimeRecorder::instance();
+  recorder.recordSummary("test", 10ms);
+  recorder.recordSummary("test", 20ms);
+  recorder.recordSummary("test", 30ms);
+
+  auto elapsed = recorder.getLastElapsed("test");
+  ASSERT_TRUE(elapsed);
+  EXPECT_NEAR(0.03, *elapsed, 1.0e-9);
+
+  auto stats = recorder.getStats("test");
+  EXPECT_EQ(3u, stats.num_measurements);
+  EXPECT_NEAR(0.02, stats.mean_s, 1.0e-9);
+  EXPECT_NEAR(0.01, stats.min_s, 1.0e-9);
+  EXPECT_NEAR(0.03, stats.max_s, 1.0e-9);
+  EXPECT_NEAR(std::sqrt(2.0e-4 / 3.0), stats.stddev_s, 1.0e-9);
+}
+
 }  // namespace timing
 }  // namespace hydra